@@ -0,0 +1,178 @@
+// ---------------------------------
+// projects/deque/AlignedAllocator.h
+// Copyright (C) 2010
+// Glenn P. Downing
+// ---------------------------------
+
+#ifndef AlignedAllocator_h
+#define AlignedAllocator_h
+
+// --------
+// includes
+// --------
+
+#include <cstddef>     // max_align_t, size_t
+#include <cstdlib>     // free, posix_memalign
+#include <memory>      // allocator
+#include <new>         // bad_alloc
+#include <type_traits> // conditional, decay, enable_if, is_same
+#include <utility>     // forward
+
+// ---------
+// Alignment
+// ---------
+
+/**
+ * the alignments an AlignedAllocator is usually asked for
+ */
+struct Alignment {
+    static const std::size_t natural   = 0;         //alignof(T), even above max_align_t
+    static const std::size_t cacheLine = 64;
+    static const std::size_t page      = 4 << 10;};
+
+// ----------------
+// AlignedAllocator
+// ----------------
+
+/**
+ * An allocator whose blocks are aligned to alignof(T), whatever it is, or to
+ * Align if that is stricter. std::allocator only promises max_align_t (16
+ * bytes) before C++17, so a Deque of alignas(32) vectors gets blocks that
+ * split its items across cache lines, and aligned SIMD loads of them fault.
+ *
+ * With Align above alignof(T), every allocation is also rounded up to a whole
+ * number of Align units, so a block owns the cache lines (or pages) it sits
+ * on: two Deque blocks never share a line, and so two threads owning items in
+ * neighbouring blocks never contend for one. Rebinding keeps Align, so the map
+ * is aligned the same way.
+ *
+ *     Deque<Vec8, AlignedAllocator<Vec8> >                        //blocks aligned to alignof(Vec8)
+ *     Deque<int,  AlignedAllocator<int, Alignment::cacheLine> >   //every block on lines of its own
+ *     Deque<int,  AlignedAllocator<int, Alignment::page> >        //every block on pages of its own
+ */
+template <typename T, std::size_t Align = Alignment::natural>
+class AlignedAllocator : public std::allocator<T> {
+    static_assert((Align & (Align - 1)) == 0, "Align must be a power of two");
+
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef std::size_t size_type;
+
+        template <typename U>
+        struct rebind {
+            typedef AlignedAllocator<U, Align> other;};
+
+        /**
+         * the alignment of every block, and the unit its size is rounded up to
+         * if Align was asked for
+         */
+        static const size_type alignment = Align > alignof(T) ? Align : alignof(T);
+
+    private:
+        /**
+         * @return the bytes of n T's, rounded up to whole units of Align if it is stricter than T's
+         */
+        static size_type bytes (size_type n) {
+            if(Align <= alignof(T))
+                return n * sizeof(T);
+            return (n * sizeof(T) + alignment - 1) / alignment * alignment;}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        AlignedAllocator () {}
+
+        template <typename U>
+        AlignedAllocator (const AlignedAllocator<U, Align>&) :
+                std::allocator<T>() {}
+
+        // --------
+        // allocate
+        // --------
+
+        T* allocate (size_type n, const void* = 0) {
+            void* p = NULL;
+            const size_type least = sizeof(void*);          //posix_memalign's floor
+            if(n > size_type(-1) / sizeof(T) || posix_memalign(&p, alignment > least ? alignment : least, bytes(n)) != 0)
+                throw std::bad_alloc();
+            return static_cast<T*>(p);}
+
+        // ----------
+        // deallocate
+        // ----------
+
+        void deallocate (T* p, size_type) {
+            std::free(p);}
+
+        // -----------
+        // operator ==
+        // -----------
+
+        template <typename U>
+        bool operator == (const AlignedAllocator<U, Align>&) const {
+            return true;}
+
+        template <typename U>
+        bool operator != (const AlignedAllocator<U, Align>&) const {
+            return false;}};
+
+template <typename T, std::size_t Align>
+const typename AlignedAllocator<T, Align>::size_type AlignedAllocator<T, Align>::alignment;
+
+// ------
+// Padded
+// ------
+
+/**
+ * A T alone on Bytes bytes (a cache line by default), for items different
+ * threads update: in a Deque< Padded< std::atomic<long> > > no two slots share
+ * a line, so updates to neighbouring slots don't bounce it between cores. It
+ * costs Bytes per item; a Deque's default allocator honors its alignment.
+ */
+template <typename T, std::size_t Bytes = Alignment::cacheLine>
+struct alignas(Bytes) Padded {
+    static_assert((Bytes & (Bytes - 1)) == 0 && Bytes >= alignof(T), "Bytes must be a power of two, and T must fit its alignment");
+
+    T value;
+
+    Padded () :
+            value() {}
+
+    /**
+     * Constructs the value from v; copies and moves of a Padded go to the
+     * implicit constructors
+     */
+    template <typename U, typename = typename std::enable_if<!std::is_same<typename std::decay<U>::type, Padded>::value>::type>
+    Padded (U&& v) :
+            value(std::forward<U>(v)) {}
+
+    T& get () {
+        return value;}
+
+    const T& get () const {
+        return value;}};
+
+// ---------------
+// deque_allocator
+// ---------------
+
+/**
+ * the allocator a Deque of T uses by default: std::allocator, unless T is
+ * aligned beyond max_align_t and std::allocator doesn't honor that (before
+ * C++17's aligned new), in which case an AlignedAllocator
+ */
+template <typename T>
+struct deque_allocator {
+    #if defined(__cpp_aligned_new)
+    typedef std::allocator<T> type;
+    #else
+    typedef typename std::conditional<(alignof(T) > alignof(std::max_align_t)), AlignedAllocator<T>, std::allocator<T> >::type type;
+    #endif
+    };
+
+#endif // AlignedAllocator_h
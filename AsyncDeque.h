@@ -0,0 +1,434 @@
+// ---------------------------
+// projects/deque/AsyncDeque.h
+// Copyright (C) 2010
+// Glenn P. Downing
+// ---------------------------
+
+#ifndef AsyncDeque_h
+#define AsyncDeque_h
+
+// --------
+// includes
+// --------
+
+#include <cassert>    // assert
+#include <coroutine>  // coroutine_handle
+#include <functional> // function
+#include <memory>     // allocator
+#include <mutex>      // mutex, lock_guard
+#include <optional>   // optional
+#include <utility>    // move
+#include <vector>     // vector
+
+#include "Deque.h"
+
+// ----------
+// AsyncDeque
+// ----------
+
+/**
+ * A channel between coroutines (C++20): co_await pop_front() suspends while the
+ * channel is empty, co_await push_back(v) while a bounded one is full, and
+ * neither holds a thread while suspended.
+ *
+ * The items wait in a Deque, the suspended consumers and producers in two more,
+ * oldest first, all behind one mutex. A push hands its item straight to the
+ * oldest waiting consumer, and a pop lets the oldest waiting producer's item
+ * in, so waiters are served in FIFO order and nothing overtakes them. A waiter
+ * is resumed after the mutex is let go, by the thread that made it ready
+ * (inline, on the producer's stack) or, when the channel has an executor, by
+ * handing it to the executor. The wakeups one call makes (try_push_back of a
+ * range, close) are collected under one lock and issued together.
+ *
+ * close() ends the channel: pops drain what is left and then give nullopt,
+ * pushes give false. Don't destroy a channel with coroutines waiting on it.
+ */
+template < typename T, typename A = std::allocator<T> >
+class AsyncDeque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef A                                        allocator_type;
+        typedef typename allocator_type::value_type      value_type;
+
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::difference_type difference_type;
+
+        /**
+         * resumes the coroutine it is given, now or later, on whatever thread it likes
+         */
+        typedef std::function<void (std::coroutine_handle<>)> executor_type;
+
+        class PopAwaiter;
+        class PushAwaiter;
+
+    private:
+        /**
+         * the coroutines one call makes ready, resumed once the lock is let go
+         */
+        struct Wakeups {
+            std::coroutine_handle<> first;
+            std::vector< std::coroutine_handle<> > rest;
+
+            void add (std::coroutine_handle<> h) {
+                if(!first)
+                    first = h;
+                else
+                    rest.push_back(h);}
+
+            void run (const executor_type& e) {
+                if(!first)
+                    return;
+                if(e)
+                {
+                    e(first);
+                    for(std::size_t i = 0; i < rest.size(); i++)
+                        e(rest[i]);
+                }
+                else
+                {
+                    first.resume();
+                    for(std::size_t i = 0; i < rest.size(); i++)
+                        rest[i].resume();
+                }}};
+
+        // ----
+        // data
+        // ----
+
+        size_type limit;                //0 if unbounded
+        executor_type executor;         //empty: resume inline
+        std::mutex m;
+        Deque<T, A> items;
+        Deque<PopAwaiter*> consumers;   //waiting for an item, oldest first; only while items is empty
+        Deque<PushAwaiter*> producers;  //waiting for room, oldest first; only while items is full
+        bool isClosed;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        /*
+         * @return true if AsyncDeque is valid; called with the lock held
+         */
+        bool valid () const {
+            return (consumers.empty() || items.empty()) &&
+                   (producers.empty() || (limit != 0 && items.size() == limit)) &&
+                   (!isClosed || (consumers.empty() && producers.empty()));}
+
+        /**
+         * takes the front item into slot, letting the oldest waiting producer's
+         * item in behind it; called with the lock held
+         */
+        void take (std::optional<T>& slot, Wakeups& w) {
+            slot.emplace(std::move(items.front()));
+            items.pop_front();
+            if(!producers.empty())
+            {
+                PushAwaiter* p = producers.front();
+                producers.pop_front();
+                items.push_back(std::move(p->value));
+                p->accepted = true;
+                w.add(p->handle);
+            }}
+
+        /**
+         * gives v to the oldest waiting consumer, or queues it if there is room;
+         * called with the lock held
+         * @return false if the channel is closed or full
+         */
+        template <typename U>
+        bool put (U&& v, Wakeups& w) {
+            if(isClosed)
+                return false;
+            if(!consumers.empty())
+            {
+                PopAwaiter* c = consumers.front();
+                consumers.pop_front();
+                c->slot.emplace(std::forward<U>(v));
+                w.add(c->handle);
+                return true;
+            }
+            if(limit != 0 && items.size() == limit)
+                return false;
+            items.push_back(std::forward<U>(v));
+            return true;}
+
+        /**
+         * @return true if the popping coroutine h has to wait
+         */
+        bool suspend_pop (PopAwaiter* a, std::coroutine_handle<> h) {
+            Wakeups w;
+            bool waiting = false;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                if(!items.empty())
+                    take(a->slot, w);
+                else if(!isClosed)
+                {
+                    a->handle = h;
+                    consumers.push_back(a);
+                    waiting = true;
+                }
+                assert(valid());
+            }
+            w.run(executor);
+            return waiting;}
+
+        /**
+         * @return true if the pushing coroutine h has to wait
+         */
+        bool suspend_push (PushAwaiter* a, std::coroutine_handle<> h) {
+            Wakeups w;
+            bool waiting = false;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                a->accepted = put(std::move(a->value), w);
+                if(!a->accepted && !isClosed)
+                {
+                    a->handle = h;
+                    producers.push_back(a);
+                    waiting = true;
+                }
+                assert(valid());
+            }
+            w.run(executor);
+            return waiting;}
+
+    public:
+        // ----------
+        // PopAwaiter
+        // ----------
+
+        /**
+         * what pop_front returns; co_await gives the front item, or nullopt once
+         * the channel is closed and drained
+         */
+        class PopAwaiter {
+            friend class AsyncDeque;
+
+            private:
+                AsyncDeque* q;
+                std::optional<T> slot;
+                std::coroutine_handle<> handle;
+
+            public:
+                explicit PopAwaiter (AsyncDeque* q) :
+                        q(q) {}
+
+                bool await_ready () const {
+                    return false;}
+
+                bool await_suspend (std::coroutine_handle<> h) {
+                    return q->suspend_pop(this, h);}
+
+                std::optional<T> await_resume () {
+                    return std::move(slot);}};
+
+        // -----------
+        // PushAwaiter
+        // -----------
+
+        /**
+         * what push_back returns; co_await gives true once the item is in, false
+         * if the channel was closed first
+         */
+        class PushAwaiter {
+            friend class AsyncDeque;
+
+            private:
+                AsyncDeque* q;
+                T value;
+                bool accepted;
+                std::coroutine_handle<> handle;
+
+            public:
+                PushAwaiter (AsyncDeque* q, T&& v) :
+                        q(q), value(std::move(v)), accepted(false) {}
+
+                bool await_ready () const {
+                    return false;}
+
+                bool await_suspend (std::coroutine_handle<> h) {
+                    return q->suspend_push(this, h);}
+
+                bool await_resume () const {
+                    return accepted;}};
+
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Constructs an empty open channel
+         * @param capacity the items it holds before pushes wait, 0 for no limit
+         * @param e resumes the waiters; by default they are resumed inline by the
+         * thread that makes them ready
+         * @param a allocator to use
+         */
+        explicit AsyncDeque (size_type capacity = 0, const executor_type& e = executor_type(),
+                             const allocator_type& a = allocator_type()) :
+                limit(capacity), executor(e), items(a), isClosed(false) {
+            assert(valid());}
+
+        AsyncDeque (const AsyncDeque&) = delete;
+        AsyncDeque& operator = (const AsyncDeque&) = delete;
+
+        // --------
+        // capacity
+        // --------
+
+        /**
+         * @return the items the channel holds before pushes wait, 0 for no limit
+         */
+        size_type capacity () const {
+            return limit;}
+
+        // -----
+        // close
+        // -----
+
+        /**
+         * Closes the channel: every waiting consumer gets nullopt, every waiting
+         * producer false, all in one batch of wakeups
+         */
+        void close () {
+            Wakeups w;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                isClosed = true;
+                for(size_type i = 0; i < consumers.size(); i++)
+                    w.add(consumers[i]->handle);
+                for(size_type i = 0; i < producers.size(); i++)
+                    w.add(producers[i]->handle);
+                consumers.clear();
+                producers.clear();
+                assert(valid());
+            }
+            w.run(executor);}
+
+        // ------
+        // closed
+        // ------
+
+        /**
+         * @return true once close has been called
+         */
+        bool closed () {
+            std::lock_guard<std::mutex> lock(m);
+            return isClosed;}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return size == 0
+         */
+        bool empty () {
+            return !size();}
+
+        // ---
+        // pop
+        // ---
+
+        /**
+         * co_await pop_front() takes the front item, waiting for one if need be
+         * @return an awaiter giving the item, or nullopt once closed and drained
+         */
+        PopAwaiter pop_front () {
+            return PopAwaiter(this);}
+
+        /**
+         * takes the front item without waiting
+         * @return the item, or nullopt if there is none
+         */
+        std::optional<T> try_pop_front () {
+            Wakeups w;
+            std::optional<T> v;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                if(!items.empty())
+                    take(v, w);
+                assert(valid());
+            }
+            w.run(executor);
+            return v;}
+
+        // ----
+        // push
+        // ----
+
+        /**
+         * co_await push_back(v) adds v at the back, waiting for room if need be
+         * @return an awaiter giving false if the channel is closed
+         */
+        PushAwaiter push_back (T v) {
+            return PushAwaiter(this, std::move(v));}
+
+        /**
+         * adds v at the back without waiting
+         * @return false if the channel is full or closed
+         */
+        bool try_push_back (const T& v) {
+            Wakeups w;
+            bool pushed;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                pushed = put(v, w);
+                assert(valid());
+            }
+            w.run(executor);
+            return pushed;}
+
+        /**
+         * adds v at the back without waiting
+         * @return false if the channel is full or closed
+         */
+        bool try_push_back (T&& v) {
+            Wakeups w;
+            bool pushed;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                pushed = put(std::move(v), w);
+                assert(valid());
+            }
+            w.run(executor);
+            return pushed;}
+
+        /**
+         * adds [b, e) at the back without waiting, under one lock, then wakes the
+         * consumers it fed in one batch
+         * @return how many went in, fewer than e - b if the channel filled or is closed
+         */
+        template <typename II>
+        size_type try_push_back (II b, II e) {
+            Wakeups w;
+            size_type n = 0;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                while(b != e && put(*b, w))
+                {
+                    ++b;
+                    ++n;
+                }
+                assert(valid());
+            }
+            w.run(executor);
+            return n;}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return the number of items waiting to be popped
+         */
+        size_type size () {
+            std::lock_guard<std::mutex> lock(m);
+            return items.size();}};
+
+#endif // AsyncDeque_h
@@ -0,0 +1,203 @@
+// ----------------------------------------
+// projects/deque/BenchAlignedAllocator.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// ----------------------------------------
+
+/*
+To run the benchmark:
+    % g++ -std=c++11 -O2 -DNDEBUG -mavx -pthread BenchAlignedAllocator.c++ -o BenchAlignedAllocator.app
+    % BenchAlignedAllocator.app
+*/
+
+// --------
+// includes
+// --------
+
+#include <atomic>    // atomic, memory_order_relaxed
+#include <chrono>    // steady_clock
+#include <cstddef>   // size_t
+#include <cstdint>   // uintptr_t
+#include <iostream>  // cout, endl
+#include <memory>    // allocator
+#include <thread>    // thread
+#include <vector>    // vector
+
+#include <immintrin.h> // _mm256_add_ps, _mm256_load_ps, _mm256_loadu_ps, _mm256_setzero_ps, _mm256_storeu_ps
+
+#include "AlignedAllocator.h"
+#include "Deque.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// -------
+// seconds
+// -------
+
+double seconds (Clock::time_point b) {
+    return std::chrono::duration<double>(Clock::now() - b).count();}
+
+// ----
+// Vec8
+// ----
+
+/**
+ * eight floats, as a 256-bit SIMD register holds them
+ */
+struct alignas(32) Vec8 {
+    float v[8];
+
+    explicit Vec8 (float f = 0) {
+        for(int i = 0; i < 8; i++)
+            v[i] = f;}};
+
+// ---------------
+// OffsetAllocator
+// ---------------
+
+/**
+ * the worst a 16-byte-aligned heap can do to a Vec8: every block starts 16
+ * bytes past a cache line, so every other item straddles two lines
+ */
+template <typename T>
+struct OffsetAllocator : std::allocator<T> {
+    typedef std::size_t size_type;
+
+    template <typename U>
+    struct rebind {
+        typedef OffsetAllocator<U> other;};
+
+    OffsetAllocator () {}
+
+    template <typename U>
+    OffsetAllocator (const OffsetAllocator<U>&) {}
+
+    T* allocate (size_type n, const void* = 0) {
+        char* p = AlignedAllocator<char, 64>().allocate(n * sizeof(T) + 16);
+        return reinterpret_cast<T*>(p + 16);}
+
+    void deallocate (T* p, size_type n) {
+        AlignedAllocator<char, 64>().deallocate(reinterpret_cast<char*>(p) - 16, n * sizeof(T) + 16);}};
+
+template <typename T, typename U>
+bool operator == (const OffsetAllocator<T>&, const OffsetAllocator<U>&) {
+    return true;}
+
+// ----
+// simd
+// ----
+
+/**
+ * adds the n vectors at p into s, two at a time so the adds aren't one long
+ * chain and the loads set the pace
+ */
+template <bool Aligned>
+void add (__m256* s, const Vec8* p, std::size_t n) {
+    std::size_t i = 0;
+    for(; i + 2 <= n; i += 2)
+    {
+        s[0] = _mm256_add_ps(s[0], Aligned ? _mm256_load_ps(p[i].v) : _mm256_loadu_ps(p[i].v));
+        s[1] = _mm256_add_ps(s[1], Aligned ? _mm256_load_ps(p[i + 1].v) : _mm256_loadu_ps(p[i + 1].v));
+    }
+    if(i != n)
+        s[0] = _mm256_add_ps(s[0], Aligned ? _mm256_load_ps(p[i].v) : _mm256_loadu_ps(p[i].v));}
+
+/**
+ * sums x's vectors with unaligned loads, or aligned ones if aligned
+ */
+template <typename C>
+float sum (const C& x, bool aligned) {
+    __m256 s[2] = {_mm256_setzero_ps(), _mm256_setzero_ps()};
+    if(aligned)
+        x.for_each_span([&s] (const Vec8* p, std::size_t n) {add<true>(s, p, n);});
+    else
+        x.for_each_span([&s] (const Vec8* p, std::size_t n) {add<false>(s, p, n);});
+    float f[8];
+    _mm256_storeu_ps(f, _mm256_add_ps(s[0], s[1]));
+    return f[0] + f[1] + f[2] + f[3] + f[4] + f[5] + f[6] + f[7];}
+
+/**
+ * ns per Vec8 summed, over n of them, again and again
+ */
+template <typename A>
+void simd (const char* what, std::size_t n, bool aligned) {
+    Deque<Vec8, A> x;
+    for(std::size_t i = 0; i < n; i++)
+        x.push_back(Vec8(1));
+    std::size_t off = 0, blocks = 0;
+    x.for_each_span([&] (const Vec8* p, std::size_t) {
+        ++blocks;
+        off += reinterpret_cast<std::uintptr_t>(p) % 32 != 0;});
+    const std::size_t passes = 200000000 / n + 1;
+    float s = 0;
+    Clock::time_point b = Clock::now();
+    for(std::size_t r = 0; r < passes; r++)
+    {
+        asm volatile("" : : "g"(&x) : "memory");    //x may have changed: sum it again
+        s += sum(x, aligned);
+    }
+    double t = seconds(b) / (passes * n);
+    std::cout << "\t" << what << "\t" << t * 1e9 << " ns" << "\t" << off << " of " << blocks
+              << " blocks off 32-byte alignment" << (s == 0 ? " " : "") << std::endl;}
+
+// ---------
+// contended
+// ---------
+
+std::atomic<long>& counter (std::atomic<long>& a) {
+    return a;}
+
+std::atomic<long>& counter (Padded< std::atomic<long> >& a) {
+    return a.get();}
+
+/**
+ * ns per update when each of threads threads bumps its own slots of x (slot
+ * k, k + threads, ...), iterations times each
+ */
+template <typename C>
+void contended (const char* what, C& x, int threads, int iterations) {
+    std::vector<std::thread> t;
+    Clock::time_point b = Clock::now();
+    for(int k = 0; k < threads; k++)
+        t.push_back(std::thread([&x, k, threads, iterations] () {
+            for(int i = 0; i < iterations; i++)
+                for(std::size_t s = k; s < x.size(); s += threads)
+                    counter(x[s]).fetch_add(1, std::memory_order_relaxed);}));
+    for(int k = 0; k < threads; k++)
+        t[k].join();
+    double updates = double(iterations) * x.size();
+    std::cout << "\t" << what << "\t" << seconds(b) / updates * 1e9 << " ns" << std::endl;}
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    cout << "BenchAlignedAllocator.c++" << endl;
+    cout << std::thread::hardware_concurrency() << " CPU(s)" << endl;
+
+    for(size_t n = 4096; n <= ((size_t)8 << 20); n *= 2048)
+    {
+        cout << "summing " << n << " Vec8s (" << n * sizeof(Vec8) / 1024 << " KiB), ns per Vec8" << endl;
+        simd< std::allocator<Vec8> >  ("std::allocator, loadu       ", n, false);
+        simd< OffsetAllocator<Vec8> > ("every block off by 16, loadu", n, false);
+        simd< AlignedAllocator<Vec8> >("AlignedAllocator, loadu     ", n, false);
+        simd< AlignedAllocator<Vec8> >("AlignedAllocator, load      ", n, true);
+    }
+
+    const int threads = 4, slots = 64, iterations = 200000;
+    cout << threads << " threads bumping their own of " << slots << " adjacent slots, ns per update" << endl;
+    {
+    Deque< std::atomic<long> > x;
+    x.emplace_back_n(slots, 0L);
+    contended("std::atomic<long>        ", x, threads, iterations);
+    }
+    {
+    Deque< Padded< std::atomic<long> > > x;
+    x.emplace_back_n(slots, 0L);
+    contended("Padded<std::atomic<long>>", x, threads, iterations);
+    }
+
+    cout << "Done." << endl;
+    return 0;}
@@ -0,0 +1,301 @@
+// ----------------------------------
+// projects/deque/BenchAsyncDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// ----------------------------------
+
+/*
+To run the benchmark:
+    % g++ -std=c++20 -O2 -DNDEBUG -pthread BenchAsyncDeque.c++ -o BenchAsyncDeque.app
+    % BenchAsyncDeque.app
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>             // microseconds, steady_clock
+#include <condition_variable> // condition_variable
+#include <coroutine>          // coroutine_handle, suspend_never
+#include <ctime>              // clock, CLOCKS_PER_SEC
+#include <deque>              // deque
+#include <exception>          // terminate
+#include <iostream>           // cout, endl
+#include <mutex>              // mutex, lock_guard, unique_lock
+#include <thread>             // thread, this_thread
+
+#include "AsyncDeque.h"
+#include "Deque.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// -------
+// seconds
+// -------
+
+double seconds (Clock::time_point b) {
+    return std::chrono::duration<double>(Clock::now() - b).count();}
+
+// --------
+// Detached
+// --------
+
+/**
+ * a coroutine nobody waits for: it starts at once and frees itself when done
+ */
+struct Detached {
+    struct promise_type {
+        Detached get_return_object () {
+            return Detached();}
+
+        std::suspend_never initial_suspend () {
+            return std::suspend_never();}
+
+        std::suspend_never final_suspend () noexcept {
+            return std::suspend_never();}
+
+        void return_void () {}
+
+        void unhandled_exception () {
+            std::terminate();}};};
+
+// ----
+// Loop
+// ----
+
+/**
+ * a thread running the coroutines posted to it, in order
+ */
+class Loop {
+    private:
+        std::mutex m;
+        std::condition_variable c;
+        std::deque< std::coroutine_handle<> > q;
+        bool stop;
+        std::thread t;
+
+        void run () {
+            std::unique_lock<std::mutex> lock(m);
+            for(;;)
+            {
+                c.wait(lock, [this] () {return stop || !q.empty();});
+                if(q.empty())
+                    return;
+                std::coroutine_handle<> h = q.front();
+                q.pop_front();
+                lock.unlock();
+                h.resume();
+                lock.lock();
+            }}
+
+    public:
+        Loop () :
+                stop(false), t(&Loop::run, this) {}
+
+        ~Loop () {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                stop = true;
+            }
+            c.notify_one();
+            t.join();}
+
+        void post (std::coroutine_handle<> h) {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                q.push_back(h);
+            }
+            c.notify_one();}
+
+        AsyncDeque<int>::executor_type executor () {
+            return [this] (std::coroutine_handle<> h) {post(h);};}
+
+        auto schedule () {
+            struct Awaiter {
+                Loop* loop;
+                bool await_ready () const {return false;}
+                void await_suspend (std::coroutine_handle<> h) {loop->post(h);}
+                void await_resume () const {}};
+            return Awaiter{this};}};
+
+// -------
+// Polling
+// -------
+
+/**
+ * the approach AsyncDeque replaces: a mutex-guarded Deque, polled, with a
+ * sleep (or a yield, if nap is 0) whenever it is found empty
+ */
+struct Polling {
+    std::mutex m;
+    Deque<int> q;
+
+    void push_back (int v) {
+        std::lock_guard<std::mutex> lock(m);
+        q.push_back(v);}
+
+    bool try_pop_front (int& v) {
+        std::lock_guard<std::mutex> lock(m);
+        if(q.empty())
+            return false;
+        v = q.front();
+        q.pop_front();
+        return true;}
+
+    int pop_front (int nap) {
+        int v;
+        while(!try_pop_front(v))
+            if(nap == 0)
+                std::this_thread::yield();
+            else
+                std::this_thread::sleep_for(std::chrono::microseconds(nap));
+        return v;}};
+
+// -----
+// print
+// -----
+
+void print (const char* what, int n, Clock::time_point b, std::clock_t c) {
+    double t = seconds(b), cpu = double(std::clock() - c) / CLOCKS_PER_SEC;
+    std::cout << "\t" << what << "\t" << t / n * 1e6 << " us/round trip\t" << cpu / n * 1e6 << " us CPU/round trip" << std::endl;}
+
+// ---------------
+// single threaded
+// ---------------
+
+/**
+ * answers n pings on in with the value plus one on out
+ */
+Detached pong (AsyncDeque<int>& in, AsyncDeque<int>& out, int n) {
+    for(int i = 0; i < n; i++)
+        co_await out.push_back(*co_await in.pop_front() + 1);}
+
+/**
+ * sends n pings and waits for each answer; counts the round trips into done
+ */
+Detached ping (AsyncDeque<int>& out, AsyncDeque<int>& in, int n, int& done) {
+    for(int i = 0; i < n; i++)
+    {
+        co_await out.push_back(i);
+        if(*co_await in.pop_front() == i + 1)
+            ++done;
+    }}
+
+void single_threaded (int n) {
+    std::cout << "one thread" << std::endl;
+    {
+    AsyncDeque<int> there(1), back(1);
+    int done = 0;
+    Clock::time_point b = Clock::now();
+    std::clock_t c = std::clock();
+    pong(there, back, n);
+    ping(there, back, n, done);     // runs both to the end, each resuming the other inline
+    print("AsyncDeque    ", done == n ? n : -1, b, c);
+    }
+    {
+    // two tasks polled by one loop, which naps when neither could run
+    Polling there, back;
+    int next = 0, done = 0, v;
+    bool waiting = false;
+    Clock::time_point b = Clock::now();
+    std::clock_t c = std::clock();
+    while(done < n)
+    {
+        bool ran = false;
+        if(!waiting)
+        {
+            there.push_back(next);
+            waiting = ran = true;
+        }
+        if(there.try_pop_front(v))
+        {
+            back.push_back(v + 1);
+            ran = true;
+        }
+        if(back.try_pop_front(v))
+        {
+            done += v == next + 1;
+            ++next;
+            waiting = false;
+            ran = true;
+        }
+        if(!ran)
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    print("polling       ", n, b, c);
+    }}
+
+// --------------
+// multi threaded
+// --------------
+
+/**
+ * on loop, answers n pings on in with the value plus one on out
+ */
+Detached pong_on (Loop& loop, AsyncDeque<int>& in, AsyncDeque<int>& out, int n) {
+    co_await loop.schedule();
+    for(int i = 0; i < n; i++)
+        co_await out.push_back(*co_await in.pop_front() + 1);}
+
+/**
+ * on loop, sends n pings and waits for each answer, then signals finished
+ */
+Detached ping_on (Loop& loop, AsyncDeque<int>& out, AsyncDeque<int>& in, int n, std::mutex& m,
+                  std::condition_variable& finished, bool& done) {
+    co_await loop.schedule();
+    for(int i = 0; i < n; i++)
+    {
+        co_await out.push_back(i);
+        co_await in.pop_front();
+    }
+    std::lock_guard<std::mutex> lock(m);
+    done = true;
+    finished.notify_one();}
+
+void multi_threaded (int n) {
+    std::cout << "two threads" << std::endl;
+    {
+    Loop one, two;
+    AsyncDeque<int> there(1, two.executor()), back(1, one.executor());
+    std::mutex m;
+    std::condition_variable finished;
+    bool done = false;
+    std::unique_lock<std::mutex> lock(m);
+    Clock::time_point b = Clock::now();
+    std::clock_t c = std::clock();
+    pong_on(two, there, back, n);
+    ping_on(one, there, back, n, m, finished, done);
+    finished.wait(lock, [&] () {return done;});
+    print("AsyncDeque    ", n, b, c);
+    }
+    for(int nap = 50; nap >= 0; nap -= 50)
+    {
+    Polling there, back;
+    Clock::time_point b = Clock::now();
+    std::clock_t c = std::clock();
+    std::thread t([&] () {
+        for(int i = 0; i < n; i++)
+            back.push_back(there.pop_front(nap) + 1);});
+    for(int i = 0; i < n; i++)
+    {
+        there.push_back(i);
+        back.pop_front(nap);
+    }
+    t.join();
+    print(nap ? "polling, 50 us" : "polling, yield", n, b, c);
+    }}
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    cout << "BenchAsyncDeque.c++" << endl;
+    cout << std::thread::hardware_concurrency() << " CPUs" << endl;
+
+    single_threaded(1000000);
+    multi_threaded(20000);
+
+    cout << "Done." << endl;
+    return 0;}
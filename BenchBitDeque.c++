@@ -0,0 +1,146 @@
+// --------------------------------
+// projects/deque/BenchBitDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// --------------------------------
+
+/*
+To run the benchmark:
+    % g++ -std=c++11 -O2 -DNDEBUG -march=native BenchBitDeque.c++ -o BenchBitDeque.app
+    % BenchBitDeque.app
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // count
+#include <chrono>    // steady_clock
+#include <cstdlib>   // rand
+#include <iostream>  // cout, endl
+#include <memory>    // allocator
+#include <vector>    // vector
+
+#include "Deque.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// -------
+// seconds
+// -------
+
+double seconds (Clock::time_point b) {
+    return std::chrono::duration<double>(Clock::now() - b).count();}
+
+// -----------------
+// CountingAllocator
+// -----------------
+
+std::size_t allocated = 0;
+
+/**
+ * a std::allocator that counts the bytes it has outstanding in allocated
+ */
+template <typename T>
+struct CountingAllocator : std::allocator<T> {
+    template <typename U>
+    struct rebind {
+        typedef CountingAllocator<U> other;};
+
+    CountingAllocator () {}
+
+    template <typename U>
+    CountingAllocator (const CountingAllocator<U>&) {}
+
+    T* allocate (std::size_t n, const void* = 0) {
+        allocated += n * sizeof(T);
+        return std::allocator<T>().allocate(n);}
+
+    void deallocate (T* p, std::size_t n) {
+        allocated -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);}};
+
+// Deque<char> is what Deque<bool> was before the specialization: a byte per flag
+typedef Deque<char, CountingAllocator<char> > Bytes;
+typedef Deque<bool, CountingAllocator<bool> > Bits;
+
+// -----
+// bench
+// -----
+
+/**
+ * a rolling window of the last n outcomes: memory, the cost of an event (push
+ * the new outcome, pop the oldest, read the success rate) and of counting the
+ * successes among the last n / 10
+ */
+void bench (int n) {
+    std::vector<char> outcomes(1 << 20);
+    for(std::size_t i = 0; i < outcomes.size(); i++)
+        outcomes[i] = rand() % 100 < 97;
+    const int events = 20000000;
+    double sink = 0;
+
+    allocated = 0;
+    Bytes d;
+    for(int i = 0; i < n; i++)
+        d.push_back(outcomes[i % outcomes.size()]);
+    double byte_bytes = (double)allocated / n;
+    long ones = std::count(d.begin(), d.end(), 1);
+
+    Clock::time_point b = Clock::now();
+    for(int e = 0; e < events; e++)
+    {
+        char v = outcomes[e % outcomes.size()];
+        ones += v - d.front();
+        d.pop_front();
+        d.push_back(v);
+        sink += (double)ones / d.size();
+    }
+    double byte_event = seconds(b) / events;
+
+    allocated = 0;
+    Bits x;
+    for(int i = 0; i < n; i++)
+        x.push_back(outcomes[i % outcomes.size()]);
+    double bit_bytes = (double)allocated / n;
+
+    b = Clock::now();
+    for(int e = 0; e < events; e++)
+    {
+        x.pop_front();
+        x.push_back(outcomes[e % outcomes.size()]);
+        sink += (double)x.count() / x.size();
+    }
+    double bit_event = seconds(b) / events;
+
+    const int queries = std::max(10, 200000000 / n);
+    b = Clock::now();
+    for(int q = 0; q < queries; q++)
+        sink += std::count(d.begin() + (n - n / 10 - q % 7), d.end(), 1);
+    double byte_range = seconds(b) / queries;
+
+    b = Clock::now();
+    for(int q = 0; q < queries; q++)
+        sink += x.count(n - n / 10 - q % 7, n);
+    double bit_range = seconds(b) / queries;
+
+    std::cout << "window of " << n << (sink == 0 ? " " : "") << std::endl
+              << "\tbytes/flag     Deque<char> " << byte_bytes << "\tDeque<bool> " << bit_bytes
+              << "\tratio " << byte_bytes / bit_bytes << std::endl
+              << "\tevent          Deque<char> " << byte_event * 1e9 << " ns\tDeque<bool> " << bit_event * 1e9 << " ns" << std::endl
+              << "\tcount last 10% Deque<char> " << byte_range * 1e6 << " us\tDeque<bool> " << bit_range * 1e6 << " us" << std::endl;}
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    cout << "BenchBitDeque.c++" << endl;
+
+    bench(10000);
+    bench(1000000);
+    bench(100000000);
+
+    cout << "Done." << endl;
+    return 0;}
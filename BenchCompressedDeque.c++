@@ -0,0 +1,171 @@
+// ---------------------------------------
+// projects/deque/BenchCompressedDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// ---------------------------------------
+
+/*
+To run the benchmark:
+    % g++ -std=c++11 -O2 -DNDEBUG BenchCompressedDeque.c++ -o BenchCompressedDeque.app
+    % BenchCompressedDeque.app
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>    // steady_clock
+#include <cstdint>   // int64_t, uint64_t
+#include <cstdlib>   // rand, srand
+#include <iostream>  // cout, endl
+#include <memory>    // allocator
+#include <vector>    // vector
+
+#include "CompressedDeque.h"
+#include "Deque.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// -------
+// seconds
+// -------
+
+double seconds (Clock::time_point b) {
+    return std::chrono::duration<double>(Clock::now() - b).count();}
+
+// -----------------
+// CountingAllocator
+// -----------------
+
+std::size_t allocated = 0;
+
+/**
+ * a std::allocator that counts the bytes it has outstanding in allocated
+ */
+template <typename T>
+struct CountingAllocator : std::allocator<T> {
+    template <typename U>
+    struct rebind {
+        typedef CountingAllocator<U> other;};
+
+    CountingAllocator () {}
+
+    template <typename U>
+    CountingAllocator (const CountingAllocator<U>&) {}
+
+    T* allocate (std::size_t n, const void* = 0) {
+        allocated += n * sizeof(T);
+        return std::allocator<T>().allocate(n);}
+
+    void deallocate (T* p, std::size_t n) {
+        allocated -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);}};
+
+typedef std::int64_t                                        Item;
+typedef Deque<Item, CountingAllocator<Item> >               Plain;
+typedef CompressedDeque<Item, CountingAllocator<Item> >     Packed;
+
+// ---------
+// sequences
+// ---------
+
+/**
+ * @return item i of the named sequence
+ */
+Item next (int kind, Item prev, int i) {
+    switch(kind)
+    {
+        case 0:  return 1700000000000000000LL + i * 1000LL + rand() % 100;  //ns timestamps, 1 us apart with jitter
+        case 1:  return i + rand() % 64;                                     //nearly sorted IDs
+        case 2:  return prev + rand() % 11 - 5;                              //prices in ticks, a random walk
+        default: return (Item)(((std::uint64_t)rand() << 42) ^ ((std::uint64_t)rand() << 21) ^ rand());}} //random
+
+const char* names[] = {"timestamps", "sorted IDs", "random walk", "random"};
+
+// -----
+// bench
+// -----
+
+/**
+ * bytes per item, push_back, a sequential scan (per item and, for CompressedDeque,
+ * per span) and random reads of n items of each sequence, Deque against CompressedDeque
+ */
+void bench (int n) {
+    std::cout << "n=" << n << std::endl;
+    for(int kind = 0; kind < 4; kind++)
+    {
+        srand(kind + 1);
+        std::vector<Item> items(n);
+        Item prev = 0;
+        for(int i = 0; i < n; i++)
+            items[i] = prev = next(kind, prev, i);
+        std::vector<std::size_t> probes(1000000);
+        for(std::size_t r = 0; r < probes.size(); r++)
+            probes[r] = ((std::size_t)rand() * RAND_MAX + rand()) % n;
+        long sink = 0;
+
+        allocated = 0;
+        Clock::time_point b = Clock::now();
+        Plain d;
+        for(int i = 0; i < n; i++)
+            d.push_back(items[i]);
+        double plain_push = seconds(b) / n;
+        double plain_bytes = (double)allocated / n;
+
+        allocated = 0;
+        b = Clock::now();
+        Packed p;
+        for(int i = 0; i < n; i++)
+            p.push_back(items[i]);
+        double packed_push = seconds(b) / n;
+        double packed_bytes = (double)allocated / n;
+
+        b = Clock::now();
+        for(Plain::iterator it = d.begin(); it != d.end(); ++it)
+            sink += *it;
+        double plain_scan = seconds(b) / n;
+
+        b = Clock::now();
+        for(Packed::const_iterator it = p.begin(); it != p.end(); ++it)
+            sink += *it;
+        double packed_scan = seconds(b) / n;
+
+        b = Clock::now();
+        p.for_each_span([&] (const Item* q, std::size_t m) {
+            for(std::size_t i = 0; i < m; i++)
+                sink += q[i];});
+        double packed_spans = seconds(b) / n;
+
+        b = Clock::now();
+        for(std::size_t r = 0; r < probes.size(); r++)
+            sink += d[probes[r]];
+        double plain_random = seconds(b) / probes.size();
+
+        b = Clock::now();
+        for(std::size_t r = 0; r < probes.size(); r++)
+            sink += p[probes[r]];
+        double packed_random = seconds(b) / probes.size();
+
+        std::cout << "\t" << names[kind] << (sink == 0 ? " " : "") << std::endl
+                  << "\t\tbytes/item  Deque " << plain_bytes << "\tCompressedDeque " << packed_bytes
+                  << "\tratio " << plain_bytes / packed_bytes << std::endl
+                  << "\t\tpush_back   Deque " << plain_push * 1e9 << " ns\tCompressedDeque " << packed_push * 1e9 << " ns" << std::endl
+                  << "\t\tscan        Deque " << plain_scan * 1e9 << " ns\tCompressedDeque " << packed_scan * 1e9 << " ns"
+                  << "\tfor_each_span " << packed_spans * 1e9 << " ns"
+                  << " (" << sizeof(Item) / packed_spans / 1e9 << " GB/s decoded)" << std::endl
+                  << "\t\trandom read Deque " << plain_random * 1e9 << " ns\tCompressedDeque " << packed_random * 1e9 << " ns" << std::endl;
+    }}
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    cout << "BenchCompressedDeque.c++" << endl;
+
+    bench(1000000);
+    bench(10000000);
+
+    cout << "Done." << endl;
+    return 0;}
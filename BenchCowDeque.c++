@@ -0,0 +1,183 @@
+// --------------------------------
+// projects/deque/BenchCowDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// --------------------------------
+
+/*
+To run the benchmark:
+    % g++ -std=c++11 -O2 -DNDEBUG -pthread BenchCowDeque.c++ -o BenchCowDeque.app
+    % BenchCowDeque.app
+*/
+
+// --------
+// includes
+// --------
+
+#include <atomic>    // atomic
+#include <chrono>    // steady_clock
+#include <iostream>  // cout, endl
+#include <mutex>     // mutex, lock_guard
+#include <thread>    // thread
+#include <vector>    // vector
+
+#include "Deque.h"
+#include "CowDeque.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// -------
+// seconds
+// -------
+
+double seconds (Clock::time_point b) {
+    return std::chrono::duration<double>(Clock::now() - b).count();}
+
+// -------------
+// bench_snapshot
+// -------------
+
+/**
+ * time to take a copy of an n item deque, and for CowDeque also the
+ * first write after it (which copies the map and one block)
+ */
+void bench_snapshot (int n) {
+    Deque<int>    d;
+    CowDeque<int> c;
+    for(int i = 0; i < n; i++)
+    {
+        d.push_back(i);
+        c.push_back(i);
+    }
+
+    int reps = std::max(1, 10000000 / n);
+    long sink = 0;
+
+    Clock::time_point b = Clock::now();
+    for(int r = 0; r < reps; r++)
+    {
+        Deque<int> copy(d);
+        sink += copy.size();
+    }
+    double deque = seconds(b) / reps;
+
+    b = Clock::now();
+    for(int r = 0; r < reps * 100; r++)
+    {
+        CowDeque<int> copy = c.snapshot();
+        sink += copy.size();
+    }
+    double snapshot = seconds(b) / (reps * 100);
+
+    b = Clock::now();
+    for(int r = 0; r < reps; r++)
+    {
+        CowDeque<int> copy = c.snapshot();
+        c.push_back(r);
+        c.pop_front();
+        sink += copy.size();
+    }
+    double write = seconds(b) / reps;
+
+    std::cout << "snapshot n=" << n
+              << "\tDeque copy " << deque * 1e6 << " us"
+              << "\tCowDeque snapshot " << snapshot * 1e6 << " us"
+              << "\tsnapshot + first write " << write * 1e6 << " us"
+              << (sink == 0 ? " " : "") << std::endl;}
+
+// ----------
+// bench_read
+// ----------
+
+/**
+ * one writer cycling an n item deque, readers summing the whole deque over and over
+ * for the given time; readers of a Deque hold the lock while they read, readers of a
+ * CowDeque only while they grab the latest published version
+ * @return items read per second by all the readers together
+ */
+template <typename C>
+double bench_read (int n, int readers, double duration, bool snapshot) {
+    C writer;
+    for(int i = 0; i < n; i++)
+        writer.push_back(i);
+    C published(writer);
+    std::mutex m;
+    std::atomic<bool> done(false);
+    std::atomic<long> items(0);
+
+    std::vector<std::thread> threads;
+    for(int r = 0; r < readers; r++)
+        threads.push_back(std::thread([&] () {
+            long sum = 0, count = 0;
+            while(!done)
+            {
+                if(snapshot)
+                {
+                    std::unique_lock<std::mutex> lock(m);
+                    const C version(published);
+                    lock.unlock();
+                    for(std::size_t i = 0; i < version.size(); i++)
+                        sum += version[i];
+                    count += version.size();
+                }
+                else
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    const C& version = published;
+                    for(std::size_t i = 0; i < version.size(); i++)
+                        sum += version[i];
+                    count += version.size();
+                }
+            }
+            items += count + (sum == 0);}));
+
+    Clock::time_point b = Clock::now();
+    int k = n;
+    while(seconds(b) < duration)
+    {
+        if(snapshot)
+        {
+            for(int i = 0; i < 1024; i++, k++)
+            {
+                writer.pop_front();
+                writer.push_back(k);
+            }
+            std::lock_guard<std::mutex> lock(m);
+            published = writer;
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(m);
+            for(int i = 0; i < 1024; i++, k++)
+            {
+                published.pop_front();
+                published.push_back(k);
+            }
+        }
+    }
+    done = true;
+    for(std::size_t r = 0; r < threads.size(); r++)
+        threads[r].join();
+    return items / seconds(b);}
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    cout << "BenchCowDeque.c++" << endl;
+
+    bench_snapshot(1000);
+    bench_snapshot(100000);
+    bench_snapshot(1000000);
+    bench_snapshot(10000000);
+
+    for(int readers = 1; readers <= 8; readers *= 2)
+        cout << "read n=100000 readers=" << readers
+             << "\tDeque + mutex " << bench_read< Deque<int> >(100000, readers, 1.0, false) / 1e6 << " M items/s"
+             << "\tCowDeque snapshots " << bench_read< CowDeque<int> >(100000, readers, 1.0, true) / 1e6 << " M items/s"
+             << endl;
+
+    cout << "Done." << endl;
+    return 0;}
@@ -0,0 +1,128 @@
+// -----------------------------------
+// projects/deque/BenchDequeGrowth.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// -----------------------------------
+
+/*
+To run the benchmark:
+    % g++ -std=c++11 -O2 -DNDEBUG BenchDequeGrowth.c++ -o BenchDequeGrowth.app
+    % BenchDequeGrowth.app
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>    // steady_clock
+#include <iostream>  // cout, endl
+#include <vector>    // vector
+
+#include "Deque.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// ---------
+// Histogram
+// ---------
+
+/**
+ * push latencies in nanoseconds, bucketed by powers of two
+ */
+struct Histogram {
+    std::vector<long> buckets;
+    long count, max;
+
+    Histogram () : buckets(64, 0), count(0), max(0) {}
+
+    void add (long ns) {
+        int b = 0;
+        while((2L << b) <= ns)
+            b++;
+        buckets[b]++;
+        count++;
+        if(ns > max)
+            max = ns;}
+
+    /**
+     * @return an upper bound on the q-th quantile, the top of its bucket
+     */
+    long quantile (double q) const {
+        long seen = 0;
+        for(int b = 0; b < 64; b++)
+        {
+            seen += buckets[b];
+            if(seen >= q * count)
+                return 2L << b;
+        }
+        return max;}};
+
+// -----
+// bench
+// -----
+
+/**
+ * times each of n pushes onto a Deque, all at the back or alternating ends,
+ * or with batch > 1 each push_back_n of batch items
+ * @return the latencies
+ */
+Histogram run (long n, bool incremental, bool alternate, long batch) {
+    Histogram h;
+    Deque<int> x;
+    x.set_incremental_growth(incremental);
+    for(long i = 0; i < n; i += batch)
+    {
+        Clock::time_point b = Clock::now();
+        if(batch > 1)
+            x.push_back_n([&i] () {return i;}, batch);
+        else if(alternate && (i & 1))
+            x.push_front(i);
+        else
+            x.push_back(i);
+        h.add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - b).count());
+    }
+    return h;}
+
+/**
+ * reports the run with the smallest max of three, as a scheduler hiccup
+ * rarely hits the same push twice while a map copy always does
+ */
+void bench (long n, bool incremental, bool alternate, long batch = 1) {
+    Histogram h = run(n, incremental, alternate, batch);
+    for(int r = 1; r < 3; r++)
+    {
+        Histogram g = run(n, incremental, alternate, batch);
+        if(g.max < h.max)
+            h = g;
+    }
+
+    std::cout << (incremental ? "incremental " : "one-shot    ")
+              << (batch > 1 ? "push_back_n " : alternate ? "both ends   " : "back only   ")
+              << "n=" << n
+              << "\tp50 <" << h.quantile(0.5) << " ns"
+              << "\tp99 <" << h.quantile(0.99) << " ns"
+              << "\tp99.99 <" << h.quantile(0.9999) << " ns"
+              << "\tp99.9999 <" << h.quantile(0.999999) << " ns"
+              << "\tmax " << h.max / 1000.0 << " us" << std::endl;}
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    cout << "BenchDequeGrowth.c++" << endl;
+
+    for(long n = 1000000; n <= 100000000; n *= 10)
+    {
+        for(int alternate = 0; alternate < 2; alternate++)
+        {
+            bench(n, false, alternate);
+            bench(n, true,  alternate);
+        }
+        bench(n, false, false, 64);
+        bench(n, true,  false, 64);
+    }
+
+    cout << "Done." << endl;
+    return 0;}
@@ -0,0 +1,191 @@
+// ---------------------------------
+// projects/deque/BenchDequeScan.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// ---------------------------------
+
+/*
+To run the benchmark:
+    % g++ -std=c++11 -O2 -DNDEBUG BenchDequeScan.c++ -o BenchDequeScan.app
+    % BenchDequeScan.app
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // swap
+#include <chrono>    // steady_clock
+#include <cstddef>   // ptrdiff_t, size_t
+#include <cstdint>   // uint64_t
+#include <iostream>  // cout, endl
+#include <memory>    // allocator
+#include <new>       // operator new, operator delete
+#include <vector>    // vector
+
+#include "Deque.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// -------
+// seconds
+// -------
+
+double seconds (Clock::time_point b) {
+    return std::chrono::duration<double>(Clock::now() - b).count();}
+
+// -------------
+// ScatteredPool
+// -------------
+
+/**
+ * hands out 10-item blocks from one big buffer in a shuffled order, so
+ * consecutive blocks of a Deque land far apart, as they do in a long-lived
+ * heap; the hardware prefetcher can't follow them across block boundaries
+ */
+struct ScatteredPool {
+    std::vector<char> buffer;
+    std::vector<std::size_t> order;
+    std::size_t next, bytes;
+
+    ScatteredPool (std::size_t blocks, std::size_t bytes) :
+            buffer(blocks * bytes), order(blocks), next(0), bytes(bytes) {
+        std::uint64_t k = 88172645463325252ULL;
+        for(std::size_t i = 0; i < blocks; i++)
+            order[i] = i;
+        for(std::size_t i = blocks - 1; i > 0; i--)
+        {
+            k ^= k << 13;
+            k ^= k >> 7;
+            k ^= k << 17;
+            std::swap(order[i], order[k % (i + 1)]);
+        }}
+
+    void* take () {
+        return &buffer[order[next++] * bytes];}};
+
+// ------------------
+// ScatteredAllocator
+// ------------------
+
+/**
+ * takes Deque blocks from a ScatteredPool and everything else (the map) from new
+ */
+template <typename T>
+struct ScatteredAllocator {
+    typedef T              value_type;
+    typedef std::size_t    size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    ScatteredPool* pool;
+
+    explicit ScatteredAllocator (ScatteredPool* p) :
+            pool(p) {}
+
+    template <typename U>
+    ScatteredAllocator (const ScatteredAllocator<U>& that) :
+            pool(that.pool) {}
+
+    T* allocate (std::size_t n) {
+        if(n == 10 && sizeof(T) * n == pool->bytes)
+            return static_cast<T*>(pool->take());
+        return static_cast<T*>(::operator new(n * sizeof(T)));}
+
+    void deallocate (T* p, std::size_t n) {
+        if(!(n == 10 && sizeof(T) * n == pool->bytes))
+            ::operator delete(p);}};
+
+template <typename T, typename U>
+bool operator == (const ScatteredAllocator<T>& lhs, const ScatteredAllocator<U>& rhs) {
+    return lhs.pool == rhs.pool;}
+
+// -----
+// flush
+// -----
+
+/**
+ * walks a buffer bigger than the last-level cache so the next scan starts cold
+ */
+std::uint64_t flush () {
+    static std::vector<char> junk(std::size_t(256) << 20);
+    std::uint64_t s = 0;
+    for(std::size_t i = 0; i < junk.size(); i += 64)
+        s += ++junk[i];
+    return s;}
+
+// -----
+// bench
+// -----
+
+/**
+ * times cold forward and reverse scans of x, by iterator and by span, the latter
+ * prefetching 0 (none), 4, 16 and 64 blocks ahead
+ */
+template <typename C>
+void bench (const C& x) {
+    std::uint64_t sink = 0;
+    const std::size_t aheads[] = {0, 4, 16, 64};
+    double n = x.size();
+
+    sink += flush();
+    Clock::time_point b = Clock::now();
+    for(typename C::const_iterator p = x.begin(); p != x.end(); ++p)
+        sink += *p;
+    std::cout << "\titerator                    " << seconds(b) / n * 1e9 << " ns" << std::endl;
+
+    sink += flush();
+    b = Clock::now();
+    for(typename C::const_reverse_iterator p = x.rbegin(); p != x.rend(); ++p)
+        sink += *p;
+    std::cout << "\treverse_iterator            " << seconds(b) / n * 1e9 << " ns" << std::endl;
+
+    for(std::size_t i = 0; i < sizeof(aheads) / sizeof(aheads[0]); i++)
+    {
+        const std::size_t a = aheads[i];
+        sink += flush();
+        b = Clock::now();
+        x.for_each_span([&sink] (const int* p, std::size_t k) {
+            for(std::size_t i = 0; i < k; i++)
+                sink += p[i];}, a);
+        std::cout << "\tfor_each_span,         ahead " << a << (a < 10 ? " " : "") << " "
+                  << seconds(b) / n * 1e9 << " ns" << std::endl;
+
+        sink += flush();
+        b = Clock::now();
+        x.for_each_span_reverse([&sink] (const int* p, std::size_t k) {
+            for(std::size_t i = k; i != 0; --i)
+                sink += p[i - 1];}, a);
+        std::cout << "\tfor_each_span_reverse, ahead " << a << (a < 10 ? " " : "") << " "
+                  << seconds(b) / n * 1e9 << " ns" << std::endl;
+    }
+    if(sink == 0)
+        std::cout << std::endl;}
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    cout << "BenchDequeScan.c++" << endl;
+
+    const size_t n = 100000000;
+    cout << n << " ints, ns per item, cold cache" << endl;
+    {
+    cout << "blocks in allocation order" << endl;
+    Deque<int> x;
+    for(size_t i = 0; i < n; i++)
+        x.push_back((int)i);
+    bench(x);
+    }
+    {
+    cout << "blocks scattered" << endl;
+    ScatteredPool pool(n / 10 + 2, 10 * sizeof(int));
+    Deque< int, ScatteredAllocator<int> > x((ScatteredAllocator<int>(&pool)));
+    for(size_t i = 0; i < n; i++)
+        x.push_back((int)i);
+    bench(x);
+    }
+
+    cout << "Done." << endl;
+    return 0;}
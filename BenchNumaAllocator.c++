@@ -0,0 +1,129 @@
+// -------------------------------------
+// projects/deque/BenchNumaAllocator.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// -------------------------------------
+
+/*
+To run the benchmark:
+    % g++ -std=c++11 -O2 -DNDEBUG BenchNumaAllocator.c++ -o BenchNumaAllocator.app
+    % BenchNumaAllocator.app
+To compare with placement by numactl itself:
+    % numactl --cpunodebind=0 --membind=1 BenchNumaAllocator.app
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>    // steady_clock
+#include <cstdint>   // uint64_t
+#include <iostream>  // cout, endl
+#include <memory>    // allocator
+#include <vector>    // vector
+
+#include "Deque.h"
+#include "NumaAllocator.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// -------
+// seconds
+// -------
+
+double seconds (Clock::time_point b) {
+    return std::chrono::duration<double>(Clock::now() - b).count();}
+
+// -----
+// stats
+// -----
+
+void print (const std::allocator<int>&) {}
+
+void print (const NumaAllocator<int>& a) {
+    NumaStats s = a.stats();
+    std::cout << "\tnode " << s.node << ", " << s.arenas << " arenas (" << s.hugetlbArenas << " hugetlb, "
+              << s.transparentArenas << " THP), pages by node:";
+    for(std::size_t n = 0; n < s.pagesOnNode.size(); n++)
+        std::cout << " " << s.pagesOnNode[n];
+    if(s.bindFailures != 0)
+        std::cout << ", left unbound";
+    if(s.hugetlbFallbacks != 0)
+        std::cout << ", no hugetlb pages reserved";
+    std::cout << std::endl;}
+
+// -----
+// bench
+// -----
+
+/**
+ * ns per item of a scan, a random read and a FIFO push and pop (1M deep) over a
+ * Deque<int> of n items whose blocks come from a
+ */
+template <typename A>
+void bench (const char* what, const A& a, std::size_t n) {
+    std::uint64_t sink = 0;
+    Deque<int, A> x(a);
+    for(std::size_t i = 0; i < n; i++)
+        x.push_back((int)i);
+
+    Clock::time_point b = Clock::now();
+    for(int r = 0; r < 4; r++)
+        for(typename Deque<int, A>::iterator p = x.begin(); p != x.end(); ++p)
+            sink += *p;
+    double scan = seconds(b) / (4 * n);
+
+    const std::size_t reads = 10000000;
+    std::uint64_t k = 88172645463325252ULL;
+    b = Clock::now();
+    for(std::size_t i = 0; i < reads; i++)
+    {
+        k ^= k << 13;
+        k ^= k >> 7;
+        k ^= k << 17;
+        sink += x[k % n];
+    }
+    double random = seconds(b) / reads;
+
+    Deque<int, A> q(a);
+    const std::size_t depth = 1 << 20, ops = 20000000;
+    for(std::size_t i = 0; i < depth; i++)
+        q.push_back((int)i);
+    b = Clock::now();
+    for(std::size_t i = 0; i < ops; i++)
+    {
+        q.push_back((int)i);
+        sink += q.front();
+        q.pop_front();
+    }
+    double fifo = seconds(b) / ops;
+
+    std::cout << what << (sink == 0 ? " " : "") << "\tscan " << scan * 1e9 << " ns\trandom " << random * 1e9
+              << " ns\tfifo " << fifo * 1e9 << " ns" << std::endl;
+    print(a);}
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    cout << "BenchNumaAllocator.c++" << endl;
+
+    typedef NumaAllocator<int> allocator_type;
+    const int nodes = allocator_type::nodes(), local = allocator_type::current_node();
+    const int remote = (local + 1) % nodes;
+    const size_t n = (size_t)64 << 20;   // 256 MiB of ints
+    cout << nodes << " node(s), running on node " << local << ", " << n / (1 << 20) << "M ints" << endl;
+    if(nodes == 1)
+        cout << "one node: --membind to another node runs on this one" << endl;
+
+    bench("std::allocator            ", std::allocator<int>(), n);
+    bench("--localalloc              ", allocator_type(allocator_type::localNode), n);
+    bench("--localalloc, THP         ", allocator_type(allocator_type::localNode, allocator_type::transparentHugePages), n);
+    bench("--localalloc, hugetlb     ", allocator_type(allocator_type::localNode, allocator_type::explicitHugePages), n);
+    bench("--membind=remote          ", allocator_type(remote, allocator_type::smallPages, true), n);
+    bench("--membind=remote, THP     ", allocator_type(remote, allocator_type::transparentHugePages, true), n);
+
+    cout << "Done." << endl;
+    return 0;}
@@ -0,0 +1,128 @@
+// ---------------------------------------
+// projects/deque/BenchPersistentDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// ---------------------------------------
+
+/*
+To run the benchmark:
+    % g++ -std=c++11 -O2 -DNDEBUG BenchPersistentDeque.c++ -o BenchPersistentDeque.app
+    % BenchPersistentDeque.app
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>    // steady_clock
+#include <cstdlib>   // rand
+#include <iostream>  // cout, endl
+#include <vector>    // vector
+
+#include "Deque.h"
+#include "PersistentDeque.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// -------
+// seconds
+// -------
+
+double seconds (Clock::time_point b) {
+    return std::chrono::duration<double>(Clock::now() - b).count();}
+
+// -----
+// bench
+// -----
+
+/**
+ * keeping a version per update: a copy of a Deque against a PersistentDeque
+ * operation, plus random access and split/concat, on n items
+ */
+void bench (int n) {
+    Deque<int>           d;
+    PersistentDeque<int> p;
+    for(int i = 0; i < n; i++)
+    {
+        d.push_back(i);
+        p = p.push_back(i);
+    }
+
+    int reps = std::max(3, 3000000 / n);
+    long sink = 0;
+
+    // new version with one more item
+    Clock::time_point b = Clock::now();
+    for(int r = 0; r < reps; r++)
+    {
+        Deque<int> v(d);
+        v.push_back(r);
+        sink += v.size();
+    }
+    double deque_version = seconds(b) / reps;
+
+    b = Clock::now();
+    for(int r = 0; r < reps * 100; r++)
+    {
+        PersistentDeque<int> v = p.push_back(r).pop_front();
+        sink += v.size();
+    }
+    double persistent_version = seconds(b) / (reps * 100) / 2;
+
+    // random access
+    const int lookups = 1000000;
+    b = Clock::now();
+    for(int r = 0; r < lookups; r++)
+        sink += d[(r * 7919L) % n];
+    double deque_index = seconds(b) / lookups;
+
+    b = Clock::now();
+    for(int r = 0; r < lookups; r++)
+        sink += p[(r * 7919L) % n];
+    double persistent_index = seconds(b) / lookups;
+
+    // split in half and put back together
+    b = Clock::now();
+    for(int r = 0; r < reps; r++)
+    {
+        Deque<int> front(d);
+        Deque<int> back;
+        for(int i = n / 2; i < n; i++)
+            back.push_back(d[i]);
+        front.resize(n / 2);
+        for(int i = 0; i < n - n / 2; i++)
+            front.push_back(back[i]);
+        sink += front.size();
+    }
+    double deque_split = seconds(b) / reps;
+
+    b = Clock::now();
+    for(int r = 0; r < reps * 100; r++)
+    {
+        std::pair<PersistentDeque<int>, PersistentDeque<int> > halves = p.split_at(n / 2 + r % 10);
+        sink += halves.first.concat(halves.second).size();
+    }
+    double persistent_split = seconds(b) / (reps * 100);
+
+    std::cout << "n=" << n << (sink == 0 ? " " : "") << std::endl
+              << "\tnew version    Deque copy " << deque_version * 1e6 << " us"
+              << "\tPersistentDeque " << persistent_version * 1e6 << " us" << std::endl
+              << "\tindex          Deque " << deque_index * 1e9 << " ns"
+              << "\tPersistentDeque " << persistent_index * 1e9 << " ns" << std::endl
+              << "\tsplit+concat   Deque " << deque_split * 1e6 << " us"
+              << "\tPersistentDeque " << persistent_split * 1e6 << " us" << std::endl;}
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    cout << "BenchPersistentDeque.c++" << endl;
+
+    bench(1000);
+    bench(1000000);
+    bench(10000000);
+
+    cout << "Done." << endl;
+    return 0;}
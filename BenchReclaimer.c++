@@ -0,0 +1,142 @@
+// ---------------------------------
+// projects/deque/BenchReclaimer.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// ---------------------------------
+
+/*
+To run the benchmark:
+    % g++ -std=c++11 -O2 -DNDEBUG -pthread BenchReclaimer.c++ -o BenchReclaimer.app
+    % BenchReclaimer.app
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // max, sort
+#include <chrono>    // microseconds, steady_clock
+#include <cstddef>   // size_t
+#include <iostream>  // cout, endl
+#include <string>    // string
+#include <thread>    // thread, this_thread
+#include <vector>    // vector
+
+#include "Deque.h"
+#include "Reclaimer.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// -------
+// seconds
+// -------
+
+double seconds (Clock::time_point b) {
+    return std::chrono::duration<double>(Clock::now() - b).count();}
+
+// ----
+// fill
+// ----
+
+/**
+ * n strings too long for the small-string buffer, so each has a heap block to free
+ */
+void fill (Deque<std::string>& x, std::size_t n) {
+    for(std::size_t i = 0; i < n; i++)
+        x.push_back(std::string(40, char('a' + i % 26)));}
+
+// --------
+// requests
+// --------
+
+/**
+ * serves requests, each a little work on a small Deque and then a 100 us wait
+ * for the next one, until done() says stop (and at least min have been served)
+ * @return each request's latency in microseconds, sorted
+ */
+template <typename F>
+std::vector<double> requests (F done, std::size_t min) {
+    std::vector<double> t;
+    Deque<int> q;
+    long sink = 0;
+    while(t.size() < min || !done())
+    {
+        Clock::time_point b = Clock::now();
+        for(int i = 0; i < 2000; i++)
+        {
+            q.push_back(i);
+            if(q.size() > 100)
+            {
+                sink += q.front();
+                q.pop_front();
+            }
+        }
+        t.push_back(seconds(b) * 1e6);
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    if(sink == 0)
+        std::cout << std::endl;
+    std::sort(t.begin(), t.end());
+    return t;}
+
+// -----
+// print
+// -----
+
+void print (const char* what, const std::vector<double>& t, double blocked, double teardown) {
+    std::cout << what << "\tblocked " << blocked * 1e3 << " ms\tteardown done after " << teardown * 1e3
+              << " ms\trequests " << t.size() << ": p50 " << t[t.size() / 2] << " us, p99 "
+              << t[t.size() * 99 / 100] << " us, max " << std::max(t.back(), blocked * 1e6) << " us" << std::endl;}
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    cout << "BenchReclaimer.c++" << endl;
+
+    const size_t n = 10000000;
+    cout << n << " strings of 40 chars, " << std::thread::hardware_concurrency() << " CPU(s)" << endl;
+
+    {
+    vector<double> t = requests([] () {return true;}, 2000);
+    print("no teardown        ", t, 0, 0);
+    }
+    {
+    // the request thread tears the deque down itself, then goes on serving
+    Deque<string> x;
+    fill(x, n);
+    Clock::time_point b = Clock::now();
+    x.clear();
+    double blocked = seconds(b);
+    vector<double> t = requests([] () {return true;}, 2000);
+    print("clear()            ", t, blocked, blocked);
+    }
+    {
+    Deque<string>* x = new Deque<string>();
+    fill(*x, n);
+    Clock::time_point b = Clock::now();
+    delete x;
+    double blocked = seconds(b);
+    vector<double> t = requests([] () {return true;}, 2000);
+    print("~Deque             ", t, blocked, blocked);
+    }
+    for(int idle = 1; idle >= 0; idle--)
+    {
+    Reclaimer r(idle == 1);
+    Deque<string> x;
+    fill(x, n);
+    Clock::time_point b = Clock::now();
+    x.release_async(r);
+    double blocked = seconds(b);
+    double teardown = 0;
+    vector<double> t = requests([&] () {
+        if(teardown == 0 && r.pending() == 0)
+            teardown = seconds(b);
+        return teardown != 0;}, 2000);
+    print(idle ? "release_async, idle" : "release_async      ", t, blocked, teardown);
+    }
+
+    cout << "Done." << endl;
+    return 0;}
@@ -0,0 +1,127 @@
+// -----------------------------------
+// projects/deque/BenchRecordDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// -----------------------------------
+
+/*
+To run the benchmark:
+    % g++ -std=c++11 -O2 -DNDEBUG BenchRecordDeque.c++ -o BenchRecordDeque.app
+    % BenchRecordDeque.app
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>    // steady_clock
+#include <cstdlib>   // malloc, free, rand
+#include <cstring>   // memcpy
+#include <iostream>  // cout, endl
+#include <new>       // bad_alloc
+#include <string>    // string
+#include <vector>    // vector
+
+#include "Deque.h"
+#include "RecordDeque.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// -------
+// seconds
+// -------
+
+double seconds (Clock::time_point b) {
+    return std::chrono::duration<double>(Clock::now() - b).count();}
+
+// -----------
+// allocations
+// -----------
+
+std::size_t allocations = 0;
+
+void* operator new (std::size_t n) {
+    ++allocations;
+    if(void* p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();}
+
+void operator delete (void* p) noexcept {
+    std::free(p);}
+
+// -----
+// bench
+// -----
+
+/**
+ * a queue of serialized messages of about n bytes (n/2 to n) kept 256 deep:
+ * push one, take the front out into a buffer and pop it; messages per second,
+ * GB per second and heap allocations per message, Deque<std::string> against RecordDeque
+ */
+void bench (std::size_t n) {
+    const std::size_t depth = 256;
+    const std::size_t messages = std::max<std::size_t>(20000, 2000000000 / n);
+    std::vector<char> payload(n);
+    for(std::size_t i = 0; i < n; i++)
+        payload[i] = (char)rand();
+    std::vector<std::size_t> sizes(1024);
+    for(std::size_t i = 0; i < sizes.size(); i++)
+        sizes[i] = n / 2 + rand() % (n / 2 + 1);
+    std::vector<char> out(n);
+    std::size_t moved = 0, sink = 0;
+    for(std::size_t m = 0; m < messages; m++)
+        moved += sizes[m % sizes.size()];
+
+    Deque<std::string> d;
+    for(std::size_t m = 0; m < depth; m++)
+        d.push_back(std::string(payload.data(), sizes[m % sizes.size()]));
+    allocations = 0;
+    Clock::time_point b = Clock::now();
+    for(std::size_t m = 0; m < messages; m++)
+    {
+        d.push_back(std::string(payload.data(), sizes[m % sizes.size()]));
+        const std::string& s = d.front();
+        std::memcpy(out.data(), s.data(), s.size());
+        sink += out[s.size() / 2];
+        d.pop_front();
+    }
+    double strings = seconds(b);
+    double string_allocations = (double)allocations / messages;
+
+    RecordDeque<> r;
+    for(std::size_t m = 0; m < depth; m++)
+        r.push_back(payload.data(), sizes[m % sizes.size()]);
+    allocations = 0;
+    b = Clock::now();
+    for(std::size_t m = 0; m < messages; m++)
+    {
+        r.push_back(payload.data(), sizes[m % sizes.size()]);
+        RecordDeque<>::Record f = r.front();
+        f.copy(out.data());
+        sink += out[f.size() / 2];
+        r.pop_front();
+    }
+    double records = seconds(b);
+    double record_allocations = (double)allocations / messages;
+
+    std::cout << "messages of " << n / 2 << " to " << n << " bytes" << (sink == 0 ? " " : "") << std::endl
+              << "\tDeque<std::string> " << messages / strings / 1e6 << " M msgs/s\t" << moved / strings / 1e9 << " GB/s\t"
+              << string_allocations << " allocations/msg" << std::endl
+              << "\tRecordDeque        " << messages / records / 1e6 << " M msgs/s\t" << moved / records / 1e9 << " GB/s\t"
+              << record_allocations << " allocations/msg" << std::endl;}
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    cout << "BenchRecordDeque.c++" << endl;
+
+    bench(64);
+    bench(1024);
+    bench(16 * 1024);
+    bench(64 * 1024);
+
+    cout << "Done." << endl;
+    return 0;}
@@ -0,0 +1,243 @@
+// --------------------------------
+// projects/deque/BenchShmDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// --------------------------------
+
+/*
+To run the benchmark:
+    % g++ -std=c++11 -O2 -DNDEBUG -pthread BenchShmDeque.c++ -o BenchShmDeque.app -lrt
+    % BenchShmDeque.app
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // sort
+#include <chrono>    // steady_clock
+#include <cstdint>   // uint64_t
+#include <iostream>  // cout, endl
+#include <string>    // string, to_string
+#include <vector>    // vector
+
+#include <sys/socket.h> // socketpair
+#include <sys/wait.h>   // waitpid
+#include <unistd.h>     // fork, read, write, _exit
+
+#include "ShmDeque.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// -------
+// seconds
+// -------
+
+double seconds (Clock::time_point b) {
+    return std::chrono::duration<double>(Clock::now() - b).count();}
+
+// ------
+// Record
+// ------
+
+struct Record {
+    std::uint64_t seq;
+    std::uint64_t producer;
+    char payload[48];};
+
+/**
+ * @return a segment name for this run
+ */
+std::string segment (const char* what) {
+    return std::string("/BenchShmDeque-") + what + "-" + std::to_string(getpid());}
+
+/**
+ * waits for the child pid
+ */
+void join (pid_t pid) {
+    int status;
+    waitpid(pid, &status, 0);}
+
+// ------
+// socket
+// ------
+
+/**
+ * sends r through the stream socket fd, one write per record
+ */
+void send_record (int fd, const Record& r) {
+    const char* p = reinterpret_cast<const char*>(&r);
+    for(std::size_t n = 0; n < sizeof(r); )
+        n += write(fd, p + n, sizeof(r) - n);}
+
+/**
+ * receives a record from the stream socket fd into r
+ */
+void receive_record (int fd, Record& r) {
+    char* p = reinterpret_cast<char*>(&r);
+    for(std::size_t n = 0; n < sizeof(r); )
+        n += read(fd, p + n, sizeof(r) - n);}
+
+// ----------
+// throughput
+// ----------
+
+/**
+ * records per second from producers child processes to this one, through a
+ * socket (one producer only) or a ShmDeque
+ */
+template <bool MultiProducer>
+double shm_throughput (int producers, int n) {
+    std::string name = segment(MultiProducer ? "mpsc" : "spsc");
+    ShmDeque<Record, MultiProducer> q(name, 4096);
+    Clock::time_point b = Clock::now();
+    std::vector<pid_t> pids;
+    for(int p = 0; p < producers; p++)
+    {
+        pid_t pid = fork();
+        if(pid == 0)
+        {
+            ShmDeque<Record, MultiProducer> y(name);
+            Record r = Record();
+            r.producer = p;
+            for(int i = 0; i < n; i++)
+            {
+                r.seq = i;
+                y.push_back(r);
+            }
+            _exit(0);
+        }
+        pids.push_back(pid);
+    }
+    std::uint64_t sink = 0;
+    for(int i = 0; i < producers * n; i++)
+    {
+        sink += q.front().seq;
+        q.pop_front();
+    }
+    double t = seconds(b);
+    for(std::size_t p = 0; p < pids.size(); p++)
+        join(pids[p]);
+    return sink == 0 ? 0 : producers * n / t;}
+
+double socket_throughput (int n) {
+    int fds[2];
+    socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    Clock::time_point b = Clock::now();
+    pid_t pid = fork();
+    if(pid == 0)
+    {
+        close(fds[0]);
+        Record r = Record();
+        for(int i = 0; i < n; i++)
+        {
+            r.seq = i;
+            send_record(fds[1], r);
+        }
+        _exit(0);
+    }
+    close(fds[1]);
+    std::uint64_t sink = 0;
+    Record r;
+    for(int i = 0; i < n; i++)
+    {
+        receive_record(fds[0], r);
+        sink += r.seq;
+    }
+    double t = seconds(b);
+    join(pid);
+    close(fds[0]);
+    return sink == 0 ? 0 : n / t;}
+
+// -------
+// latency
+// -------
+
+/**
+ * prints the median and 99th percentile of one way latency, half a round trip
+ * through a pair of queues to an echoing child process
+ */
+void report (const char* what, std::vector<double>& rtt) {
+    std::sort(rtt.begin(), rtt.end());
+    std::cout << "\t" << what << "\tp50 " << rtt[rtt.size() / 2] / 2 * 1e6 << " us"
+              << "\tp99 " << rtt[rtt.size() * 99 / 100] / 2 * 1e6 << " us" << std::endl;}
+
+void shm_latency (int n) {
+    std::string there = segment("ping"), back = segment("pong");
+    ShmDeque<Record> ping(there, 64), pong(back, 64);
+    pid_t pid = fork();
+    if(pid == 0)
+    {
+        ShmDeque<Record> in(there), out(back);
+        for(int i = 0; i < n; i++)
+        {
+            Record r;
+            in.pop_front(r);
+            out.push_back(r);
+        }
+        _exit(0);
+    }
+    std::vector<double> rtt;
+    Record r = Record();
+    for(int i = 0; i < n; i++)
+    {
+        Clock::time_point b = Clock::now();
+        r.seq = i;
+        ping.push_back(r);
+        pong.pop_front(r);
+        rtt.push_back(seconds(b));
+    }
+    join(pid);
+    report("ShmDeque", rtt);}
+
+void socket_latency (int n) {
+    int fds[2];
+    socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    pid_t pid = fork();
+    if(pid == 0)
+    {
+        close(fds[0]);
+        Record r;
+        for(int i = 0; i < n; i++)
+        {
+            receive_record(fds[1], r);
+            send_record(fds[1], r);
+        }
+        _exit(0);
+    }
+    close(fds[1]);
+    std::vector<double> rtt;
+    Record r = Record();
+    for(int i = 0; i < n; i++)
+    {
+        Clock::time_point b = Clock::now();
+        r.seq = i;
+        send_record(fds[0], r);
+        receive_record(fds[0], r);
+        rtt.push_back(seconds(b));
+    }
+    join(pid);
+    close(fds[0]);
+    report("socket  ", rtt);}
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    cout << "BenchShmDeque.c++" << endl;
+    cout << sizeof(Record) << "-byte records, " << std::thread::hardware_concurrency() << " CPUs" << endl;
+
+    const int n = 10000000;
+    cout << "throughput" << endl
+         << "\tsocket        " << socket_throughput(n) / 1e6 << " M records/s" << endl
+         << "\tShmDeque SPSC " << shm_throughput<false>(1, n) / 1e6 << " M records/s" << endl
+         << "\tShmDeque MPSC " << shm_throughput<true>(2, n / 2) / 1e6 << " M records/s (2 producers)" << endl;
+
+    cout << "latency" << endl;
+    socket_latency(100000);
+    shm_latency(100000);
+
+    cout << "Done." << endl;
+    return 0;}
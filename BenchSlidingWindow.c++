@@ -0,0 +1,191 @@
+// -------------------------------------
+// projects/deque/BenchSlidingWindow.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// -------------------------------------
+
+/*
+To run the benchmark:
+    % g++ -std=c++11 -O2 -DNDEBUG BenchSlidingWindow.c++ -o BenchSlidingWindow.app
+    % BenchSlidingWindow.app
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // min
+#include <chrono>    // steady_clock
+#include <climits>   // INT_MAX
+#include <iostream>  // cout, endl
+
+#include "Deque.h"
+#include "MonotonicDeque.h"
+#include "SlidingWindow.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// -------
+// seconds
+// -------
+
+double seconds (Clock::time_point b) {
+    return std::chrono::duration<double>(Clock::now() - b).count();}
+
+// ---
+// Min
+// ---
+
+struct Min {
+    int operator () (int x, int y) const {
+        return std::min(x, y);}};
+
+// ------
+// stream
+// ------
+
+/**
+ * @return the i-th item of a pseudo random stream
+ */
+inline int stream (long i) {
+    unsigned long x = i * 0x9E3779B97F4A7C15UL;
+    return (int)((x ^ (x >> 29)) % 1000000);}
+
+// -----------
+// bench_naive
+// -----------
+
+/**
+ * the hand-rolled way: a Deque of the window, rescanned for every query
+ * @return seconds per item
+ */
+double bench_naive (long n, long w) {
+    Deque<int> x;
+    long sink = 0;
+    Clock::time_point b = Clock::now();
+    for(long i = 0; i < n; i++)
+    {
+        x.push_back(stream(i));
+        if(i >= w)
+            x.pop_front();
+        int m = INT_MAX;
+        for(Deque<int>::iterator it = x.begin(); it != x.end(); ++it)
+            m = std::min(m, *it);
+        sink += m;
+    }
+    return seconds(b) / n + (sink == 0 ? 1e-15 : 0);}
+
+// ---------------
+// bench_monotonic
+// ---------------
+
+/**
+ * sliding minimum with a MonotonicDeque
+ * @return seconds per item
+ */
+double bench_monotonic (long n, long w) {
+    MonotonicDeque<int> x;
+    long sink = 0;
+    Clock::time_point b = Clock::now();
+    for(long i = 0; i < n; i++)
+    {
+        x.push_back(stream(i));
+        if(i >= w)
+            x.pop_front();
+        sink += x.front();
+    }
+    return seconds(b) / n + (sink == 0 ? 1e-15 : 0);}
+
+// ------------
+// bench_window
+// ------------
+
+/**
+ * sliding aggregate with a SlidingWindow
+ * @return seconds per item
+ */
+template <typename W>
+double bench_window (W& x, long n, long w) {
+    long sink = 0;
+    Clock::time_point b = Clock::now();
+    for(long i = 0; i < n; i++)
+    {
+        x.push_back(stream(i));
+        if(i >= w)
+            x.pop_front();
+        sink += x.query();
+    }
+    return seconds(b) / n + (sink == 0 ? 1e-15 : 0);}
+
+// -------------
+// bench_latency
+// -------------
+
+/**
+ * times every push and pop, in bursts of w pushes then w pops, so the
+ * amortized window has to flip w items at once; three times over, as a
+ * scheduler hiccup rarely hits the same operation twice
+ * @return the slowest operation of the fastest run, in seconds
+ */
+template <typename W>
+double bench_latency (W& x, long n, long w) {
+    double fastest = 1e9;
+    long sink = 0;
+    for(int r = 0; r < 3; r++)
+    {
+        double slowest = 0;
+        for(long i = 0; i < n; i += w)
+        {
+            for(long k = 0; k < w; k++)
+            {
+                Clock::time_point b = Clock::now();
+                x.push_back(stream(i + k));
+                sink += x.query();
+                slowest = std::max(slowest, seconds(b));
+            }
+            for(long k = 0; k < w; k++)
+            {
+                Clock::time_point b = Clock::now();
+                x.pop_front();
+                sink += x.query();
+                slowest = std::max(slowest, seconds(b));
+            }
+        }
+        fastest = std::min(fastest, slowest);
+    }
+    return fastest + (sink == 0 ? 1e-15 : 0);}
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    cout << "BenchSlidingWindow.c++" << endl;
+
+    const long n = 100000000;
+    for(long w = 16; w <= (1L << 20); w *= 16)
+    {
+        SlidingWindow<int, Min, false> amortized(INT_MAX);
+        SlidingWindow<int, Min, true>  worst(INT_MAX);
+        SlidingWindow<long>            sum;
+        cout << "window=" << w << endl;
+        if(w <= 256)
+            cout << "\tmin  Deque rescan "               << bench_naive(n / 100, w) * 1e9 << " ns" << endl;
+        cout << "\tmin  MonotonicDeque "                 << bench_monotonic(n, w) * 1e9 << " ns" << endl
+             << "\tmin  SlidingWindow amortized "        << bench_window(amortized, n, w) * 1e9 << " ns" << endl
+             << "\tmin  SlidingWindow worst case "       << bench_window(worst, n, w) * 1e9 << " ns" << endl
+             << "\tsum  SlidingWindow worst case "       << bench_window(sum, n, w) * 1e9 << " ns" << endl;
+    }
+
+    for(long w = 10000; w <= 1000000; w *= 10)
+    {
+        SlidingWindow<int, Min, false> amortized(INT_MAX);
+        SlidingWindow<int, Min, true>  worst(INT_MAX);
+        cout << "bursts of " << w << " pushes then " << w << " pops, slowest operation" << endl
+             << "\tSlidingWindow amortized "  << bench_latency(amortized, 10000000, w) * 1e6 << " us" << endl
+             << "\tSlidingWindow worst case " << bench_latency(worst, 10000000, w) * 1e6 << " us" << endl;
+    }
+
+    cout << "Done." << endl;
+    return 0;}
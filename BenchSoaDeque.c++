@@ -0,0 +1,120 @@
+// --------------------------------
+// projects/deque/BenchSoaDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// --------------------------------
+
+/*
+To run the benchmark:
+    % g++ -std=c++11 -O2 -DNDEBUG BenchSoaDeque.c++ -o BenchSoaDeque.app
+    % BenchSoaDeque.app
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>    // steady_clock
+#include <cstdint>   // int16_t, int32_t, int64_t
+#include <iostream>  // cout, endl
+
+#include "Deque.h"
+#include "SoaDeque.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// -------
+// seconds
+// -------
+
+double seconds (Clock::time_point b) {
+    return std::chrono::duration<double>(Clock::now() - b).count();}
+
+// ----
+// Tick
+// ----
+
+/**
+ * a market data tick, 40 bytes as a struct
+ */
+struct Tick {
+    std::int64_t timestamp;
+    double       price;
+    std::int64_t id;
+    std::int32_t quantity;
+    std::int16_t venue;
+    char         side;};
+
+typedef SoaDeque<std::int64_t, double, std::int64_t, std::int32_t, std::int16_t, char> Ticks;
+
+// -----
+// bench
+// -----
+
+/**
+ * sums the prices of n ticks, pushed at both ends, over and over
+ */
+void bench (long n) {
+    Deque<Tick> aos;
+    Ticks       soa;
+    for(long i = 0; i < n; i++)
+    {
+        Tick t = {i, 100.0 + i % 97, i * 3, (std::int32_t)(i % 1000), (std::int16_t)(i % 16), (char)(i & 1)};
+        if(i % 8 == 0)
+        {
+            aos.push_front(t);
+            soa.push_front(t.timestamp, t.price, t.id, t.quantity, t.venue, t.side);
+        }
+        else
+        {
+            aos.push_back(t);
+            soa.push_back(t.timestamp, t.price, t.id, t.quantity, t.venue, t.side);
+        }
+    }
+
+    int reps = (int)std::max(3L, 200000000L / n);
+    double sink = 0;
+
+    Clock::time_point b = Clock::now();
+    for(int r = 0; r < reps; r++)
+        for(Deque<Tick>::iterator it = aos.begin(); it != aos.end(); ++it)
+            sink += it->price;
+    double aos_scan = seconds(b) / reps;
+
+    b = Clock::now();
+    for(int r = 0; r < reps; r++)
+        for(long i = 0; i < n; i++)
+            sink += soa.get<1>(i);
+    double soa_index = seconds(b) / reps;
+
+    b = Clock::now();
+    for(int r = 0; r < reps; r++)
+        soa.for_each_span<1>([&] (const double* p, std::size_t k) {
+            double s = 0;
+            for(std::size_t i = 0; i < k; i++)
+                s += p[i];
+            sink += s;});
+    double soa_span = seconds(b) / reps;
+
+    std::cout << "n=" << n << (sink == 0 ? " " : "") << std::endl
+              << "\tprice scan  Deque<Tick> " << n / aos_scan / 1e6 << " M ticks/s, "
+              << n * sizeof(double) / aos_scan / 1e9 << " GB/s of prices" << std::endl
+              << "\tprice scan  SoaDeque get " << n / soa_index / 1e6 << " M ticks/s, "
+              << n * sizeof(double) / soa_index / 1e9 << " GB/s of prices" << std::endl
+              << "\tprice scan  SoaDeque spans " << n / soa_span / 1e6 << " M ticks/s, "
+              << n * sizeof(double) / soa_span / 1e9 << " GB/s of prices" << std::endl;}
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    cout << "BenchSoaDeque.c++" << endl;
+
+    bench(10000);       //fits in L1/L2
+    bench(1000000);
+    bench(20000000);
+
+    cout << "Done." << endl;
+    return 0;}
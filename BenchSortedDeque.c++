@@ -0,0 +1,161 @@
+// -----------------------------------
+// projects/deque/BenchSortedDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// -----------------------------------
+
+/*
+To run the benchmark:
+    % g++ -std=c++11 -O2 -DNDEBUG BenchSortedDeque.c++ -o BenchSortedDeque.app
+    % BenchSortedDeque.app
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // lower_bound
+#include <chrono>    // steady_clock
+#include <cstddef>   // size_t
+#include <cstdint>   // uint64_t
+#include <iostream>  // cout, endl
+
+#include "Deque.h"
+#include "SortedDeque.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// -------
+// seconds
+// -------
+
+double seconds (Clock::time_point b) {
+    return std::chrono::duration<double>(Clock::now() - b).count();}
+
+// --------
+// next_key
+// --------
+
+/**
+ * xorshift, so the keys looked up are the same for every contender
+ */
+std::uint64_t next_key (std::uint64_t& k) {
+    k ^= k << 13;
+    k ^= k >> 7;
+    k ^= k << 17;
+    return k;}
+
+// ------
+// lookup
+// ------
+
+/**
+ * ns per lower_bound of a random timestamp among n, each 1 to 4 after the last
+ */
+void lookup (std::size_t n) {
+    Deque<std::uint64_t> x;
+    SortedDeque<std::uint64_t> y;
+    std::uint64_t t = 0, k = 88172645463325252ULL, sink = 0;
+    for(std::size_t i = 0; i < n; i++)
+    {
+        t += 1 + next_key(k) % 4;
+        x.push_back(t);
+        y.push_back(t);
+    }
+    std::cout << n << " timestamps, ns per lower_bound" << std::endl;
+
+    const std::size_t slow = 200, fast = 2000000;
+    Clock::time_point b = Clock::now();
+    for(std::size_t i = 0; i < slow; i++)
+        sink += *std::lower_bound(x.begin(), x.end(), next_key(k) % t);
+    std::cout << "\tstd::lower_bound on Deque::iterator   " << seconds(b) / slow * 1e9 << " ns" << std::endl;
+
+    b = Clock::now();
+    for(std::size_t i = 0; i < fast; i++)
+    {
+        std::uint64_t v = next_key(k) % t;
+        std::size_t lo = 0, hi = n;
+        while(lo != hi)
+        {
+            std::size_t m = lo + (hi - lo) / 2;
+            if(x[m] < v)
+                lo = m + 1;
+            else
+                hi = m;
+        }
+        sink += lo;
+    }
+    std::cout << "\tbinary search with Deque::operator [] " << seconds(b) / fast * 1e9 << " ns" << std::endl;
+
+    b = Clock::now();
+    for(std::size_t i = 0; i < fast; i++)
+        sink += y.lower_bound(next_key(k) % t);
+    std::cout << "\tSortedDeque::lower_bound              " << seconds(b) / fast * 1e9 << " ns" << std::endl;
+
+    b = Clock::now();
+    for(std::size_t i = 0; i < fast; i++)
+    {
+        std::uint64_t v = next_key(k) % t;
+        sink += y.count(v, v + 1000);
+    }
+    std::cout << "\tSortedDeque::count, 1000 wide         " << seconds(b) / fast * 1e9 << " ns" << std::endl;
+    if(sink == 0)
+        std::cout << std::endl;}
+
+// ------
+// expiry
+// ------
+
+/**
+ * a sliding window of timestamps: each step pushes a batch of new ones and
+ * expires everything older than window; ns per item expired
+ */
+void expiry (std::size_t window, std::size_t batch, std::size_t steps) {
+    std::cout << "window " << window << ", " << batch << " per step, ns per item expired" << std::endl;
+    {
+    Deque<std::uint64_t> x;
+    std::uint64_t t = 0, expired = 0;
+    double spent = 0;
+    for(std::size_t s = 0; s < steps; s++)
+    {
+        for(std::size_t i = 0; i < batch; i++)
+            x.push_back(++t);
+        Clock::time_point b = Clock::now();
+        while(!x.empty() && x.front() + window <= t)
+        {
+            x.pop_front();
+            ++expired;
+        }
+        spent += seconds(b);
+    }
+    std::cout << "\tpop_front while expired               " << spent / expired * 1e9 << " ns" << std::endl;
+    }
+    {
+    SortedDeque<std::uint64_t> x;
+    std::uint64_t t = 0, expired = 0;
+    double spent = 0;
+    for(std::size_t s = 0; s < steps; s++)
+    {
+        for(std::size_t i = 0; i < batch; i++)
+            x.push_back(++t);
+        Clock::time_point b = Clock::now();
+        expired += x.pop_front_while([t, window] (std::uint64_t e) {return e + window <= t;});
+        spent += seconds(b);
+    }
+    std::cout << "\tSortedDeque::pop_front_while          " << spent / expired * 1e9 << " ns" << std::endl;
+    }}
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    cout << "BenchSortedDeque.c++" << endl;
+
+    lookup(10000000);
+    expiry(1000000, 10000, 2000);
+    expiry(1000000, 100, 200000);
+
+    cout << "Done." << endl;
+    return 0;}
@@ -0,0 +1,116 @@
+// ----------------------------------
+// projects/deque/BenchSpillDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// ----------------------------------
+
+/*
+To run the benchmark:
+    % g++ -std=c++11 -O2 -DNDEBUG -pthread BenchSpillDeque.c++ -o BenchSpillDeque.app
+    % BenchSpillDeque.app
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // max
+#include <chrono>    // steady_clock
+#include <cstdint>   // uint64_t
+#include <iostream>  // cout, endl
+
+#include "Deque.h"
+#include "SpillDeque.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// -------
+// seconds
+// -------
+
+double seconds (Clock::time_point b) {
+    return std::chrono::duration<double>(Clock::now() - b).count();}
+
+// ------
+// Record
+// ------
+
+struct Record {
+    std::uint64_t seq;
+    char payload[56];};
+
+// -----
+// bench
+// -----
+
+/**
+ * a producer outruns its consumer: n records pile up, then drain in order while
+ * the producer adds one for every two taken; M operations per second over each
+ * stretch of n / 4 operations, and the peak bytes of records held in memory
+ */
+template <typename C>
+void bench (const char* what, C& x, std::size_t n, std::size_t (*resident)(const C&)) {
+    std::cout << what << std::endl << "\tM ops/s per stretch:";
+    const std::size_t stretch = n / 4;
+    std::size_t ops = 0, peak = 0;
+    Clock::time_point b = Clock::now(), t = b;
+    auto tick = [&] () {
+        if(++ops % stretch == 0)
+        {
+            std::cout << " " << stretch / seconds(t) / 1e6;
+            peak = std::max(peak, resident(x));
+            t = Clock::now();
+        }};
+
+    Record r = Record();
+    for(std::size_t i = 0; i < n; i++)
+    {
+        r.seq = i;
+        x.push_back(r);
+        tick();
+    }
+    std::uint64_t sink = 0;
+    for(std::size_t i = 0; !x.empty(); i++)
+    {
+        sink += x.front().seq;
+        x.pop_front();
+        tick();
+        if(i % 2 == 0 && i < n)
+        {
+            r.seq = n + i;
+            x.push_back(r);
+            tick();
+        }
+    }
+    double s = seconds(b);
+    std::cout << (sink == 0 ? " " : "") << std::endl
+              << "\toverall " << ops / s / 1e6 << " M ops/s, peak in memory " << peak / (1 << 20) << " MiB" << std::endl;}
+
+std::size_t deque_resident (const Deque<Record>& x) {
+    return x.size() * sizeof(Record);}
+
+std::size_t spill_resident (const SpillDeque<Record>& x) {
+    return x.resident_bytes();}
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    cout << "BenchSpillDeque.c++" << endl;
+
+    const size_t n = (size_t)1 << 23;      // 512 MiB of 64-byte records
+    const size_t budget = (size_t)64 << 20;
+    cout << n * sizeof(Record) / (1 << 20) << " MiB backlog, " << budget / (1 << 20) << " MiB budget" << endl;
+    {
+    Deque<Record> x;
+    bench("Deque", x, n, deque_resident);
+    }
+    {
+    SpillDeque<Record> x(budget);
+    bench("SpillDeque", x, n, spill_resident);
+    }
+
+    cout << "Done." << endl;
+    return 0;}
@@ -0,0 +1,112 @@
+// -----------------------------------
+// projects/deque/BenchTieredDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// -----------------------------------
+
+/*
+To run the benchmark:
+    % g++ -std=c++11 -O2 -DNDEBUG BenchTieredDeque.c++ -o BenchTieredDeque.app
+    % BenchTieredDeque.app
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>    // steady_clock
+#include <deque>     // deque
+#include <iostream>  // cout, endl
+#include <vector>    // vector
+
+#include "Deque.h"
+#include "TieredDeque.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// -------
+// seconds
+// -------
+
+double seconds (Clock::time_point b) {
+    return std::chrono::duration<double>(Clock::now() - b).count();}
+
+// ----------
+// bench_edit
+// ----------
+
+/**
+ * an insert and an erase at random positions of an n item C, over and over
+ * for about the given time
+ * @return seconds per insert or erase
+ */
+template <typename C>
+double bench_edit (long n, double duration) {
+    C x;
+    for(long i = 0; i < n; i++)
+        x.push_back(i);
+
+    unsigned long r = 12345;
+    long ops = 0;
+    Clock::time_point b = Clock::now();
+    do
+    {
+        for(int k = 0; k < 8; k++, ops += 2)
+        {
+            r = r * 6364136223846793005UL + 1442695040888963407UL;
+            x.insert(x.begin() + (r >> 16) % (n + 1), (int)ops);
+            r = r * 6364136223846793005UL + 1442695040888963407UL;
+            x.erase(x.begin() + (r >> 16) % (n + 1));
+        }
+    }
+    while(seconds(b) < duration);
+    return seconds(b) / ops;}
+
+// -----------
+// bench_index
+// -----------
+
+/**
+ * @return seconds per operator [] at a random position of an n item C
+ */
+template <typename C>
+double bench_index (long n) {
+    C x;
+    for(long i = 0; i < n; i++)
+        x.push_back(i);
+
+    const long lookups = 10000000;
+    long sink = 0;
+    Clock::time_point b = Clock::now();
+    for(long k = 0; k < lookups; k++)
+        sink += x[(k * 7919L) % n];
+    double t = seconds(b) / lookups;
+    return t + (sink == 0 ? 1e-12 : 0);}
+
+// -----
+// bench
+// -----
+
+void bench (long n) {
+    std::cout << "n=" << n << std::endl
+              << "\tinsert/erase   Deque " << bench_edit< Deque<int> >(n, 1.0) * 1e6 << " us"
+              << "\tstd::deque " << bench_edit< std::deque<int> >(n, 1.0) * 1e6 << " us"
+              << "\tTieredDeque " << bench_edit< TieredDeque<int> >(n, 1.0) * 1e6 << " us" << std::endl
+              << "\tindex          Deque " << bench_index< Deque<int> >(n) * 1e9 << " ns"
+              << "\tstd::deque " << bench_index< std::deque<int> >(n) * 1e9 << " ns"
+              << "\tTieredDeque " << bench_index< TieredDeque<int> >(n) * 1e9 << " ns" << std::endl;}
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    cout << "BenchTieredDeque.c++" << endl;
+
+    bench(1000000);
+    bench(10000000);
+    bench(100000000);
+
+    cout << "Done." << endl;
+    return 0;}
@@ -0,0 +1,1279 @@
+// -------------------------
+// projects/deque/BitDeque.h
+// Copyright (C) 2010
+// Glenn P. Downing
+// -------------------------
+
+#ifndef BitDeque_h
+#define BitDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // equal, lexicographical_compare, min, swap
+#include <cassert>   // assert
+#include <cstdint>   // uint64_t
+#include <iterator>  // bidirectional_iterator_tag, reverse_iterator
+#include <stdexcept> // out_of_range
+#include <utility>   // forward, move
+
+#include "Deque.h"
+
+// -----------
+// Deque<bool>
+// -----------
+
+/**
+ * Deque<bool> packs its flags 64 to a word, in a Deque of words, so a flag takes
+ * a bit (plus the words' share of the map) instead of a byte plus the block's
+ * share. Flag i is bit beginBit + i of the words. Elements are bits, so the
+ * references are proxies, like std::vector<bool>'s.
+ *
+ * The count of set flags is kept up to date, so count() is O(1) and the rate of a
+ * rolling window of outcomes is count() / size(). count(first, last) and
+ * find_first run a word at a time with popcount and count-trailing-zeros, which
+ * GCC and Clang compile to the hardware instructions when the target has them
+ * (-mpopcnt, -mbmi or -march=native).
+ *
+ * Otherwise it has Deque's interface, a word at a time where Deque's goes a block
+ * at a time: append, prepend and split_at move whole words by pointer when the
+ * seam falls on the same bit of a word on both sides, and shift the shorter side
+ * in 64-flag chunks when it doesn't. linearize leaves flag i at bit i % 64 of
+ * word i / 64. for_each_span and for_each_span_reverse are missing: there are no
+ * bools in memory for them to point at; count and find_first scan by words.
+ */
+template <typename A>
+class Deque<bool, A> {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef A                                        allocator_type;
+        typedef typename allocator_type::value_type      value_type;
+
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::difference_type difference_type;
+
+        typedef bool                                     const_reference;
+
+        typedef std::uint64_t                            word_type;
+
+    public:
+        // -----------
+        // operator ==
+        // -----------
+
+        /**
+         * @param lhs the Deque on the left hand side of operator ==
+         * @param rhs the Deque on the right hand side of operator ==
+         * @return true if they are equal false otherwise
+         */
+        friend bool operator == (const Deque& lhs, const Deque& rhs) {
+            return lhs.size() == rhs.size() && lhs.count() == rhs.count() && std::equal(lhs.begin(), lhs.end(), rhs.begin());}
+
+        // ----------
+        // operator <
+        // ----------
+
+        /**
+         * @param lhs the Deque on the left hand side of operator <
+         * @param rhs the Deque on the right hand side of operator <
+         * @return true if lhs < rhs is true, false otherwise
+         */
+        friend bool operator < (const Deque& lhs, const Deque& rhs) {
+            return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());}
+
+    private:
+        typedef typename std::allocator_traits<A>::template rebind_alloc<word_type> word_allocator_type;
+
+        static const size_type bits = 64;
+
+        // ----
+        // data
+        // ----
+
+        Deque<word_type, word_allocator_type> words;  //the flags, 64 to a word
+        size_type beginBit;                           //bit of words[0] holding flag 0, < 64
+        size_type mysize;                             //number of flags
+        size_type ones;                               //number of flags set
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        /*
+         * @return true if Deque is valid
+         */
+        bool valid () const {
+            return beginBit < bits && words.size() == (beginBit + mysize + bits - 1) / bits && ones <= mysize;}
+
+        // ----
+        // bits
+        // ----
+
+        /**
+         * @return the number of bits set in x
+         */
+        static size_type popcount (word_type x) {
+#if defined(__GNUC__)
+            return __builtin_popcountll(x);
+#else
+            x = x - ((x >> 1) & 0x5555555555555555ULL);
+            x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+            x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+            return (x * 0x0101010101010101ULL) >> 56;
+#endif
+        }
+
+        /**
+         * @return the index of the lowest bit set in x
+         * @pre x != 0
+         */
+        static size_type lowest (word_type x) {
+#if defined(__GNUC__)
+            return __builtin_ctzll(x);
+#else
+            return popcount((x & -x) - 1);
+#endif
+        }
+
+        /**
+         * @return a word with the low n bits set
+         * @pre n <= 64
+         */
+        static word_type low (size_type n) {
+            return (n == bits) ? ~(word_type)0 : (((word_type)1 << n) - 1);}
+
+        /**
+         * @return flag i
+         */
+        bool get (size_type i) const {
+            size_type p = beginBit + i;
+            return (words[p / bits] >> (p % bits)) & 1;}
+
+        /**
+         * sets flag i to v, keeping ones up to date
+         */
+        void set (size_type i, bool v) {
+            size_type p = beginBit + i;
+            word_type& w = words[p / bits];
+            word_type  m = (word_type)1 << (p % bits);
+            if(((w & m) != 0) == v)
+                return;
+            w ^= m;
+            if(v)
+                ++ones;
+            else
+                --ones;}
+
+        /**
+         * @return flags [i, i + n), flag i in the lowest bit
+         * @pre n <= 64, i + n <= size()
+         */
+        word_type get_bits (size_type i, size_type n) const {
+            if(n == 0)
+                return 0;
+            size_type p = beginBit + i;
+            word_type w = words[p / bits] >> (p % bits);
+            if(p % bits + n > bits)
+                w |= words[p / bits + 1] << (bits - p % bits);
+            return w & low(n);}
+
+        /**
+         * adds the low n bits of x to the front of the container, the lowest first
+         * @pre n <= 64
+         */
+        void push_front_bits (word_type x, size_type n) {
+            if(n == 0)
+                return;
+            x &= low(n);
+            if(beginBit >= n)
+            {
+                beginBit -= n;
+                words.front() = (words.front() & ~(low(n) << beginBit)) | (x << beginBit);
+            }
+            else
+            {
+                size_type r = n - beginBit;     //bits that go into a new front word
+                if(beginBit != 0)
+                    words.front() = (words.front() & ~low(beginBit)) | (x >> r);
+                words.push_front(x << (bits - r));
+                beginBit = bits - r;
+            }
+            mysize += n;
+            ones   += popcount(x);}
+
+    public:
+        // ---------
+        // reference
+        // ---------
+
+        /**
+         * stands in for a reference to a flag
+         */
+        class reference {
+            private:
+                Deque* myDeque;
+                size_type index;
+
+            public:
+                /**
+                 * @param myDeque the Deque holding the flag
+                 * @param index the index of the flag
+                 */
+                reference (Deque& myDeque, size_type index) : myDeque(&myDeque), index(index) {}
+
+                /**
+                 * @return the flag
+                 */
+                operator bool () const {
+                    return myDeque->get(index);}
+
+                /**
+                 * @param v the value to set the flag to
+                 */
+                reference& operator = (bool v) {
+                    myDeque->set(index, v);
+                    return *this;}
+
+                /**
+                 * @param that the reference whose flag to copy
+                 */
+                reference& operator = (const reference& that) {
+                    return *this = (bool)that;}
+
+                /**
+                 * negates the flag
+                 */
+                void flip () {
+                    myDeque->set(index, !myDeque->get(index));}};
+
+        // --------
+        // iterator
+        // --------
+
+        class iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::bidirectional_iterator_tag iterator_category;
+                typedef typename Deque::value_type      value_type;
+                typedef typename Deque::difference_type difference_type;
+                typedef void                            pointer;
+                typedef typename Deque::reference       reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                /**
+                 * @param lhs the iterator on the left hand side of operator ==
+                 * @param rhs the iterator on the right hand side of operator ==
+                 * @return true if lhs == rhs is true, false otherwise
+                 */
+                friend bool operator == (const iterator& lhs, const iterator& rhs) {
+                    return lhs.index == rhs.index && lhs.myDeque == rhs.myDeque;}
+
+                // ----------
+                // operator +
+                // ----------
+
+                /**
+                 * Increments the iterator by rhs
+                 * @param lhs the iterator on the left hand side of operator +
+                 * @param rhs the amount to increment by
+                 */
+                friend iterator operator + (iterator lhs, difference_type rhs) {
+                    return lhs += rhs;}
+
+                // ----------
+                // operator -
+                // ----------
+
+                /**
+                 * Decrements the iterator by rhs
+                 * @param lhs the iterator on the left hand side of operator -
+                 * @param rhs the amount to decrement by
+                 */
+                friend iterator operator - (iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;}
+
+            private:
+                // ----
+                // data
+                // ----
+
+                size_type index;        //index to the flag in Deque we are pointing at
+                Deque* myDeque;         //the Deque which the iterator is operating on
+
+                friend class Deque;
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                /**
+                 * @param myDeque the Deque to iterate over
+                 * @param index the index location in myDeque to point at initially
+                 */
+                iterator (Deque& myDeque, size_type index) : index(index), myDeque(&myDeque) {}
+
+                // ----------
+                // operator *
+                // ----------
+
+                /**
+                 * @return a reference to the flag which this iterator is currently pointing at
+                 */
+                reference operator * () const {
+                    return reference(*myDeque, index);}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                /**
+                 * Increments the iterator one place
+                 * @return the iterator after being incremented
+                 */
+                iterator& operator ++ () {
+                    index++;
+                    return *this;}
+
+                /**
+                 * Increments the iterator one place
+                 * @return the iterator before being incremented
+                 */
+                iterator operator ++ (int) {
+                    iterator x = *this;
+                    ++(*this);
+                    return x;}
+
+                // -----------
+                // operator --
+                // -----------
+
+                /**
+                 * Decrements the iterator one place
+                 * @return the iterator after being decremented
+                 */
+                iterator& operator -- () {
+                    index--;
+                    return *this;}
+
+                /**
+                 * Decrements the iterator one place
+                 * @return the iterator before being decremented
+                 */
+                iterator operator -- (int) {
+                    iterator x = *this;
+                    --(*this);
+                    return x;}
+
+                // -----------
+                // operator +=
+                // -----------
+
+                /**
+                 * Increments the iterator by d
+                 * @param d the amount to increment by
+                 * @return the iterator after being incremented
+                 */
+                iterator& operator += (difference_type d) {
+                    index += d;
+                    return *this;}
+
+                // -----------
+                // operator -=
+                // -----------
+
+                /**
+                 * Decrements the iterator by d
+                 * @param d the amount to decrement by
+                 * @return the iterator after being decremented
+                 */
+                iterator& operator -= (difference_type d) {
+                    index -= d;
+                    return *this;}};
+
+    public:
+        // --------------
+        // const_iterator
+        // --------------
+
+        class const_iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::bidirectional_iterator_tag iterator_category;
+                typedef typename Deque::value_type      value_type;
+                typedef typename Deque::difference_type difference_type;
+                typedef void                            pointer;
+                typedef typename Deque::const_reference reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                /**
+                 * @param lhs the iterator on the left hand side of operator ==
+                 * @param rhs the iterator on the right hand side of operator ==
+                 * @return true if lhs == rhs is true, false otherwise
+                 */
+                friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs.index == rhs.index && lhs.myDeque == rhs.myDeque;}
+
+                // ----------
+                // operator +
+                // ----------
+
+                /**
+                 * Increments the iterator by rhs
+                 * @param lhs the iterator on the left hand side of operator +
+                 * @param rhs the amount to increment by
+                 */
+                friend const_iterator operator + (const_iterator lhs, difference_type rhs) {
+                    return lhs += rhs;}
+
+                // ----------
+                // operator -
+                // ----------
+
+                /**
+                 * Decrements the iterator by rhs
+                 * @param lhs the iterator on the left hand side of operator -
+                 * @param rhs the amount to decrement by
+                 */
+                friend const_iterator operator - (const_iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;}
+
+            private:
+                // ----
+                // data
+                // ----
+
+                size_type index;        //index to the flag in Deque we are pointing at
+                const Deque* myDeque;   //the Deque which the iterator is reading
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                /**
+                 * @param myDeque the Deque to iterate over
+                 * @param index the index location in myDeque to point at initially
+                 */
+                const_iterator (const Deque& myDeque, size_type index) : index(index), myDeque(&myDeque) {}
+
+                // ----------
+                // operator *
+                // ----------
+
+                /**
+                 * @return the flag which this iterator is currently pointing at
+                 */
+                reference operator * () const {
+                    return myDeque->get(index);}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                /**
+                 * Increments the iterator one place
+                 * @return the iterator after being incremented
+                 */
+                const_iterator& operator ++ () {
+                    index++;
+                    return *this;}
+
+                /**
+                 * Increments the iterator one place
+                 * @return the iterator before being incremented
+                 */
+                const_iterator operator ++ (int) {
+                    const_iterator x = *this;
+                    ++(*this);
+                    return x;}
+
+                // -----------
+                // operator --
+                // -----------
+
+                /**
+                 * Decrements the iterator one place
+                 * @return the iterator after being decremented
+                 */
+                const_iterator& operator -- () {
+                    index--;
+                    return *this;}
+
+                /**
+                 * Decrements the iterator one place
+                 * @return the iterator before being decremented
+                 */
+                const_iterator operator -- (int) {
+                    const_iterator x = *this;
+                    --(*this);
+                    return x;}
+
+                // -----------
+                // operator +=
+                // -----------
+
+                /**
+                 * Increments the iterator by d
+                 * @param d the amount to increment by
+                 * @return the iterator after being incremented
+                 */
+                const_iterator& operator += (difference_type d) {
+                    index += d;
+                    return *this;}
+
+                // -----------
+                // operator -=
+                // -----------
+
+                /**
+                 * Decrements the iterator by d
+                 * @param d the amount to decrement by
+                 * @return the iterator after being decremented
+                 */
+                const_iterator& operator -= (difference_type d) {
+                    index -= d;
+                    return *this;}};
+
+    public:
+        // -----------------
+        // reverse_iterators
+        // -----------------
+
+        typedef std::reverse_iterator<iterator>       reverse_iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Constructs empty Deque
+         * @param a allocator to use
+         */
+        explicit Deque (const allocator_type& a = allocator_type()) :
+                words(word_allocator_type(a)), beginBit(0), mysize(0), ones(0) {
+            assert(valid());}
+
+        /**
+         * Constructs deque of size s with initial values v using allocator a
+         * @param s size of deque
+         * @param v intial value to use
+         * @param a allocator to use, defaulted to allocator_type()
+         */
+        explicit Deque (size_type s, bool v = false, const allocator_type& a = allocator_type()) :
+                words(word_allocator_type(a)), beginBit(0), mysize(0), ones(0) {
+            resize(s, v);
+            assert(valid());}
+
+        /**
+         * Copy constructor, copies the words
+         * @param that Deque to copy
+         */
+        Deque (const Deque& that) :
+                words(that.words), beginBit(that.beginBit), mysize(that.mysize), ones(that.ones) {
+            assert(valid());}
+
+        /**
+         * Move constructor, takes that's words in O(1) and leaves it empty
+         * @param that Deque to move from
+         */
+        Deque (Deque&& that) : beginBit(0), mysize(0), ones(0) {
+            swap(that);}
+
+        // ----------
+        // operator =
+        // ----------
+
+        /**
+         * assign rhs to this
+         * @param rhs Deque whose flags we'll copy
+         */
+        Deque& operator = (const Deque& rhs) {
+            Deque that(rhs);
+            swap(that);
+            return *this;}
+
+        /**
+         * Move assignment, takes rhs's words in O(1) and leaves it empty
+         * @param rhs Deque to take the flags of
+         */
+        Deque& operator = (Deque&& rhs) {
+            Deque that(std::move(rhs));
+            swap(that);
+            return *this;}
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+         * @return a reference to the flag at index
+         * @pre index w/in range [0, size())
+         */
+        reference operator [] (size_type index) {
+            return reference(*this, index);}
+
+        /**
+         * @return the flag at index
+         * @pre index w/in range [0, size())
+         */
+        const_reference operator [] (size_type index) const {
+            return get(index);}
+
+        // ------
+        // append
+        // ------
+
+        /**
+         * Moves the flags of that onto the back of this, leaving that empty. When the
+         * seam falls on the same bit of a word on both sides, the two seam words merge
+         * and the rest of that's words move by pointer; otherwise the shorter side is
+         * shifted across in 64-flag chunks. Costs O(words), a word op per 64 flags of
+         * the shorter side at worst.
+         * @param that Deque to take the flags of
+         * @pre that uses an allocator equal to ours
+         */
+        void append (Deque&& that) {
+            size_type off = (beginBit + mysize) % bits;
+            if(that.empty())
+                return;
+            if(empty())
+                swap(that);
+            else if(off == that.beginBit)
+            {
+                if(off != 0)
+                {
+                    words.back() = (words.back() & low(off)) | (that.words.front() & ~low(off));
+                    that.words.pop_front();
+                }
+                words.append(std::move(that.words));
+                mysize += that.mysize;
+                ones   += that.ones;
+            }
+            else if(that.size() <= size())
+                for(size_type i = 0; i < that.size(); i += bits)
+                    push_back_bits(that.get_bits(i, std::min((size_type)bits, that.size() - i)), std::min((size_type)bits, that.size() - i));
+            else
+            {
+                for(size_type e = size(); e != 0; )
+                {
+                    size_type k = std::min((size_type)bits, e);
+                    e -= k;
+                    that.push_front_bits(get_bits(e, k), k);
+                }
+                swap(that);
+            }
+            that.clear();
+            assert(valid());}
+
+        // --
+        // at
+        // --
+
+        /**
+         * @return a reference to the flag at index
+         * @throws out_of_range exception if index not in [0, size())
+         */
+        reference at (size_type index) {
+            if(index >= size())
+                throw std::out_of_range("Deque::at()");
+            return (*this)[index];}
+
+        /**
+         * @return the flag at index
+         * @throws out_of_range exception if index not in [0, size())
+         */
+        const_reference at (size_type index) const {
+            return const_cast<Deque*>(this)->at(index);}
+
+        // ----
+        // back
+        // ----
+
+        /**
+         * @pre not empty
+         * @return a reference to the last flag
+         */
+        reference back () {
+            return (*this)[size() - 1];}
+
+        /**
+         * @pre not empty
+         * @return the last flag
+         */
+        const_reference back () const {
+            return get(size() - 1);}
+
+        // -----
+        // begin
+        // -----
+
+        /**
+         * @return iterator pointing to start of deque
+         */
+        iterator begin () {
+            return iterator(*this, 0);}
+
+        /**
+         * @return const_iterator pointing to start of deque
+         */
+        const_iterator begin () const {
+            return const_iterator(*this, 0);}
+
+        // ------
+        // cbegin
+        // ------
+
+        /**
+         * @return const_iterator pointing to start of deque
+         */
+        const_iterator cbegin () const {
+            return begin();}
+
+        // ----
+        // cend
+        // ----
+
+        /**
+         * @return const_iterator pointing to one past the last flag
+         */
+        const_iterator cend () const {
+            return end();}
+
+        // -------
+        // crbegin
+        // -------
+
+        /**
+         * @return const_reverse_iterator pointing to the last flag
+         */
+        const_reverse_iterator crbegin () const {
+            return rbegin();}
+
+        // -----
+        // crend
+        // -----
+
+        /**
+         * @return const_reverse_iterator pointing to one before the first flag
+         */
+        const_reverse_iterator crend () const {
+            return rend();}
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * removes every flag, leaving size = 0
+         */
+        void clear () {
+            words.clear();
+            beginBit = mysize = ones = 0;
+            assert(valid());}
+
+        // -----
+        // count
+        // -----
+
+        /**
+         * @return the number of flags set, in O(1)
+         */
+        size_type count () const {
+            return ones;}
+
+        /**
+         * @return the number of flags set in [first, last), a popcount per word
+         * @pre first <= last <= size()
+         */
+        size_type count (size_type first, size_type last) const {
+            if(first >= last)
+                return 0;
+            size_type p = beginBit + first, q = beginBit + last;
+            size_type wp = p / bits, wq = (q - 1) / bits;
+            if(wp == wq)
+                return popcount((words[wp] >> (p % bits)) & low(q - p));
+            size_type n = popcount(words[wp] >> (p % bits));
+            for(size_type k = wp + 1; k < wq; k++)
+                n += popcount(words[k]);
+            return n + popcount(words[wq] & low(q - wq * bits));}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return size == 0
+         */
+        bool empty () const {
+            return !size();}
+
+        // ---
+        // end
+        // ---
+
+        /**
+         * @return iterator pointing to one past the last flag
+         */
+        iterator end () {
+            return iterator(*this, size());}
+
+        /**
+         * @return const_iterator pointing to one past the last flag
+         */
+        const_iterator end () const {
+            return const_iterator(*this, size());}
+
+        // -----
+        // erase
+        // -----
+
+        /**
+         * removes the flag at it, moving the flags on its shorter side over by one
+         * @return iterator to the flag after the one removed
+         */
+        iterator erase (iterator it) {
+            size_type i = it.index;
+            if(i < size() / 2)
+            {
+                for(size_type j = i; j > 0; j--)
+                    set(j, get(j - 1));
+                pop_front();
+            }
+            else
+            {
+                for(size_type j = i; j + 1 < size(); j++)
+                    set(j, get(j + 1));
+                pop_back();
+            }
+            return iterator(*this, i);}
+
+        // ----------
+        // find_first
+        // ----------
+
+        /**
+         * @param v the value to look for
+         * @param from the index to start looking at
+         * @return the index of the first flag equal to v at or after from, size() if none,
+         * a count-trailing-zeros per word
+         */
+        size_type find_first (bool v = true, size_type from = 0) const {
+            if(from >= size())
+                return size();
+            size_type p = beginBit + from, q = beginBit + size();
+            size_type k = p / bits, wq = (q - 1) / bits;
+            word_type w = (v ? words[k] : ~words[k]) & ~low(p % bits);
+            while(w == 0 && k < wq)
+            {
+                ++k;
+                w = v ? words[k] : ~words[k];
+            }
+            if(w == 0)
+                return size();
+            size_type i = k * bits + lowest(w) - beginBit;
+            return std::min(i, size());}
+
+        // -----
+        // front
+        // -----
+
+        /**
+         * @pre not empty
+         * @return a reference to the first flag
+         */
+        reference front () {
+            return (*this)[0];}
+
+        /**
+         * @pre not empty
+         * @return the first flag
+         */
+        const_reference front () const {
+            return get(0);}
+
+        // ------
+        // insert
+        // ------
+
+        /**
+         * inserts v before it, moving the flags on its shorter side over by one
+         * @return iterator to the inserted flag
+         */
+        iterator insert (iterator it, bool v) {
+            size_type i = it.index;
+            if(i < size() / 2)
+            {
+                push_front(false);
+                for(size_type j = 0; j < i; j++)
+                    set(j, get(j + 1));
+            }
+            else
+            {
+                push_back(false);
+                for(size_type j = size() - 1; j > i; j--)
+                    set(j, get(j - 1));
+            }
+            set(i, v);
+            return iterator(*this, i);}
+
+        // ---------
+        // linearize
+        // ---------
+
+        /**
+         * Shifts the flags to bit 0 of the first word and linearizes the words, so
+         * that flag i is bit i % 64 of word i / 64.
+         */
+        void linearize () {
+            if(beginBit != 0)
+            {
+                size_type n = words.size();
+                for(size_type k = 0; k < n; k++)
+                {
+                    word_type w = words[k] >> beginBit;
+                    if(k + 1 < n)
+                        w |= words[k + 1] << (bits - beginBit);
+                    words[k] = w;
+                }
+                beginBit = 0;
+                if(words.size() > (mysize + bits - 1) / bits)
+                    words.pop_back();
+            }
+            words.linearize();
+            assert(valid());}
+
+        // ---
+        // pop
+        // ---
+
+        /**
+         * Deletes the flag at the back of the container
+         * @pre container not empty
+         */
+        void pop_back () {
+            set(size() - 1, false);
+            --mysize;
+            if((beginBit + mysize) % bits == 0)
+                words.pop_back();
+            assert(valid());}
+
+        /**
+         * Deletes the flag at the front of the container.
+         * @pre container not empty
+         */
+        void pop_front () {
+            ones -= (words.front() >> beginBit) & 1;
+            --mysize;
+            if(++beginBit == bits)
+            {
+                words.pop_front();
+                beginBit = 0;
+            }
+            assert(valid());}
+
+        /**
+         * Moves up to n flags off the front of the container into out, reading them
+         * a word at a time
+         * @param out where the flags are written to
+         * @param n maximum number of flags to take
+         * @return out past the last flag written
+         */
+        template <typename OutputIt>
+        OutputIt pop_front_into (OutputIt out, size_type n) {
+            n = std::min(n, size());
+            for(size_type i = 0; i < n; i += bits)
+            {
+                size_type k = std::min((size_type)bits, n - i);
+                word_type w = get_bits(i, k);
+                for(size_type j = 0; j < k; j++)
+                    *out++ = ((w >> j) & 1) != 0;
+            }
+            pop_front_n(n);
+            return out;}
+
+        /**
+         * Deletes the first n flags, a word at a time
+         * @pre n <= size()
+         */
+        void pop_front_n (size_type n) {
+            ones -= count(0, n);
+            mysize   -= n;
+            beginBit += n;
+            while(beginBit >= bits)
+            {
+                words.pop_front();
+                beginBit -= bits;
+            }
+            assert(valid());}
+
+        // -------
+        // prepend
+        // -------
+
+        /**
+         * Moves the flags of that onto the front of this, leaving that empty, the
+         * same way append does.
+         * @param that Deque to take the flags of
+         * @pre that uses an allocator equal to ours
+         */
+        void prepend (Deque&& that) {
+            that.append(std::move(*this));
+            swap(that);
+            assert(valid());}
+
+        // ----
+        // push
+        // ----
+
+        /**
+         * adds a flag to back of container
+         * @param v flag to be added
+         */
+        void push_back (bool v) {
+            size_type off = (beginBit + mysize) % bits;
+            if(off == 0)
+                words.push_back(v);
+            else
+            {
+                word_type& w = words.back();
+                w = (w & low(off)) | ((word_type)v << off);
+            }
+            ++mysize;
+            ones += v;
+            assert(valid());}
+
+        /**
+         * adds the low n bits of x to the back of the container, lowest first,
+         * a word at a time
+         * @pre n <= 64
+         */
+        void push_back_bits (word_type x, size_type n) {
+            if(n == 0)
+                return;
+            x &= low(n);
+            size_type off = (beginBit + mysize) % bits;
+            if(off == 0)
+                words.push_back(x);
+            else
+            {
+                word_type& w = words.back();
+                w = (w & low(off)) | (x << off);
+                if(off + n > bits)
+                    words.push_back(x >> (bits - off));
+            }
+            mysize += n;
+            ones   += popcount(x);
+            assert(valid());}
+
+        /**
+         * adds n flags to the back of the container, each one generator(), packed a
+         * word at a time
+         * @param generator called once per flag, in order
+         * @param n number of flags to add
+         */
+        template <typename G>
+        void push_back_n (G generator, size_type n) {
+            for(size_type i = 0; i < n; i += bits)
+            {
+                size_type k = std::min((size_type)bits, n - i);
+                word_type w = 0;
+                for(size_type j = 0; j < k; j++)
+                    w |= (word_type)(bool)generator() << j;
+                push_back_bits(w, k);
+            }}
+
+        /**
+         * adds n flags to the back of the container, each one constructed from args,
+         * a word at a time
+         * @param n number of flags to add
+         * @param args constructor arguments of the flag, none for false
+         */
+        template <typename... Args>
+        void emplace_back_n (size_type n, const Args&... args) {
+            const word_type w = value_type(args...) ? ~(word_type)0 : 0;
+            for(size_type i = 0; i < n; i += bits)
+                push_back_bits(w, std::min((size_type)bits, n - i));}
+
+        /**
+         * adds flag to the front of the container
+         * @param v flag to push to front.
+         */
+        void push_front (bool v) {
+            if(beginBit == 0)
+            {
+                words.push_front(0);
+                beginBit = bits;
+            }
+            --beginBit;
+            ++mysize;
+            word_type m = (word_type)1 << beginBit;
+            words.front() = v ? (words.front() | m) : (words.front() & ~m);
+            ones += v;
+            assert(valid());}
+
+        // ------
+        // rbegin
+        // ------
+
+        /**
+         * @return reverse_iterator pointing to the last flag
+         */
+        reverse_iterator rbegin () {
+            return reverse_iterator(end());}
+
+        /**
+         * @return const_reverse_iterator pointing to the last flag
+         */
+        const_reverse_iterator rbegin () const {
+            return const_reverse_iterator(end());}
+
+        // -------------
+        // release_async
+        // -------------
+
+        /**
+         * Empties the deque in O(1) and hands the teardown of its words to e, as
+         * Deque::release_async does
+         * @param e called once with a task callable as task()
+         */
+        template <typename E>
+        void release_async (E&& e) {
+            words.release_async(std::forward<E>(e));
+            beginBit = mysize = ones = 0;
+            assert(valid());}
+
+        // ----
+        // rend
+        // ----
+
+        /**
+         * @return reverse_iterator pointing to one before the first flag
+         */
+        reverse_iterator rend () {
+            return reverse_iterator(begin());}
+
+        /**
+         * @return const_reverse_iterator pointing to one before the first flag
+         */
+        const_reverse_iterator rend () const {
+            return const_reverse_iterator(begin());}
+
+        // ------
+        // resize
+        // ------
+
+        /**
+         * resizes the deque to s, pushing copies of v onto the back a word at a time
+         * when it grows
+         * @param s the size to resize to
+         * @param v the value to fill new slots with
+         */
+        void resize (size_type s, bool v = false) {
+            while(size() > s)
+                pop_back();
+            while(size() < s)
+                push_back_bits(v ? ~(word_type)0 : 0, std::min(s - size(), (size_type)bits));
+            assert(valid());}
+
+        // ----------------------
+        // set_incremental_growth
+        // ----------------------
+
+        /**
+         * @param on whether the words' map grows a few rows per push instead of all at once
+         */
+        void set_incremental_growth (bool on) {
+            words.set_incremental_growth(on);}
+
+        // -------------
+        // shrink_to_fit
+        // -------------
+
+        /**
+         * gives back the unused part of the words' map
+         */
+        void shrink_to_fit () {
+            words.shrink_to_fit();}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return the number of flags in the deque
+         */
+        size_type size () const {
+            return mysize;}
+
+        // --------
+        // split_at
+        // --------
+
+        /**
+         * Moves the flags from pos on into a new Deque. The words after the one
+         * holding flag pos move by pointer; that word is copied to both sides when
+         * pos falls inside it. The count of the shorter side is popcounted.
+         * @param pos index of the first flag to move out
+         * @return the flags [pos, size())
+         * @pre pos w/in range [0, size()]
+         */
+        Deque split_at (size_type pos) {
+            Deque that;
+            if(pos == size())
+                return that;
+            size_type p = beginBit + pos;
+            size_type thatOnes = (pos < size() - pos) ? ones - count(0, pos) : count(pos, size());
+            if(p % bits == 0)
+                that.words = words.split_at(p / bits);
+            else
+            {
+                that.words = words.split_at(p / bits + 1);
+                that.words.push_front(words.back() & ~low(p % bits));
+                words.back() &= low(p % bits);
+            }
+            that.beginBit = p % bits;
+            that.mysize   = size() - pos;
+            that.ones     = thatOnes;
+            mysize = pos;
+            ones  -= thatOnes;
+            assert(valid());
+            assert(that.valid());
+            return that;}
+
+        // ----
+        // swap
+        // ----
+
+        /**
+         * @param that Deque to swap underlying data with
+         */
+        void swap (Deque& that) {
+            words.swap(that.words);
+            std::swap(beginBit, that.beginBit);
+            std::swap(mysize, that.mysize);
+            std::swap(ones, that.ones);
+            assert(valid());}};
+
+#endif // BitDeque_h
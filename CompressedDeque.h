@@ -0,0 +1,771 @@
+// --------------------------------
+// projects/deque/CompressedDeque.h
+// Copyright (C) 2010
+// Glenn P. Downing
+// --------------------------------
+
+#ifndef CompressedDeque_h
+#define CompressedDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm>   // equal, lexicographical_compare, min
+#include <cassert>     // assert
+#include <cstdint>     // uint64_t
+#include <iterator>    // bidirectional_iterator_tag
+#include <memory>      // allocator, allocator_traits
+#include <stdexcept>   // out_of_range
+#include <type_traits> // is_integral, make_unsigned
+
+#include "Deque.h"
+
+// ---------------
+// CompressedDeque
+// ---------------
+
+/**
+ * A Deque of integers (timestamps, IDs, ...) that keeps its interior compressed.
+ * Items near the two ends sit uncompressed in two small Deques, head and tail,
+ * so push and pop stay cheap. Once one of them holds two blocks' worth of items,
+ * the block of them next to the interior is frozen: encoded and moved into the
+ * frozen Deque of encoded blocks; popping an end that is empty thaws the block
+ * next to it back out.
+ *
+ * A frozen block of 128 items is bit-packed with a frame of reference: it keeps
+ * its first item, the smallest of its deltas (item minus the one before it) or
+ * of its items, whichever spread is narrower, and every delta or item minus that
+ * smallest one in just enough bits for the largest. Nearly monotonic sequences
+ * pack into a few bits per item; random ones cost 8 bytes per item plus 24 per block.
+ *
+ * An item of a block that packs items is read straight out of it. Reading one of
+ * a block that packs deltas decodes the whole block into a small direct-mapped
+ * cache of decoded blocks, so local accesses decode each block once; the cache
+ * makes even const access unsafe to share between threads. for_each_span decodes
+ * block by block for scans.
+ */
+template < typename T, typename A = std::allocator<T> >
+class CompressedDeque {
+    static_assert(std::is_integral<T>::value, "CompressedDeque holds integers");
+
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef A                                        allocator_type;
+        typedef typename allocator_type::value_type      value_type;
+
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::difference_type difference_type;
+
+        /**
+         * items per frozen block, and the number of decoded blocks cached
+         */
+        static const size_type blockSize = 128;
+        static const size_type cacheSize = 4;
+
+    public:
+        // -----------
+        // operator ==
+        // -----------
+
+        /**
+         * @param lhs the CompressedDeque on the left hand side of operator ==
+         * @param rhs the CompressedDeque on the right hand side of operator ==
+         * @return true if they are equal false otherwise
+         */
+        friend bool operator == (const CompressedDeque& lhs, const CompressedDeque& rhs) {
+            return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());}
+
+        // ----------
+        // operator <
+        // ----------
+
+        /**
+         * @param lhs the CompressedDeque on the left hand side of operator <
+         * @param rhs the CompressedDeque on the right hand side of operator <
+         * @return true if lhs < rhs is true, false otherwise
+         */
+        friend bool operator < (const CompressedDeque& lhs, const CompressedDeque& rhs) {
+            return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());}
+
+    private:
+        typedef std::uint64_t Word;
+        typedef typename std::allocator_traits<A>::template rebind_alloc<Word>  word_allocator_type;
+        typedef typename std::allocator_traits<A>::template rebind_alloc<Word*> block_allocator_type;
+
+        /**
+         * a frozen block is header words followed by the packed words:
+         * the first item, the frame of reference, and the bit width plus a
+         * flag telling whether deltas or items were packed
+         */
+        static const size_type headerWords = 3;
+
+        // ----
+        // data
+        // ----
+
+        allocator_type a;                           //allocator of T's
+        mutable word_allocator_type word_a;         //allocator of frozen blocks
+        Deque<T, A> head, tail;                     //the uncompressed ends
+        Deque<Word*, block_allocator_type> frozen;  //the encoded blocks in between
+        size_type firstBlock;                       //id of frozen[0], ids never repeat while cached
+
+        //the decoded blocks, block id % cacheSize caches block id
+        mutable size_type cacheId[cacheSize];
+        mutable T cache[cacheSize][blockSize];
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        /*
+         * @return true if CompressedDeque is valid
+         */
+        bool valid () const {
+            return head.size() < 2 * blockSize && tail.size() < 2 * blockSize;}
+
+        // ------
+        // encode
+        // ------
+
+        typedef typename std::make_unsigned<T>::type U;
+
+        /**
+         * @return the number of bits needed for x
+         */
+        static unsigned width (Word x) {
+            unsigned w = 0;
+            while(x != 0)
+            {
+                w++;
+                x >>= 1;
+            }
+            return w;}
+
+        /**
+         * @return the number of packed words of a block with the given bit width
+         */
+        static size_type packed_words (unsigned w) {
+            return (blockSize * w + 63) / 64;}
+
+        /**
+         * @return blockSize items of d, from index lo on, as a new frozen block
+         */
+        Word* encode (const Deque<T, A>& d, size_type lo) const {
+            T items[blockSize];
+            for(size_type i = 0; i < blockSize; i++)
+                items[i] = d[lo + i];
+
+            //deltas and items as the signed values of T, compared as such
+            T minItem = items[0], maxItem = items[0], minDelta = 0, maxDelta = 0;
+            for(size_type i = 1; i < blockSize; i++)
+            {
+                T delta = (T)((U)items[i] - (U)items[i - 1]);
+                minItem  = std::min(minItem, items[i]);
+                maxItem  = std::max(maxItem, items[i]);
+                minDelta = (i == 1) ? delta : std::min(minDelta, delta);
+                maxDelta = (i == 1) ? delta : std::max(maxDelta, delta);
+            }
+            unsigned itemWidth  = width((Word)(U)((U)maxItem - (U)minItem));
+            unsigned deltaWidth = width((Word)(U)((U)maxDelta - (U)minDelta));
+            bool deltas = deltaWidth < itemWidth;
+            unsigned w  = deltas ? deltaWidth : itemWidth;
+            T base      = deltas ? minDelta : minItem;
+
+            Word* b = word_a.allocate(headerWords + packed_words(w));
+            b[0] = (Word)(U)items[0];
+            b[1] = (Word)(U)base;
+            b[2] = w | (deltas ? 0x100 : 0);
+            Word* words = b + headerWords;
+            std::fill(words, words + packed_words(w), (Word)0);
+            if(w == 0)
+                return b;
+            for(size_type i = 0; i < blockSize; i++)
+            {
+                U v = deltas ? (U)((U)items[i] - (U)items[i == 0 ? 0 : i - 1]) : (U)items[i];
+                Word x = (Word)(U)(v - (U)base);
+                if(deltas && i == 0)
+                    x = 0; //the first item is in the header
+                size_type pos = i * w, off = pos % 64;
+                words[pos / 64] |= x << off;
+                if(off + w > 64)
+                    words[pos / 64 + 1] |= x >> (64 - off);
+            }
+            return b;}
+
+        /**
+         * decodes the frozen block b into out
+         */
+        static void decode (const Word* b, T* out) {
+            unsigned w  = b[2] & 0xff;
+            bool deltas = (b[2] & 0x100) != 0;
+            U base      = (U)b[1];
+            const Word* words = b + headerWords;
+            Word mask = (w == 64) ? ~(Word)0 : (((Word)1 << w) - 1);
+
+            //unpack into a local buffer the compiler knows nothing else writes
+            U v[blockSize];
+            if(w == 0)
+                std::fill(v, v + blockSize, base);
+            else
+            {
+                Word cur = words[0];
+                unsigned off = 0;
+                for(size_type i = 0; i < blockSize; i++)
+                {
+                    Word x = cur >> off;
+                    off += w;
+                    if(off >= 64)
+                    {
+                        off -= 64;
+                        cur = (i + 1 < blockSize || off != 0) ? *++words : 0;
+                        if(off != 0)
+                            x |= cur << (w - off);
+                    }
+                    v[i] = (U)((U)(x & mask) + base);
+                }
+            }
+
+            if(deltas)
+            {
+                U prev = (U)b[0];
+                out[0] = (T)prev;
+                for(size_type i = 1; i < blockSize; i++)
+                    out[i] = (T)(prev = (U)(prev + v[i]));
+            }
+            else
+                for(size_type i = 0; i < blockSize; i++)
+                    out[i] = (T)v[i];}
+
+        /**
+         * frees the frozen block b
+         */
+        void release (Word* b) {
+            word_a.deallocate(b, headerWords + packed_words(b[2] & 0xff));}
+
+        /**
+         * @return item i of frozen block k: straight out of the packed words when the
+         * block packs items, out of its decoded copy when it packs deltas
+         */
+        value_type item (size_type k, size_type i) const {
+            const Word* b = frozen[k];
+            unsigned w    = b[2] & 0xff;
+            if((b[2] & 0x100) != 0)
+                return decoded(k)[i];
+            if(w == 0)
+                return (T)(U)b[1];
+            const Word* words = b + headerWords;
+            size_type pos = i * w, off = pos % 64;
+            Word x = words[pos / 64] >> off;
+            if(off + w > 64)
+                x |= words[pos / 64 + 1] << (64 - off);
+            if(w < 64)
+                x &= ((Word)1 << w) - 1;
+            return (T)(U)((U)x + (U)b[1]);}
+
+        /**
+         * @return the decoded items of frozen block k, decoding it if it isn't cached
+         */
+        const T* decoded (size_type k) const {
+            size_type id = firstBlock + k;
+            size_type c  = id % cacheSize;
+            if(cacheId[c] != id)
+            {
+                decode(frozen[k], cache[c]);
+                cacheId[c] = id;
+            }
+            return cache[c];}
+
+        /**
+         * forgets the decoded copy of frozen block k, if cached, before it is thawed
+         */
+        void uncache (size_type k) {
+            size_type id = firstBlock + k;
+            if(cacheId[id % cacheSize] == id)
+                cacheId[id % cacheSize] = (size_type)-1;}
+
+        // ------
+        // freeze
+        // ------
+
+        /**
+         * freezes the first block of tail once it holds two blocks
+         */
+        void freeze_back () {
+            if(tail.size() < 2 * blockSize)
+                return;
+            frozen.push_back(encode(tail, 0));
+            for(size_type i = 0; i < blockSize; i++)
+                tail.pop_front();}
+
+        /**
+         * freezes the last block of head once it holds two blocks
+         */
+        void freeze_front () {
+            if(head.size() < 2 * blockSize)
+                return;
+            frozen.push_front(encode(head, head.size() - blockSize));
+            firstBlock--;
+            for(size_type i = 0; i < blockSize; i++)
+                head.pop_back();}
+
+        /**
+         * thaws the last frozen block into the empty tail
+         */
+        void thaw_back () {
+            T items[blockSize];
+            uncache(frozen.size() - 1);
+            decode(frozen.back(), items);
+            release(frozen.back());
+            frozen.pop_back();
+            for(size_type i = 0; i < blockSize; i++)
+                tail.push_back(items[i]);}
+
+        /**
+         * thaws the first frozen block into the empty head
+         */
+        void thaw_front () {
+            T items[blockSize];
+            uncache(0);
+            decode(frozen.front(), items);
+            release(frozen.front());
+            frozen.pop_front();
+            firstBlock++;
+            for(size_type i = 0; i < blockSize; i++)
+                head.push_back(items[i]);}
+
+        /**
+         * helper for constructors
+         */
+        void init () {
+            firstBlock = (size_type)1 << (8 * sizeof(size_type) - 2); //room to count down
+            std::fill(cacheId, cacheId + cacheSize, (size_type)-1);}
+
+    public:
+        // --------------
+        // const_iterator
+        // --------------
+
+        class const_iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::bidirectional_iterator_tag           iterator_category;
+                typedef typename CompressedDeque::value_type      value_type;
+                typedef typename CompressedDeque::difference_type difference_type;
+                typedef const value_type*                         pointer;
+                typedef value_type                                reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                /**
+                 * @param lhs the iterator on the left hand side of operator ==
+                 * @param rhs the iterator on the right hand side of operator ==
+                 * @return true if lhs == rhs is true, false otherwise
+                 */
+                friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs.index == rhs.index && lhs.myDeque == rhs.myDeque;}
+
+                // ----------
+                // operator +
+                // ----------
+
+                /**
+                 * Increments the iterator by rhs
+                 * @param lhs the iterator on the left hand side of operator +
+                 * @param rhs the amount to increment by
+                 */
+                friend const_iterator operator + (const_iterator lhs, difference_type rhs) {
+                    return lhs += rhs;}
+
+                // ----------
+                // operator -
+                // ----------
+
+                /**
+                 * Decrements the iterator by rhs
+                 * @param lhs the iterator on the left hand side of operator -
+                 * @param rhs the amount to decrement by
+                 */
+                friend const_iterator operator - (const_iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;}
+
+            private:
+                // ----
+                // data
+                // ----
+
+                size_type index;                //index to the item in CompressedDeque we are pointing at
+                const CompressedDeque* myDeque; //the CompressedDeque which the iterator is reading
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                /**
+                 * @param myDeque the CompressedDeque to iterate over
+                 * @param index the index location in myDeque to point at initially
+                 */
+                const_iterator (const CompressedDeque& myDeque, size_type index) : index(index), myDeque(&myDeque) {}
+
+                // ----------
+                // operator *
+                // ----------
+
+                /**
+                 * @return the item which this iterator is currently pointing at
+                 */
+                reference operator * () const {
+                    return (*myDeque)[index];}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                /**
+                 * Increments the iterator one place
+                 * @return the iterator after being incremented
+                 */
+                const_iterator& operator ++ () {
+                    index++;
+                    return *this;}
+
+                /**
+                 * Increments the iterator one place
+                 * @return the iterator before being incremented
+                 */
+                const_iterator operator ++ (int) {
+                    const_iterator x = *this;
+                    ++(*this);
+                    return x;}
+
+                // -----------
+                // operator --
+                // -----------
+
+                /**
+                 * Decrements the iterator one place
+                 * @return the iterator after being decremented
+                 */
+                const_iterator& operator -- () {
+                    index--;
+                    return *this;}
+
+                /**
+                 * Decrements the iterator one place
+                 * @return the iterator before being decremented
+                 */
+                const_iterator operator -- (int) {
+                    const_iterator x = *this;
+                    --(*this);
+                    return x;}
+
+                // -----------
+                // operator +=
+                // -----------
+
+                /**
+                 * Increments the iterator by d
+                 * @param d the amount to increment by
+                 * @return the iterator after being incremented
+                 */
+                const_iterator& operator += (difference_type d) {
+                    index += d;
+                    return *this;}
+
+                // -----------
+                // operator -=
+                // -----------
+
+                /**
+                 * Decrements the iterator by d
+                 * @param d the amount to decrement by
+                 * @return the iterator after being decremented
+                 */
+                const_iterator& operator -= (difference_type d) {
+                    index -= d;
+                    return *this;}};
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Constructs empty CompressedDeque
+         * @param a allocator to use
+         */
+        explicit CompressedDeque (const allocator_type& a = allocator_type()) :
+                a(a), word_a(a), head(a), tail(a), frozen(block_allocator_type(a)) {
+            init();
+            assert(valid());}
+
+        /**
+         * Copy constructor
+         * @param that CompressedDeque to copy
+         */
+        CompressedDeque (const CompressedDeque& that) :
+                a(that.a), word_a(that.word_a), head(that.a), tail(that.a), frozen(block_allocator_type(that.a)) {
+            init();
+            for(size_type i = 0; i < that.size(); i++)
+                push_back(that[i]);
+            assert(valid());}
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * Frees the frozen blocks
+         */
+        ~CompressedDeque () {
+            for(size_type k = 0; k < frozen.size(); k++)
+                release(frozen[k]);}
+
+        // ----------
+        // operator =
+        // ----------
+
+        /**
+         * assign rhs to this
+         * @param rhs CompressedDeque whose items we'll copy
+         */
+        CompressedDeque& operator = (const CompressedDeque& rhs) {
+            CompressedDeque that(rhs);
+            swap(that);
+            return *this;}
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+         * @return the item at index, decoding its block if it is frozen and not cached
+         * @pre index w/in range [0, size())
+         */
+        value_type operator [] (size_type index) const {
+            if(index < head.size())
+                return head[index];
+            index -= head.size();
+            if(index < frozen.size() * blockSize)
+                return item(index / blockSize, index % blockSize);
+            return tail[index - frozen.size() * blockSize];}
+
+        // --
+        // at
+        // --
+
+        /**
+         * @return the item at index
+         * @throws out_of_range exception if index not in [0, size())
+         */
+        value_type at (size_type index) const {
+            if(index >= size())
+                throw std::out_of_range("CompressedDeque::at()");
+            return (*this)[index];}
+
+        // ----
+        // back
+        // ----
+
+        /**
+         * @pre not empty
+         * @return the last item
+         */
+        value_type back () const {
+            return (*this)[size() - 1];}
+
+        // -----
+        // begin
+        // -----
+
+        /**
+         * @return const_iterator pointing to start of deque
+         */
+        const_iterator begin () const {
+            return const_iterator(*this, 0);}
+
+        // -----
+        // bytes
+        // -----
+
+        /**
+         * @return the bytes taken by the frozen blocks, the map of them and the two
+         * uncompressed ends' items (not their spare slots, the cache or allocator overhead)
+         */
+        size_type bytes () const {
+            size_type n = frozen.size() * sizeof(Word*) + (head.size() + tail.size()) * sizeof(T);
+            for(size_type k = 0; k < frozen.size(); k++)
+                n += (headerWords + packed_words(frozen[k][2] & 0xff)) * sizeof(Word);
+            return n;}
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * destroys every item, leaving size = 0
+         */
+        void clear () {
+            CompressedDeque that(a);
+            swap(that);}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return size == 0
+         */
+        bool empty () const {
+            return !size();}
+
+        // ---
+        // end
+        // ---
+
+        /**
+         * @return const_iterator pointing to one past the last item
+         */
+        const_iterator end () const {
+            return const_iterator(*this, size());}
+
+        // -------------
+        // for_each_span
+        // -------------
+
+        /**
+         * Calls f(p, n) on consecutive runs of the items, front to back, each run
+         * n items decoded into a buffer at p; faster than iterating for a scan
+         * @param f called with a const value_type* and a size_type
+         */
+        template <typename F>
+        void for_each_span (F f) const {
+            T items[2 * blockSize];
+            for(size_type i = 0; i < head.size(); i++)
+                items[i] = head[i];
+            if(!head.empty())
+                f(static_cast<const T*>(items), head.size());
+            for(size_type k = 0; k < frozen.size(); k++)
+            {
+                decode(frozen[k], items);
+                f(static_cast<const T*>(items), blockSize);
+            }
+            for(size_type i = 0; i < tail.size(); i++)
+                items[i] = tail[i];
+            if(!tail.empty())
+                f(static_cast<const T*>(items), tail.size());}
+
+        // -----
+        // front
+        // -----
+
+        /**
+         * @pre not empty
+         * @return the first item
+         */
+        value_type front () const {
+            return (*this)[0];}
+
+        // ---
+        // pop
+        // ---
+
+        /**
+         * Deletes the item at the back of the container
+         * @pre container not empty
+         */
+        void pop_back () {
+            if(tail.empty())
+            {
+                if(frozen.empty())
+                {
+                    head.pop_back();
+                    return;
+                }
+                thaw_back();
+            }
+            tail.pop_back();
+            assert(valid());}
+
+        /**
+         * Deletes the item at the front of the container.
+         * @pre container not empty
+         */
+        void pop_front () {
+            if(head.empty())
+            {
+                if(frozen.empty())
+                {
+                    tail.pop_front();
+                    return;
+                }
+                thaw_front();
+            }
+            head.pop_front();
+            assert(valid());}
+
+        // ----
+        // push
+        // ----
+
+        /**
+         * adds an item to back of container
+         * @param item object to be added
+         */
+        void push_back (const value_type& item) {
+            tail.push_back(item);
+            freeze_back();
+            assert(valid());}
+
+        /**
+         * adds item to the front of the container
+         * @param item object to push to front.
+         */
+        void push_front (const value_type& item) {
+            head.push_front(item);
+            freeze_front();
+            assert(valid());}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return the number of elements in the deque
+         */
+        size_type size () const {
+            return head.size() + frozen.size() * blockSize + tail.size();}
+
+        // ----
+        // swap
+        // ----
+
+        /**
+         * @param that CompressedDeque to swap underlying data with
+         */
+        void swap (CompressedDeque& that) {
+            head.swap(that.head);
+            tail.swap(that.tail);
+            frozen.swap(that.frozen);
+            std::swap(firstBlock, that.firstBlock);
+            for(size_type c = 0; c < cacheSize; c++)
+            {
+                std::swap(cacheId[c], that.cacheId[c]);
+                std::swap_ranges(cache[c], cache[c] + blockSize, that.cache[c]);
+            }
+            std::swap(a, that.a); //the frozen blocks go back to the allocator they came from
+            std::swap(word_a, that.word_a);
+            assert(valid());}};
+
+#endif // CompressedDeque_h
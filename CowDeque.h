@@ -0,0 +1,811 @@
+// -------------------------
+// projects/deque/CowDeque.h
+// Copyright (C) 2010
+// Glenn P. Downing
+// -------------------------
+
+#ifndef CowDeque_h
+#define CowDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // equal, lexicographical_compare, min, swap
+#include <atomic>    // atomic, memory_order
+#include <cassert>   // assert
+#include <iterator>  // bidirectional_iterator_tag
+#include <memory>    // allocator, allocator_traits
+#include <new>       // placement new
+#include <stdexcept> // out_of_range
+#include <type_traits> // aligned_storage
+#include <utility>   // !=, <=, >, >=
+
+// -----
+// using
+// -----
+
+using std::rel_ops::operator!=;
+using std::rel_ops::operator<=;
+using std::rel_ops::operator>;
+using std::rel_ops::operator>=;
+
+// --------
+// CowDeque
+// --------
+
+/**
+ * A Deque whose copies share storage. The map (rows of 10-item blocks, laid out
+ * and wrapped around exactly like Deque's) and every block carry a reference
+ * count, so a copy or snapshot() costs O(1). The first mutation of a shared
+ * version copies the map (O(blocks)) and every mutation copies only the block
+ * it touches. A version is never changed through another one, so any number of
+ * threads can read their own copies without locks while a writer keeps
+ * mutating its own.
+ *
+ * Each version keeps its own cursors; popping only moves them, the items are
+ * destroyed once no version can see them any more.
+ */
+template < typename T, typename A = std::allocator<T> >
+class CowDeque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef A                                        allocator_type;
+        typedef typename allocator_type::value_type      value_type;
+
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::difference_type difference_type;
+
+        typedef T*                                       pointer;
+        typedef const T*                                 const_pointer;
+
+        typedef T&                                       reference;
+        typedef const T&                                 const_reference;
+
+    public:
+        // -----------
+        // operator ==
+        // -----------
+
+        /**
+         * @param lhs the CowDeque on the left hand side of operator ==
+         * @param rhs the CowDeque on the right hand side of operator ==
+         * @return true if they are equal false otherwise
+         */
+        friend bool operator == (const CowDeque& lhs, const CowDeque& rhs) {
+            return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());}
+
+        // ----------
+        // operator <
+        // ----------
+
+        /**
+         * @param lhs the CowDeque on the left hand side of operator <
+         * @param rhs the CowDeque on the right hand side of operator <
+         * @return true if lhs < rhs is true, false otherwise
+         */
+        friend bool operator < (const CowDeque& lhs, const CowDeque& rhs) {
+            return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());}
+
+    private:
+        // -----
+        // Block
+        // -----
+
+        /**
+         * a row of 10 slots; slots [lo, hi) hold constructed items
+         */
+        struct Block {
+            std::atomic<size_type> refs;
+            size_type lo, hi;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type items[10];
+
+            pointer at (size_type col) {
+                return reinterpret_cast<pointer>(&items[col]);}};
+
+        // ---
+        // Map
+        // ---
+
+        /**
+         * the outer container, holds one reference to each of its non NULL rows
+         */
+        struct Map {
+            std::atomic<size_type> refs;
+            size_type numRows;
+            Block** rows;};
+
+        typedef typename std::allocator_traits<A>::template rebind_alloc<Block>  block_allocator_type;
+        typedef typename std::allocator_traits<A>::template rebind_alloc<Map>    map_allocator_type;
+        typedef typename std::allocator_traits<A>::template rebind_alloc<Block*> row_allocator_type;
+
+        // ----
+        // data
+        // ----
+
+        allocator_type a;               //allocator of T's
+        block_allocator_type block_a;   //allocator of blocks
+        map_allocator_type map_a;       //allocator of maps
+        row_allocator_type row_a;       //allocator of the row pointers of a map
+        Map* map;                       //shared outer container
+        //end is EXCLUSIVE, same cursors as Deque but private to this version
+        size_type beginRow, endRow, beginCol, endCol;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        /*
+         * @return true if CowDeque is valid
+         */
+        bool valid () const {
+            if(map == 0 || map->refs.load(std::memory_order_relaxed) == 0)
+                return false;
+            if(beginRow >= map->numRows || endRow >= map->numRows || beginCol >= 10 || endCol >= 10)
+                return false;
+            if(beginRow == endRow && beginCol > endCol)
+                return false;
+            return true;}
+
+    public:
+        // --------------
+        // const_iterator
+        // --------------
+
+        class const_iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::bidirectional_iterator_tag    iterator_category;
+                typedef typename CowDeque::value_type      value_type;
+                typedef typename CowDeque::difference_type difference_type;
+                typedef typename CowDeque::const_pointer   pointer;
+                typedef typename CowDeque::const_reference reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                /**
+                 * @param lhs the iterator on the left hand side of operator ==
+                 * @param rhs the iterator on the right hand side of operator ==
+                 * @return true if lhs == rhs is true, false otherwise
+                 */
+                friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs.index == rhs.index && lhs.myDeque == rhs.myDeque;}
+
+                // ----------
+                // operator +
+                // ----------
+
+                /**
+                 * Increments the iterator by rhs
+                 * @param lhs the iterator on the left hand side of operator +
+                 * @param rhs the amount to increment by
+                 */
+                friend const_iterator operator + (const_iterator lhs, difference_type rhs) {
+                    return lhs += rhs;}
+
+                // ----------
+                // operator -
+                // ----------
+
+                /**
+                 * Decrements the iterator by rhs
+                 * @param lhs the iterator on the left hand side of operator -
+                 * @param rhs the amount to decrement by
+                 */
+                friend const_iterator operator - (const_iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;}
+
+            private:
+                // ----
+                // data
+                // ----
+
+                size_type index;            //index to the item in CowDeque we are pointing at
+                const CowDeque* myDeque;    //the version which the iterator is reading
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                /**
+                 * @param myDeque the CowDeque to iterate over
+                 * @param index the index location in myDeque to point at initially
+                 */
+                const_iterator (const CowDeque& myDeque, size_type index) : index(index), myDeque(&myDeque) {}
+
+                // ----------
+                // operator *
+                // ----------
+
+                /**
+                 * @return the element which this iterator is currently pointing at
+                 */
+                reference operator * () const {
+                    return (*myDeque)[index];}
+
+                // -----------
+                // operator ->
+                // -----------
+
+                /**
+                 * @return dereferenced element with access to members
+                 */
+                pointer operator -> () const {
+                    return &**this;}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                /**
+                 * Increments the iterator one place
+                 * @return the iterator after being incremented
+                 */
+                const_iterator& operator ++ () {
+                    index++;
+                    return *this;}
+
+                /**
+                 * Increments the iterator one place
+                 * @return the iterator before being incremented
+                 */
+                const_iterator operator ++ (int) {
+                    const_iterator x = *this;
+                    ++(*this);
+                    return x;}
+
+                // -----------
+                // operator --
+                // -----------
+
+                /**
+                 * Decrements the iterator one place
+                 * @return the iterator after being decremented
+                 */
+                const_iterator& operator -- () {
+                    index--;
+                    return *this;}
+
+                /**
+                 * Decrements the iterator one place
+                 * @return the iterator before being decremented
+                 */
+                const_iterator operator -- (int) {
+                    const_iterator x = *this;
+                    --(*this);
+                    return x;}
+
+                // -----------
+                // operator +=
+                // -----------
+
+                /**
+                 * Increments the iterator by d
+                 * @param d the amount to increment by
+                 * @return the iterator after being incremented
+                 */
+                const_iterator& operator += (difference_type d) {
+                    index += d;
+                    return *this;}
+
+                // -----------
+                // operator -=
+                // -----------
+
+                /**
+                 * Decrements the iterator by d
+                 * @param d the amount to decrement by
+                 * @return the iterator after being decremented
+                 */
+                const_iterator& operator -= (difference_type d) {
+                    index -= d;
+                    return *this;}};
+
+    private:
+        // -------
+        // sharing
+        // -------
+
+        /**
+         * @return a new map of numRows NULL rows, referenced once
+         */
+        Map* make_map (size_type numRows) {
+            Map* m = map_a.allocate(1);
+            m->refs.store(1, std::memory_order_relaxed);
+            m->numRows = numRows;
+            m->rows = row_a.allocate(numRows);
+            std::fill(m->rows, m->rows + numRows, (Block*)0);
+            return m;}
+
+        /**
+         * @return a new empty block, referenced once
+         */
+        Block* make_block () {
+            Block* b = block_a.allocate(1);
+            ::new (static_cast<void*>(b)) Block;
+            b->refs.store(1, std::memory_order_relaxed);
+            b->lo = b->hi = 0;
+            return b;}
+
+        /**
+         * drops a reference to b, destroying its items and freeing it if it was the last one
+         */
+        void release (Block* b) {
+            if(b->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+            for(size_type col = b->lo; col < b->hi; col++)
+                std::allocator_traits<A>::destroy(a, b->at(col));
+            b->~Block();
+            block_a.deallocate(b, 1);}
+
+        /**
+         * drops a reference to m, releasing its rows and freeing it if it was the last one
+         */
+        void release (Map* m) {
+            if(m->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+            for(size_type i = 0; i < m->numRows; i++)
+                if(m->rows[i] != 0)
+                    release(m->rows[i]);
+            row_a.deallocate(m->rows, m->numRows);
+            map_a.deallocate(m, 1);}
+
+        /**
+         * @return true if no other version references p
+         */
+        template <typename P>
+        static bool unique (const P* p) {
+            return p->refs.load(std::memory_order_acquire) == 1;}
+
+        /**
+         * sets [lo, hi) to the columns of row that this version can see
+         */
+        void visible (size_type row, size_type& lo, size_type& hi) const {
+            size_type numRows = map->numRows;
+            size_type r    = (row    + numRows - beginRow) % numRows;
+            size_type last = (endRow + numRows - beginRow) % numRows;
+            lo = hi = 0;
+            if(r > last)
+                return;
+            lo = (r == 0)    ? beginCol : 0;
+            hi = (r == last) ? endCol   : 10;
+            if(lo >= hi)
+                lo = hi = 0;}
+
+        /**
+         * Makes this version the only owner of its map, with at least numRows rows.
+         * A shared map is copied, adding a reference to each of its blocks; growing
+         * recenters the rows like Deque::double_capacity does.
+         */
+        void own_map (size_type numRows) {
+            size_type oldNumRows = map->numRows;
+            if(numRows == oldNumRows && unique(map))
+                return;
+
+            Map* m = make_map(numRows);
+            size_type newBeginRow = numRows/2 - oldNumRows/2;
+            bool shared = !unique(map);
+            for(size_type i = 0; i < oldNumRows; i++)
+            {
+                Block*& b = map->rows[(beginRow + i) % oldNumRows];
+                m->rows[newBeginRow + i] = b;
+                if(b == 0)
+                    continue;
+                if(shared)
+                    b->refs.fetch_add(1, std::memory_order_relaxed);
+                else
+                    b = 0; //handed over to m
+            }
+
+            endRow   = newBeginRow + (endRow + oldNumRows - beginRow) % oldNumRows;
+            beginRow = newBeginRow;
+            release(map);
+            map = m;}
+
+        /**
+         * Makes this version the only owner of the block in row, which is allocated if
+         * it is NULL and copied if it is shared. Items this version can't see are destroyed.
+         * @pre this version owns its map
+         * @return the block
+         */
+        Block* own_block (size_type row) {
+            Block*& b = map->rows[row];
+            if(b == 0)
+            {
+                b = make_block();
+                return b;
+            }
+
+            size_type lo, hi;
+            visible(row, lo, hi);
+            if(!unique(b))
+            {
+                Block* c = make_block();
+                size_type col = lo;
+                try
+                {
+                    for(; col < hi; col++)
+                        std::allocator_traits<A>::construct(a, c->at(col), *b->at(col));
+                }
+                catch(...)
+                {
+                    c->lo = lo;
+                    c->hi = col;
+                    release(c);
+                    throw;
+                }
+                c->lo = lo;
+                c->hi = hi;
+                release(b);
+                b = c;
+                return b;
+            }
+
+            trim(b, lo, hi);
+            return b;}
+
+        /**
+         * destroys the items of b outside of [lo, hi)
+         */
+        void trim (Block* b, size_type lo, size_type hi) {
+            if(lo == hi)
+                lo = hi = b->hi;
+            for(size_type col = b->lo; col < std::min(lo, b->hi); col++)
+                std::allocator_traits<A>::destroy(a, b->at(col));
+            for(size_type col = std::max(hi, b->lo); col < b->hi; col++)
+                std::allocator_traits<A>::destroy(a, b->at(col));
+            b->lo = std::max(b->lo, lo);
+            b->hi = std::min(b->hi, hi);
+            if(b->lo >= b->hi)
+                b->lo = b->hi = 0;}
+
+        /**
+         * after a pop, destroys the items of row that this version can't see anymore,
+         * if nobody else can see them either
+         */
+        void trim (size_type row) {
+            Block* b = map->rows[row];
+            if(!unique(map) || !unique(b))
+                return;
+            size_type lo, hi;
+            visible(row, lo, hi);
+            trim(b, lo, hi);}
+
+        /**
+         * helper for constructors
+         */
+        void init () {
+            map = make_map(10);
+            beginRow = endRow = 5;
+            beginCol = endCol = 5;}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Constructs empty CowDeque
+         * @param a allocator to use
+         */
+        explicit CowDeque (const allocator_type& a = allocator_type()) : a(a), block_a(a), map_a(a), row_a(a) {
+            init();
+            assert(valid());}
+
+        /**
+         * Constructs CowDeque of size s with initial values v using allocator a
+         * @param s size of deque
+         * @param v intial value to use
+         * @param a allocator to use, defaulted to allocator_type()
+         */
+        explicit CowDeque (size_type s, const_reference v = value_type(), const allocator_type& a = allocator_type()) :
+                a(a), block_a(a), map_a(a), row_a(a) {
+            init();
+            while(size() != s)
+                push_back(v);
+            assert(valid());}
+
+        /**
+         * Copy constructor, shares that's storage in O(1)
+         * @param that CowDeque to copy
+         */
+        CowDeque (const CowDeque& that) :
+                a(that.a), block_a(that.block_a), map_a(that.map_a), row_a(that.row_a), map(that.map),
+                beginRow(that.beginRow), endRow(that.endRow), beginCol(that.beginCol), endCol(that.endCol) {
+            map->refs.fetch_add(1, std::memory_order_relaxed);
+            assert(valid());}
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * Drops this version's reference to the storage
+         */
+        ~CowDeque () {
+            release(map);}
+
+        // ----------
+        // operator =
+        // ----------
+
+        /**
+         * shares rhs's storage
+         * @param rhs CowDeque to share
+         */
+        CowDeque& operator = (const CowDeque& rhs) {
+            CowDeque that(rhs);
+            swap(that);
+            return *this;}
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+         * Copies the block holding the item first if it is shared.
+         * @return reference to the item at index
+         * @pre index w/in range [0, size())
+         */
+        reference operator [] (size_type index) {
+            own_map(map->numRows);
+            size_type col = (beginCol + index)%10;
+            size_type row = (beginRow + ((beginCol+index)/10)) % map->numRows;
+            return *own_block(row)->at(col);}
+
+        /**
+         * @return const reference to the item at index, never copies anything
+         * @pre index w/in range [0, size())
+         */
+        const_reference operator [] (size_type index) const {
+            size_type col = (beginCol + index)%10;
+            size_type row = (beginRow + ((beginCol+index)/10)) % map->numRows;
+            return *map->rows[row]->at(col);}
+
+        // --
+        // at
+        // --
+
+        /**
+         * @return reference to the item at index
+         * @throws out_of_range exception if index not in [0, size())
+         */
+        reference at (size_type index) {
+            if(index >= size())
+                throw std::out_of_range("CowDeque::at()");
+            return (*this)[index];}
+
+        /**
+         * @return const reference to the item at index
+         * @throws out_of_range exception if index not in [0, size())
+         */
+        const_reference at (size_type index) const {
+            if(index >= size())
+                throw std::out_of_range("CowDeque::at()");
+            return (*this)[index];}
+
+        // ----
+        // back
+        // ----
+
+        /**
+         * @pre not empty
+         * @return reference to last item in deque
+         */
+        reference back () {
+            return (*this)[size() - 1];}
+
+        /**
+         * @pre not empty
+         * @return const reference to last item in deque
+         */
+        const_reference back () const {
+            return (*this)[size() - 1];}
+
+        // -----
+        // begin
+        // -----
+
+        /**
+         * @return const_iterator pointing to start of deque
+         */
+        const_iterator begin () const {
+            return const_iterator(*this, 0);}
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * drops this version's items, leaving size = 0
+         */
+        void clear () {
+            CowDeque that(a);
+            swap(that);}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return size == 0
+         */
+        bool empty () const {
+            return !size();}
+
+        // ---
+        // end
+        // ---
+
+        /**
+         * @return const_iterator pointing to one past the last item
+         */
+        const_iterator end () const {
+            return const_iterator(*this, size());}
+
+        // -----
+        // front
+        // -----
+
+        /**
+         * @return reference to item at front of deque
+         * @pre not empty
+         */
+        reference front () {
+            return (*this)[0];}
+
+        /**
+         * @return const reference to item at front of deque
+         * @pre not empty
+         */
+        const_reference front () const {
+            return (*this)[0];}
+
+        // ---
+        // pop
+        // ---
+
+        /**
+         * Deletes the item at the back of the container
+         * @pre container not empty
+         */
+        void pop_back () {
+            if(endCol == 0)
+                endRow = (endRow == 0) ? map->numRows - 1 : endRow - 1;
+            endCol = (endCol == 0) ? 9 : endCol - 1;
+
+            trim(endRow);
+            assert(valid());}
+
+        /**
+         * Deletes the item at the front of the container.
+         * @pre container not empty
+         */
+        void pop_front () {
+            size_type row = beginRow;
+
+            beginCol = (beginCol + 1) % 10;
+            if(beginCol == 0)
+                beginRow = (beginRow + 1) % map->numRows;
+
+            trim(row);
+            assert(valid());}
+
+        // ----
+        // push
+        // ----
+
+        /**
+         * adds an item to back of container
+         * @param item object to be added
+         */
+        void push_back (const_reference item) {
+            own_map(map->numRows);
+
+            Block* b = own_block(endRow);
+            std::allocator_traits<A>::construct(a, b->at(endCol), item);
+            if(b->lo == b->hi)
+                b->lo = endCol;
+            b->hi = endCol + 1;
+
+            endCol = (endCol + 1) % 10;
+            if(endCol == 0)
+            {
+                if((endRow + 1) % map->numRows == beginRow)
+                    own_map(map->numRows * 2);
+                endRow = (endRow + 1) % map->numRows;
+            }
+            assert(valid());}
+
+        /**
+         * adds item to the front of the container
+         * @param item object to push to front.
+         */
+        void push_front (const_reference item) {
+            own_map(map->numRows);
+
+            size_type row = beginRow;
+            size_type col = beginCol;
+            if(col == 0)
+            {
+                row = (beginRow == 0) ? map->numRows - 1 : beginRow - 1;
+                if(row == endRow)
+                {
+                    own_map(map->numRows * 2);
+                    row = beginRow - 1;
+                }
+                col = 10;
+            }
+            col--;
+
+            Block* b = own_block(row);
+            std::allocator_traits<A>::construct(a, b->at(col), item);
+            if(b->lo == b->hi)
+                b->hi = col + 1;
+            b->lo = col;
+
+            beginRow = row;
+            beginCol = col;
+            assert(valid());}
+
+        // ------
+        // shared
+        // ------
+
+        /**
+         * @return true if another version still shares this one's map
+         */
+        bool shared () const {
+            return !unique(map);}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return the number of elements in the deque
+         */
+        size_type size () const {
+            return ((endRow + map->numRows - beginRow) % map->numRows) * 10 + endCol - beginCol;}
+
+        // --------
+        // snapshot
+        // --------
+
+        /**
+         * @return an immutable version sharing this one's storage, in O(1)
+         */
+        CowDeque snapshot () const {
+            return *this;}
+
+        // ----
+        // swap
+        // ----
+
+        /**
+         * @param that CowDeque to swap underlying data with
+         */
+        void swap (CowDeque& that) {
+            std::swap(map, that.map);
+            std::swap(beginRow, that.beginRow);
+            std::swap(endRow, that.endRow);
+            std::swap(beginCol, that.beginCol);
+            std::swap(endCol, that.endCol);
+            std::swap(a, that.a); //the map and blocks go back to the allocators they came from
+            std::swap(block_a, that.block_a);
+            std::swap(map_a, that.map_a);
+            std::swap(row_a, that.row_a);
+            assert(valid());}};
+
+#endif // CowDeque_h
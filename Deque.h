@@ -13,10 +13,17 @@
 
 #include <algorithm> // equal, lexicographical_compare
 #include <cassert>   // assert
-#include <iterator>  // iterator, bidirectional_iterator_tag
-#include <memory>    // allocator
+#include <cstring>   // memmove
+#include <cstdint>   // uintptr_t
+#include <iostream>  // cout, endl
+#include <iterator>  // bidirectional_iterator_tag, iterator, reverse_iterator
+#include <memory>    // allocator, shared_ptr, unique_ptr
 #include <stdexcept> // out_of_range
-#include <utility>   // !=, <=, >, >=
+#include <type_traits> // integral_constant, is_trivially_copyable, is_trivially_destructible, true_type, false_type
+#include <utility>   // !=, <=, >, >=, move
+#include <vector>    // vector
+
+#include "AlignedAllocator.h" // deque_allocator
 
 // -----
 // using
@@ -37,7 +44,7 @@ template <typename A, typename BI>
 BI destroy (A& a, BI b, BI e) {
     while (b != e) {
         --e;
-        a.destroy(&*e);}
+        std::allocator_traits<A>::destroy(a, &*e);}
     return b;}
 
 // ------------------
@@ -49,7 +56,7 @@ BI uninitialized_copy (A& a, II b, II e, BI x) {
     BI p = x;
     try {
         while (b != e) {
-            a.construct(&*x, *b);
+            std::allocator_traits<A>::construct(a, &*x, *b);
             ++b;
             ++x;}}
     catch (...) {
@@ -66,18 +73,34 @@ BI uninitialized_fill (A& a, BI b, BI e, const U& v) {
     BI p = b;
     try {
         while (b != e) {
-            a.construct(&*b, v);
+            std::allocator_traits<A>::construct(a, &*b, v);
             ++b;}}
     catch (...) {
         my_destroy(a, p, b);
         throw;}
     return e;}
 
+// ------------------------
+// is_trivially_relocatable
+// ------------------------
+
+/**
+ * true if moving a T to new storage and abandoning the old storage is the same
+ * as a memmove of its bytes (no constructor or destructor has to run).
+ * Defaults to the trivially copyable types; specialize it to opt in other types,
+ * e.g. records that hold a unique_ptr.
+ */
+template <typename T>
+struct is_trivially_relocatable : std::integral_constant<bool, std::is_trivially_copyable<T>::value> {};
+
+template <typename T>
+struct is_trivially_relocatable< std::unique_ptr<T> > : std::true_type {};
+
 // -----
 // Deque
 // -----
 
-template < typename T, typename A = std::allocator<T> >
+template < typename T, typename A = typename deque_allocator<T>::type >
 class Deque {
     public:
         // --------
@@ -90,11 +113,11 @@ class Deque {
         typedef typename allocator_type::size_type       size_type;
         typedef typename allocator_type::difference_type difference_type;
 
-        typedef typename allocator_type::pointer         pointer;
-        typedef typename allocator_type::const_pointer   const_pointer;
+        typedef typename std::allocator_traits<A>::pointer       pointer;
+        typedef typename std::allocator_traits<A>::const_pointer const_pointer;
 
-        typedef typename allocator_type::reference       reference;
-        typedef typename allocator_type::const_reference const_reference;
+        typedef value_type&                              reference;
+        typedef const value_type&                        const_reference;
 
     public:
         // -----------
@@ -133,11 +156,18 @@ class Deque {
         // data
         // ----
 
-        typename allocator_type::template rebind<T*>::other outer_a;    //allocator of pointers for type T
+        typedef std::allocator_traits<A> alloc_traits;
+
+        typename alloc_traits::template rebind_alloc<T*> outer_a;    //allocator of pointers for type T
         allocator_type a;                        //alocator of T's
         T** container;                            //our outer container (rows)
         //ends are EXCLUSIVE
         unsigned long beginRow, endRow, beginCol, endCol, numRows;
+        //incremental growth: the twice as big map being filled in a few rows per push,
+        //old row nextGap becomes its row 0 and rows [0, migrated) of it are filled in
+        T** nextContainer;
+        unsigned long nextGap, migrated;
+        bool incremental;
 
 
     private:
@@ -213,7 +243,7 @@ class Deque {
              * @return true if lhs == rhs is true, false otherwise
              */
                 friend bool operator == (const iterator& lhs, const iterator& rhs) {
-                    return lhs.index == rhs.index && (&(lhs.myDeque) == &(rhs.myDeque));
+                    return lhs.index == rhs.index && lhs.myDeque == rhs.myDeque;
                 }
                 // ----------
                 // operator +
@@ -245,7 +275,9 @@ class Deque {
                 // ----
 
                 size_type index;    //index to the item in Deque we are pointing at
-                Deque& myDeque;        //reference to the pointer which the iterator is operating on
+                Deque* myDeque;        //pointer to the Deque which the iterator is operating on
+
+                friend class Deque;
 
             private:
                 // -----
@@ -268,7 +300,7 @@ class Deque {
              * @param myDeque the Deque to iterator over and point to
              * @param index the index location in myDeque to point at initially
              */
-                iterator (Deque& myDeque, size_type index) : index(index), myDeque(myDeque)
+                iterator (Deque& myDeque, size_type index) : index(index), myDeque(&myDeque)
                 {
                     assert(valid());
                 }
@@ -287,7 +319,7 @@ class Deque {
                  * @return the element which this iterator is currently pointing at
                  */
                 reference operator * () const {
-                    return myDeque[index];
+                    return (*myDeque)[index];
                 }
 
                 // -----------
@@ -403,7 +435,7 @@ class Deque {
              * @return true if lhs == rhs is true, false otherwise
              */
                 friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
-                    return lhs.index == rhs.index && (&(lhs.myDeque) == &(rhs.myDeque));}
+                    return lhs.index == rhs.index && lhs.myDeque == rhs.myDeque;}
 
                 // ----------
                 // operator +
@@ -435,7 +467,7 @@ class Deque {
                 // ----
 
                 size_type index;    //index to the item in Deque we are pointing at
-                const Deque& myDeque;    //constant reference to the pointer which the iterator is operating on
+                const Deque* myDeque;    //pointer to the constant Deque which the iterator is operating on
 
             private:
                 // -----
@@ -457,7 +489,7 @@ class Deque {
                  * @param myDeque the Deque to iterator over and point to
                  * @param index the index location in myDeque to point at initially
                  */
-                const_iterator (const Deque& myDeque, size_type index) : index(index), myDeque(myDeque) {
+                const_iterator (const Deque& myDeque, size_type index) : index(index), myDeque(&myDeque) {
                     assert(valid());}
 
                 // Default copy, destructor, and copy assignment.
@@ -474,7 +506,7 @@ class Deque {
                  * @return the element which this iterator is currently pointing at
                  */
                 reference operator * () const {
-                    return myDeque[index];}
+                    return (*myDeque)[index];}
 
                 // -----------
                 // operator ->
@@ -561,6 +593,14 @@ class Deque {
                     assert(valid());
                     return *this;}};
 
+    public:
+        // -----------------
+        // reverse_iterators
+        // -----------------
+
+        typedef std::reverse_iterator<iterator>       reverse_iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
 
         // ------------
         // constructors
@@ -580,6 +620,10 @@ class Deque {
             container[numRows/2] = this->a.allocate(10);
             beginRow = endRow = numRows/2;
             beginCol = endCol = 5;
+
+            nextContainer = (T**)NULL;
+            nextGap = migrated = 0;
+            incremental = false;
             
             assert(valid());
         }
@@ -589,7 +633,7 @@ class Deque {
          * Constructs empty Deque
          * @param a allocator to use
          */
-        explicit Deque (const allocator_type& a = allocator_type()) : a(a)
+        explicit Deque (const allocator_type& a = allocator_type()) : outer_a(a), a(a)
         {
             init();
         }
@@ -600,7 +644,7 @@ class Deque {
          * @param v intial value to use
          * @param a allocator to use, defaulted to allocator_type()
          */
-        explicit Deque (size_type s, const_reference v = value_type(), const allocator_type& a = allocator_type()) : a(a)   
+        explicit Deque (size_type s, const_reference v = value_type(), const allocator_type& a = allocator_type()) : outer_a(a), a(a)
         {
             init();
             resize(s, v);
@@ -608,13 +652,14 @@ class Deque {
         }
 
         /**
-         * Copy constructor
+         * Copy constructor, with that's allocator
          * @param that Deque to copy
          */
-        Deque (const Deque& that) {
+        Deque (const Deque& that) : outer_a(that.a), a(that.a) {
             assert(that.valid());
             
             init();
+            incremental = that.incremental;
 
             size_type i=0;
             while(i<that.size())           
@@ -622,6 +667,14 @@ class Deque {
             
             assert(valid());}
 
+        /**
+         * Move constructor, takes that's map and blocks in O(1) and leaves it empty
+         * @param that Deque to move from
+         */
+        Deque (Deque&& that) : outer_a(that.a), a(that.a) {
+            init();
+            swap(that);}
+
         // ----------
         // destructor
         // ----------
@@ -633,7 +686,7 @@ class Deque {
             iterator it = this->begin();
             while(it != this->end())
             {
-                a.destroy(&(*it));
+                alloc_traits::destroy(a, &(*it));
                 it++;
             }
             
@@ -648,6 +701,8 @@ class Deque {
             }
             
             outer_a.deallocate(container, numRows);
+            if(nextContainer != (T**)NULL)
+                outer_a.deallocate(nextContainer, numRows*2);
             assert(valid());}
 
         // ----------
@@ -681,6 +736,14 @@ class Deque {
             assert(valid());
             return *this;}
 
+        /**
+         * Move assignment, swaps maps with rhs in O(1)
+         * @param rhs deque to take the items of
+         */
+        Deque& operator = (Deque&& rhs) {
+            swap(rhs);
+            return *this;}
+
         // -----------
         // operator []
         // -----------
@@ -703,6 +766,32 @@ class Deque {
         const_reference operator [] (size_type index) const {
             return const_cast<Deque*>(this)->operator[](index);}
 
+        // ------
+        // append
+        // ------
+
+        /**
+         * Moves the items of that onto the back of this, leaving that empty. Whole blocks
+         * move between the maps by pointer; the smaller of the two deques is first
+         * realigned (one relocate, a memmove per block for trivially relocatable types)
+         * when its columns don't line up with the seam, and at most one partial block
+         * of items is moved across it. Costs O(blocks + min(size(), that.size())),
+         * O(blocks) only when the columns already line up: the realignment relocates
+         * every item of the smaller deque, a move-construct each for types that
+         * aren't trivially relocatable.
+         * @param that Deque to take the items of
+         * @pre that uses an allocator equal to ours
+         */
+        void append (Deque&& that) {
+            if(that.size() <= size())
+                splice_back(that);
+            else
+            {
+                that.splice_front(*this);
+                swap(that);
+            }
+            assert(valid());}
+
         // --
         // at
         // --
@@ -771,6 +860,46 @@ class Deque {
         const_iterator begin () const {
             return const_iterator(*this, 0);}
 
+        // ------
+        // cbegin
+        // ------
+
+        /**
+         * @return const_iterator pointing to start of deque
+         */
+        const_iterator cbegin () const {
+            return begin();}
+
+        // ----
+        // cend
+        // ----
+
+        /**
+         * @return const_iterator pointing to one past the last item
+         */
+        const_iterator cend () const {
+            return end();}
+
+        // -------
+        // crbegin
+        // -------
+
+        /**
+         * @return const_reverse_iterator pointing to the last item
+         */
+        const_reverse_iterator crbegin () const {
+            return rbegin();}
+
+        // -----
+        // crend
+        // -----
+
+        /**
+         * @return const_reverse_iterator pointing to one before the first item
+         */
+        const_reverse_iterator crend () const {
+            return rend();}
+
         // -----
         // clear
         // -----
@@ -824,12 +953,126 @@ class Deque {
          * @pre iterator it has valid position in range of [begin(), end())
          */
         iterator erase (iterator it) {
-            copy(it + 1, end(), it);
-            
-            pop_back();
+            erase(it.index, is_trivially_relocatable<T>());
             assert(valid());
             return it;}
 
+    private:
+        /**
+         * shifts the tail down over index with move assignments, then drops the last item
+         */
+        void erase (size_type index, std::false_type) {
+            std::move(begin() + index + 1, end(), begin() + index);
+            pop_back();}
+
+        /**
+         * destroys the item at index and memmoves the tail down over it
+         */
+        void erase (size_type index, std::true_type) {
+            alloc_traits::destroy(a, &(*this)[index]);
+            relocate(front_slot() + index + 1, front_slot() + index, size() - index - 1);
+            pop_back_update_cursors();}
+
+    public:
+
+        // -------------
+        // for_each_span
+        // -------------
+
+        /**
+         * Calls f(p, n) on the items block by block, front to back: each call gets
+         * the n items in [p, p + n). With ahead != 0 the block ahead blocks further
+         * on is prefetched before each call, so a scan of a deque that isn't in cache
+         * needn't stall on every block; whether that beats the hardware, which
+         * overlaps independent block loads by itself, is for BenchDequeScan to say.
+         * @param f called with a pointer and a size_type
+         * @param ahead how many blocks ahead to prefetch, 0 for none
+         * @return f
+         */
+        template <typename F>
+        F for_each_span (F f, size_type ahead = 0) {
+            size_type p = front_slot();
+            size_type e = p + size();
+            while(p != e)
+            {
+                size_type k = std::min(e - p, 10 - p%10);
+                if(ahead != 0)
+                    prefetch_row(p/10 + ahead);
+                f(slot(p), k);
+                p += k;
+            }
+            return f;}
+
+        /**
+         * Calls f(p, n) on the items block by block, front to back; see above
+         * @param f called with a const_pointer and a size_type
+         */
+        template <typename F>
+        F for_each_span (F f, size_type ahead = 0) const {
+            const_cast<Deque*>(this)->for_each_span([&f] (pointer p, size_type n) {f(const_pointer(p), n);}, ahead);
+            return f;}
+
+        // ---------------------
+        // for_each_span_reverse
+        // ---------------------
+
+        /**
+         * Calls f(p, n) on the items block by block, back to front: each call gets
+         * the n items in [p, p + n), to be walked from p + n - 1 down. With ahead != 0
+         * the block ahead blocks nearer the front is prefetched before each call.
+         * @param f called with a pointer and a size_type
+         * @param ahead how many blocks ahead to prefetch, 0 for none
+         * @return f
+         */
+        template <typename F>
+        F for_each_span_reverse (F f, size_type ahead = 0) {
+            size_type b = front_slot();
+            size_type p = b + size();
+            while(p != b)
+            {
+                size_type k = std::min(p - b, (p - 1)%10 + 1);
+                p -= k;
+                if(ahead != 0)
+                    prefetch_row(p/10 + numRows - ahead % numRows);
+                f(slot(p), k);
+            }
+            return f;}
+
+        /**
+         * Calls f(p, n) on the items block by block, back to front; see above
+         * @param f called with a const_pointer and a size_type
+         */
+        template <typename F>
+        F for_each_span_reverse (F f, size_type ahead = 0) const {
+            const_cast<Deque*>(this)->for_each_span_reverse([&f] (pointer p, size_type n) {f(const_pointer(p), n);}, ahead);
+            return f;}
+
+    private:
+
+        // ------------
+        // prefetch_row
+        // ------------
+
+        /**
+         * prefetches every cache line of block row of the map, if it is allocated
+         */
+        void prefetch_row (size_type row) const {
+            #if defined(__GNUC__)
+            const char* b = reinterpret_cast<const char*>(container[row % numRows]);
+            if(b == (const char*)NULL)
+                return;
+            const std::uintptr_t line = 64;
+            std::uintptr_t p = reinterpret_cast<std::uintptr_t>(b) & ~(line - 1);
+            const std::uintptr_t e = reinterpret_cast<std::uintptr_t>(b + 10 * sizeof(T));
+            for(; p < e; p += line)
+                __builtin_prefetch(reinterpret_cast<const void*>(p));
+            #else
+            (void)row;
+            #endif
+            }
+
+    public:
+
         // -----
         // front
         // -----
@@ -860,23 +1103,74 @@ class Deque {
          * @return iterator position where insertion occurred.
          */
         iterator insert (iterator it , const_reference value) {
-            //moving the last element over one, takes care of resize, cursors, etc
-            iterator endIt = end() - 1;
+            value_type tmp(value); //value may be one of our own items, copy it before shifting
+            insert(it.index, tmp, is_trivially_relocatable<T>());
+            assert(valid());
+            return it;}
 
-            push_back(back());
-            
-            while(endIt != it)
+        /**
+         * @pre it is a valid iterator position for insertion, in range [begin(), end()]
+         * @param it iterator where insertion occurs
+         * @param value value to move in
+         * @return iterator position where insertion occurred.
+         */
+        iterator insert (iterator it, value_type&& value) {
+            value_type tmp(std::move(value));
+            insert(it.index, tmp, is_trivially_relocatable<T>());
+            assert(valid());
+            return it;}
+
+    private:
+        /**
+         * moves the last element over one (takes care of resize, cursors, etc),
+         * shifts the rest back with move assignments and moves tmp into the gap
+         */
+        void insert (size_type index, value_type& tmp, std::false_type) {
+            if(index == size())
             {
-                *endIt = *(endIt - 1);
-                endIt--;
+                push_back(std::move(tmp));
+                return;
             }
-            
-            *(it) = value;
-            
-            //move stuff at the insert and the stuff after it back further
-            assert(valid());
 
-            return it;}
+            push_back(std::move(back()));
+            std::move_backward(begin() + index, end() - 2, end() - 1);
+            (*this)[index] = std::move(tmp);}
+
+        /**
+         * grows the back by one raw slot, memmoves the tail up into it and
+         * constructs tmp in the gap
+         */
+        void insert (size_type index, value_type& tmp, std::true_type) {
+            size_type mysize = size();
+
+            push_back_update_cursors_and_capacity();
+            relocate(front_slot() + index, front_slot() + index + 1, mysize - index);
+            alloc_traits::construct(a, &(*this)[index], std::move(tmp));}
+
+    public:
+
+        // ---------
+        // linearize
+        // ---------
+
+        /**
+         * Rotates the map so its rows no longer wrap around and relocates the items
+         * so that item i sits at container[i/10][i%10].
+         */
+        void linearize () {
+            finish_growth();
+            size_type mysize = size();
+
+            endRow = (endRow + numRows - beginRow) % numRows;
+            rotate(container, container + beginRow, container + numRows);
+            beginRow = 0;
+
+            relocate(beginCol, 0, mysize);
+            beginCol = 0;
+            endRow = mysize / 10;
+            endCol = mysize % 10;
+
+            assert(valid());}
 
         // ---
         // pop
@@ -888,12 +1182,10 @@ class Deque {
          */
         void pop_back () {
             //update pointers/cursors
-            if(endCol == 0)
-                endRow = (endRow == 0) ? numRows - 1 : endRow - 1;
-            endCol = (endCol == 0) ? 9 : endCol - 1;
+            pop_back_update_cursors();
                 
             //destroy
-            a.destroy(&container[endRow][endCol]);
+            alloc_traits::destroy(a, &container[endRow][endCol]);
             assert(valid());}
 
         /**
@@ -902,7 +1194,7 @@ class Deque {
          */
         void pop_front () {
             //destroy
-            a.destroy(&container[beginRow][beginCol]);
+            alloc_traits::destroy(a, &container[beginRow][beginCol]);
             
             //update pointers/cursors
             beginCol = (beginCol + 1) % 10;
@@ -910,6 +1202,79 @@ class Deque {
                 beginRow = (beginRow + 1) % numRows;
             assert(valid());}
 
+        /**
+         * Moves up to n items off the front of the container into out, one row at a time,
+         * and moves the begin cursors once for the whole batch.
+         * @param out where the items are moved to
+         * @param n maximum number of items to take
+         * @return out past the last item written
+         */
+        template <typename OutputIt>
+        OutputIt pop_front_into (OutputIt out, size_type n) {
+            n = std::min(n, size());
+
+            size_type p = front_slot();
+            size_type e = p + n;
+            while(p != e)
+            {
+                pointer q   = slot(p);
+                size_type k = std::min(e - p, 10 - p%10);
+                out = std::move(q, q + k, out);
+                for(pointer run = q + k; q != run; q++)
+                    alloc_traits::destroy(a, q);
+                p += k;
+            }
+
+            beginRow = (p/10) % numRows;
+            beginCol = p%10;
+            assert(valid());
+            return out;}
+
+        /**
+         * Deletes the first n items, a row at a time, and moves the begin cursors
+         * once for the whole batch; rows of trivially destructible items are
+         * dropped without touching them.
+         * @param n number of items to delete
+         * @pre n <= size()
+         */
+        void pop_front_n (size_type n) {
+            assert(n <= size());
+            size_type p = front_slot();
+            size_type e = p + n;
+            if(!std::is_trivially_destructible<T>::value)
+                while(p != e)
+                {
+                    pointer q   = slot(p);
+                    size_type k = std::min(e - p, 10 - p%10);
+                    for(pointer run = q + k; q != run; q++)
+                        alloc_traits::destroy(a, q);
+                    p += k;
+                }
+
+            beginRow = (e/10) % numRows;
+            beginCol = e%10;
+            assert(valid());}
+
+        // -------
+        // prepend
+        // -------
+
+        /**
+         * Moves the items of that onto the front of this, leaving that empty,
+         * the same way append does.
+         * @param that Deque to take the items of
+         * @pre that uses an allocator equal to ours
+         */
+        void prepend (Deque&& that) {
+            if(that.size() <= size())
+                splice_front(that);
+            else
+            {
+                that.splice_back(*this);
+                swap(that);
+            }
+            assert(valid());}
+
         // ---------------
         // double capacity
         // ---------------
@@ -925,27 +1290,24 @@ class Deque {
          */
         void double_capacity()
         {
-            assert(beginRow != endRow);
-            
+            if(nextContainer != (T**)NULL) //an incremental growth is under way, just finish it
+            {
+                finish_growth();
+                return;
+            }
+
             unsigned long newNumRows = numRows*2;
             unsigned long newBeginRow = newNumRows/2 - (numRows/2);
-            unsigned long newEndRow   = newBeginRow + numRows - 1;
+            unsigned long newEndRow   = newBeginRow + (endRow + numRows - beginRow) % numRows;
             
 
             T** containerTmp = outer_a.allocate(newNumRows);//new T*[newNumRows];
             fill(containerTmp, containerTmp+newNumRows, (T*)NULL); //NULL out outer new container, always!
             
-            if(beginRow < endRow)
-            {
-                copy(&container[beginRow], &container[endRow], &containerTmp[newBeginRow]);
-            }
-            else  //begin > end
-            {
-                copy(&container[beginRow], &container[numRows], &containerTmp[newBeginRow]);
-                
-                //TODO, is endRow+1 right when endCol = 0? (end row is a row by itself... not sure if its even allocated)
-                copy(&container[0], &container[endRow+1], &containerTmp[newBeginRow + (numRows - beginRow)]);
-            }
+            // every old row in ring order starting at beginRow, spare rows past endRow
+            // included so none of them leak when the map isn't full
+            copy(&container[beginRow], &container[numRows], &containerTmp[newBeginRow]);
+            copy(&container[0], &container[beginRow], &containerTmp[newBeginRow + (numRows - beginRow)]);
                         
             numRows = newNumRows;
             beginRow = newBeginRow;
@@ -971,7 +1333,7 @@ class Deque {
             {
                 endRowTmp = (endRowTmp + 1) % numRows; //handles potential wrap around
                 
-                if(endRowTmp == beginRow) // do resize?
+                if(endRowTmp == beginRow || (nextContainer != (T**)NULL && endRowTmp == nextGap)) // do resize?
                 {
                     double_capacity();
                     push_back_update_cursors_and_capacity(); //start over now that we have the space
@@ -980,12 +1342,13 @@ class Deque {
                 else if(container[endRowTmp] == NULL)
                 {
                     // allows assumption that rowend  colend is always allocated in advance
-                    container[endRowTmp] = a.allocate(10);
+                    set_row(endRowTmp, a.allocate(10));
                 }
             }
             
             endRow = endRowTmp;
             endCol = endColTmp;
+            grow_incrementally();
         }
 
         /**
@@ -1005,7 +1368,7 @@ class Deque {
                 else
                     beginRowTmp--;
             
-                if(beginRowTmp == endRow) //do resize?
+                if(beginRowTmp == endRow || (nextContainer != (T**)NULL && beginRowTmp == (nextGap + numRows - 1) % numRows)) //do resize?
                 {                
                     double_capacity();
                     push_front_update_cursors_and_capacity(); //start over now that we have the space
@@ -1013,7 +1376,7 @@ class Deque {
                 }    
                 else if(container[beginRowTmp] == NULL) // do allocation?
                 {
-                    container[beginRowTmp] = a.allocate(10);
+                    set_row(beginRowTmp, a.allocate(10));
                 }
             }
             else
@@ -1024,6 +1387,375 @@ class Deque {
             //final new values assigned
             beginRow = beginRowTmp;
             beginCol = beginColTmp;
+            grow_incrementally();
+        }
+
+        // ------------------
+        // incremental growth
+        // ------------------
+
+        /**
+         * Helper for push methods in incremental mode. Once more than half the rows are
+         * in use, starts a map twice as big and then copies two row pointers into it per
+         * push; it takes over once every row is copied, long before either end could
+         * reach the rows that will sit next to the new empty half. So no push ever
+         * copies the whole map, as double_capacity does.
+         */
+        void grow_incrementally()
+        {
+            if(nextContainer == (T**)NULL)
+            {
+                if(!incremental || used_rows() * 2 <= numRows)
+                    return;
+
+                // the empty half goes in the middle of the free rows, between
+                // nextGap - 1 (the end's side) and nextGap (the begin's side)
+                nextContainer = outer_a.allocate(numRows*2);
+                nextGap  = (endRow + 1 + (numRows - used_rows())/2) % numRows;
+                migrated = 0;
+            }
+            growth_step();
+            if(nextContainer != (T**)NULL)
+                growth_step();
+        }
+
+        /**
+         * copies one more old row into the next map and clears one row of its empty half,
+         * switching over to it when it's complete
+         */
+        void growth_step()
+        {
+            if(migrated < numRows)
+            {
+                nextContainer[migrated] = container[(nextGap + migrated) % numRows];
+                nextContainer[numRows + migrated] = (T*)NULL;
+                migrated++;
+                return;
+            }
+
+            outer_a.deallocate(container, numRows);
+            container = nextContainer;
+            beginRow  = (beginRow + numRows - nextGap) % numRows;
+            endRow    = (endRow + numRows - nextGap) % numRows;
+            numRows  *= 2;
+            nextContainer = (T**)NULL;
+        }
+
+        /**
+         * completes an incremental growth under way at once, before anything that
+         * rearranges the map
+         */
+        void finish_growth()
+        {
+            while(nextContainer != (T**)NULL)
+                growth_step();
+        }
+
+        /**
+         * keeps an incremental growth going after a batch has brought rows more rows
+         * into use, two steps per item as single pushes take, starting one if it's due
+         */
+        void grow_rows(size_type rows)
+        {
+            for(size_type k = 0; k < rows*10; k++)
+            {
+                grow_incrementally();
+                if(nextContainer == (T**)NULL)
+                    break;
+            }
+        }
+
+        /**
+         * @return the rows past endRow the back can take before it reaches beginRow,
+         * or the next map's empty half when a growth is under way
+         */
+        size_type room_back() const
+        {
+            if(nextContainer != (T**)NULL)
+                return (nextGap + numRows - endRow - 1) % numRows;
+            return numRows - used_rows();
+        }
+
+        /**
+         * @return the rows before beginRow the front can take before it reaches endRow,
+         * or the next map's empty half when a growth is under way
+         */
+        size_type room_front() const
+        {
+            if(nextContainer != (T**)NULL)
+                return (beginRow + numRows - nextGap) % numRows;
+            return numRows - used_rows();
+        }
+
+        /**
+         * sets old row i, and its copy in the next map if it was already copied
+         */
+        void set_row(size_type i, T* row)
+        {
+            container[i] = row;
+            if(nextContainer != (T**)NULL && (i + numRows - nextGap) % numRows < migrated)
+                nextContainer[(i + numRows - nextGap) % numRows] = row;
+        }
+
+        /**
+         * swaps old row i with row, through set_row
+         */
+        void swap_row(size_type i, T*& row)
+        {
+            T* r = container[i];
+            set_row(i, row);
+            row = r;
+        }
+
+        /**
+         * helper for pop back, steps the end cursors back one item without destroying it.
+         */
+        void pop_back_update_cursors()
+        {
+            if(endCol == 0)
+                endRow = (endRow == 0) ? numRows - 1 : endRow - 1;
+            endCol = (endCol == 0) ? 9 : endCol - 1;
+        }
+
+        /**
+         * helper for batched pushes, makes sure the n slots past the back are in allocated rows
+         * without moving the cursors. An incremental growth under way is left running unless
+         * the rows would reach the next map's empty half; then, as when they would run into
+         * beginRow, the map is doubled (which finishes the growth) first.
+         * @return the rows past endRow the n slots take
+         */
+        size_type reserve_back(size_type n)
+        {
+            size_type rows = (beginCol + size() + n) / 10 - (used_rows() - 1); // rows past endRow
+
+            while(rows > room_back())
+                double_capacity();
+
+            for(size_type r = 0; r <= rows; r++)
+            {
+                size_type row = (endRow + r) % numRows;
+                if(container[row] == NULL)
+                    set_row(row, a.allocate(10));
+            }
+            return rows;
+        }
+
+        /**
+         * helper for batched pushes, calls construct_at on each of the n slots past the back,
+         * one row at a time, and then moves the end cursors once. If construct_at throws, the
+         * items constructed so far are kept.
+         */
+        template <typename F>
+        void construct_back_n(size_type n, F construct_at)
+        {
+            size_type rows = reserve_back(n);
+
+            size_type p = front_slot() + size();
+            size_type e = p + n;
+            try
+            {
+                while(p != e)
+                {
+                    pointer q   = slot(p);
+                    pointer run = q + std::min(e - p, 10 - p%10);
+                    for(; q != run; q++, p++)
+                        construct_at(q);
+                }
+            }
+            catch(...)
+            {
+                endRow = (p/10) % numRows;
+                endCol = p%10;
+                throw;
+            }
+            endRow = (p/10) % numRows;
+            endCol = p%10;
+            grow_rows(rows);
+        }
+
+        // --------
+        // relocate
+        // --------
+
+        /**
+         * slots number the cells of the map row by row (slot p is container[p/10][p%10]),
+         * wrapping around the map, so item i lives in slot front_slot() + i
+         * @return the slot of the first item
+         */
+        size_type front_slot () const {
+            return beginRow*10 + beginCol;}
+
+        /**
+         * @return address of slot p
+         */
+        pointer slot (size_type p) {
+            return &container[(p/10) % numRows][p%10];}
+
+        /**
+         * Moves n items from the slots starting at from to the slots starting at to,
+         * one block segment at a time. The ranges may overlap; the slots that are
+         * left behind are raw memory.
+         * @pre every slot of both ranges lies in an allocated row
+         */
+        void relocate (size_type from, size_type to, size_type n) {
+            if(from == to)
+                return;
+
+            if(to < from)
+            {
+                while(n != 0)
+                {
+                    size_type run = std::min(n, std::min(10 - from%10, 10 - to%10));
+                    relocate_run(slot(from), slot(to), run);
+                    from += run;
+                    to   += run;
+                    n    -= run;
+                }
+            }
+            else
+            {
+                while(n != 0)
+                {
+                    size_type run = std::min(n, std::min((from + n - 1)%10 + 1, (to + n - 1)%10 + 1));
+                    n -= run;
+                    relocate_run(slot(from + n), slot(to + n), run);
+                }
+            }
+        }
+
+        /**
+         * Moves the n items starting at from to the raw memory starting at to.
+         * The two runs may overlap (inside one block).
+         */
+        void relocate_run (pointer from, pointer to, size_type n) {
+            relocate_run(from, to, n, is_trivially_relocatable<T>());}
+
+        /**
+         * with memmove
+         */
+        void relocate_run (pointer from, pointer to, size_type n, std::true_type) {
+            memmove(static_cast<void*>(to), from, n*sizeof(T));}
+
+        /**
+         * one item at a time, move constructing the new one and destroying the old one
+         */
+        void relocate_run (pointer from, pointer to, size_type n, std::false_type) {
+            if(to < from)
+            {
+                for(size_type i = 0; i != n; i++)
+                {
+                    alloc_traits::construct(a, to + i, std::move(from[i]));
+                    alloc_traits::destroy(a, from + i);
+                }
+            }
+            else
+            {
+                while(n != 0)
+                {
+                    n--;
+                    alloc_traits::construct(a, to + n, std::move(from[n]));
+                    alloc_traits::destroy(a, from + n);
+                }
+            }
+        }
+
+        // ------
+        // splice
+        // ------
+
+        /**
+         * @return the number of rows from beginRow to endRow, both included
+         */
+        size_type used_rows () const {
+            return (endRow + numRows - beginRow) % numRows + 1;}
+
+        /**
+         * helper for the splices, moves every item d slots towards the back
+         * so the columns of the first item become (beginCol + d) % 10
+         */
+        void shift_back (size_type d) {
+            if(d == 0)
+                return;
+
+            size_type mysize = size();
+            size_type rows   = reserve_back(d);
+
+            size_type p = front_slot();
+            relocate(p, p + d, mysize);
+
+            p += d;
+            beginRow = (p/10) % numRows;
+            beginCol = p%10;
+            endRow = ((p + mysize)/10) % numRows;
+            endCol = (p + mysize)%10;
+            grow_rows(rows);
+        }
+
+        /**
+         * Moves the items of that onto the back of this. that is realigned so its first
+         * column follows our endCol, then its first block's items move into our end block
+         * and its other blocks move over by pointer. that is left empty. A growth of our
+         * map under way keeps going, a few steps per row taken; that's, the smaller
+         * side's, is finished first.
+         */
+        void splice_back (Deque& that) {
+            if(that.empty())
+                return;
+
+            that.finish_growth();
+            that.shift_back((endCol + 10 - that.beginCol) % 10);
+
+            size_type first = that.front_slot();
+            size_type rows  = (first + that.size())/10 - first/10; //rows of that after its first one
+            while(rows > room_back())
+                double_capacity();
+
+            if(endCol == 0)
+                swap_row(endRow, that.container[that.beginRow]);
+            else
+                relocate_run(&that.container[that.beginRow][endCol], &container[endRow][endCol],
+                             std::min(that.size(), (size_type)(10 - endCol)));
+
+            for(size_type j = 1; j <= rows; j++)
+                swap_row((endRow + j) % numRows, that.container[(that.beginRow + j) % that.numRows]);
+
+            endRow = (endRow + rows) % numRows;
+            endCol = that.endCol;
+            that.endRow = that.beginRow;
+            that.endCol = that.beginCol;
+            grow_rows(rows);
+        }
+
+        /**
+         * Moves the items of that onto the front of this. that is realigned so its end
+         * column is our beginCol, then its last block's items move into our first block
+         * and its other blocks move over by pointer. that is left empty. Growth goes on
+         * as in splice_back.
+         */
+        void splice_front (Deque& that) {
+            if(that.empty())
+                return;
+
+            that.finish_growth();
+            that.shift_back((beginCol + 10 - that.endCol) % 10);
+
+            size_type mysize = that.size();
+            size_type last   = that.front_slot() + mysize;
+            size_type rows   = last/10 - that.front_slot()/10; //rows of that before its end row
+            while(rows > room_front())
+                double_capacity();
+
+            size_type k = std::min(mysize, (size_type)beginCol); //items of that in its end row
+            relocate_run(&that.container[that.endRow][beginCol - k], &container[beginRow][beginCol - k], k);
+
+            for(size_type j = 1; j <= rows; j++)
+                swap_row((beginRow + numRows - j) % numRows, that.container[(that.endRow + that.numRows - j) % that.numRows]);
+
+            beginRow = (beginRow + numRows - rows) % numRows;
+            beginCol = that.beginCol;
+            that.beginRow = that.endRow;
+            that.beginCol = that.endCol;
+            grow_rows(rows);
         }
         
         public:
@@ -1038,12 +1770,25 @@ class Deque {
             assert(container[endRow] != (T*)NULL);
             
             // go ahead and do the push at the current cursor end
-            a.construct(&container[endRow][endCol], item);
+            alloc_traits::construct(a, &container[endRow][endCol], item);
             
             // update them to their post push states (potentially doing allocation and even resize)
             push_back_update_cursors_and_capacity();
             
             assert(valid());}
+
+        /**
+         * moves an item onto the back of container
+         * @param item object to be moved in
+         */
+        void push_back (value_type&& item) {
+            assert(container[endRow] != (T*)NULL);
+            
+            alloc_traits::construct(a, &container[endRow][endCol], std::move(item));
+            
+            push_back_update_cursors_and_capacity();
+            
+            assert(valid());}
         
 
 
@@ -1056,11 +1801,118 @@ class Deque {
             push_front_update_cursors_and_capacity();            
             
             // PUSH!
-            a.construct(&container[beginRow][beginCol], item);
+            alloc_traits::construct(a, &container[beginRow][beginCol], item);
+            
+            assert(valid());
+        }
+
+        /**
+         * moves item onto the front of the container
+         * @param item object to move to front. 
+         */
+        void push_front (value_type&& item) 
+        {
+            push_front_update_cursors_and_capacity();            
+            
+            alloc_traits::construct(a, &container[beginRow][beginCol], std::move(item));
             
             assert(valid());
         }
 
+        /**
+         * adds n items to the back of the container, each one constructed from generator(),
+         * reserving the rows once and moving the cursors once for the whole batch
+         * @param generator called once per item, in order
+         * @param n number of items to add
+         */
+        template <typename G>
+        void push_back_n (G generator, size_type n) {
+            construct_back_n(n, [&] (pointer q) {alloc_traits::construct(this->a, q, generator());});
+            assert(valid());}
+
+        /**
+         * adds n items to the back of the container, each one constructed from args,
+         * reserving the rows once and moving the cursors once for the whole batch
+         * @param n number of items to add
+         * @param args constructor arguments shared by every item
+         */
+        template <typename... Args>
+        void emplace_back_n (size_type n, const Args&... args) {
+            construct_back_n(n, [&] (pointer q) {alloc_traits::construct(this->a, q, args...);});
+            assert(valid());}
+
+        // ------
+        // rbegin
+        // ------
+
+        /**
+         * @return reverse_iterator pointing to the last item
+         */
+        reverse_iterator rbegin () {
+            return reverse_iterator(end());}
+
+        /**
+         * @return const_reverse_iterator pointing to the last item
+         */
+        const_reverse_iterator rbegin () const {
+            return const_reverse_iterator(end());}
+
+        // -------------
+        // release_async
+        // -------------
+
+        /**
+         * Empties the deque in O(1) and leaves the teardown to someone else: the map
+         * and blocks are moved into a detached Deque, and e is handed a task that
+         * destroys the items and frees the blocks when it is called, e.g. on a
+         * Reclaimer's thread. If e drops the task without calling it, the teardown
+         * happens where the task is dropped, so e should move it, not copy it: the
+         * last copy to go does the teardown. The allocator must allow blocks to be
+         * freed from whichever thread that is.
+         * @param e called once with a task callable as task()
+         */
+        template <typename E>
+        void release_async (E&& e) {
+            Teardown task;
+            task.detached.reset(new Deque(this->a));
+            task.detached->swap(*this);
+            std::swap(incremental, task.detached->incremental);
+            e(std::move(task));
+            assert(valid());}
+
+    private:
+
+        // --------
+        // Teardown
+        // --------
+
+        /**
+         * owns a detached Deque; calling it destroys the Deque there and then
+         */
+        struct Teardown {
+            std::shared_ptr<Deque> detached;
+
+            void operator () () {
+                detached.reset();}};
+
+    public:
+
+        // ----
+        // rend
+        // ----
+
+        /**
+         * @return reverse_iterator pointing to one before the first item
+         */
+        reverse_iterator rend () {
+            return reverse_iterator(begin());}
+
+        /**
+         * @return const_reverse_iterator pointing to one before the first item
+         */
+        const_reverse_iterator rend () const {
+            return const_reverse_iterator(begin());}
+
         // ------
         // resize
         // ------
@@ -1086,6 +1938,55 @@ class Deque {
             }
             assert(valid());}
 
+        // ----------------------
+        // set_incremental_growth
+        // ----------------------
+
+        /**
+         * Turns incremental growth on or off. When it is on, a full map isn't copied
+         * into a bigger one in one go; the copy is spread over the pushes that follow,
+         * two row pointers per push, so every push_back and push_front is O(1) in the
+         * worst case and not just amortized. Copies of this Deque inherit the setting.
+         * @param on true for bounded push latency, false for one-shot doubling
+         */
+        void set_incremental_growth (bool on) {
+            if(!on)
+                finish_growth();
+            incremental = on;}
+
+        // -------------
+        // shrink_to_fit
+        // -------------
+
+        /**
+         * Linearizes the items, frees every row past the end row and shrinks
+         * the map to one spare row.
+         */
+        void shrink_to_fit () {
+            linearize();
+
+            for(unsigned long i = endRow + 1; i < numRows; i++)
+            {
+                if(container[i] != (T*)NULL)
+                {
+                    a.deallocate(container[i], 10);
+                    container[i] = (T*)NULL;
+                }
+            }
+
+            unsigned long newNumRows = endRow + 2;
+            if(newNumRows < numRows)
+            {
+                T** containerTmp = outer_a.allocate(newNumRows);
+                copy(container, container + newNumRows, containerTmp);
+
+                outer_a.deallocate(container, numRows);
+                container = containerTmp;
+                numRows = newNumRows;
+            }
+
+            assert(valid());}
+
         // ----
         // size
         // ----
@@ -1111,6 +2012,52 @@ class Deque {
             }
             return size;}
 
+        // --------
+        // split_at
+        // --------
+
+        /**
+         * Moves the items from pos on into a new Deque. The block holding item pos is
+         * the only one whose items are moved (at most 9 of them, into the new deque's
+         * first block at the same columns), every block after it moves by pointer.
+         * @param pos index of the first item to move out
+         * @return the items [pos, size())
+         * @pre pos w/in range [0, size()]
+         */
+        Deque split_at (size_type pos) {
+            Deque that(a);
+            that.incremental = incremental;
+            size_type mysize = size();
+            if(pos == mysize)
+                return that;
+
+            finish_growth();
+
+            size_type first = front_slot() + pos;
+            size_type rows  = (front_slot() + mysize)/10 - first/10 + 1; //rows from pos's to endRow
+            while(that.numRows < rows + 1)
+                that.double_capacity();
+
+            size_type row = (first/10) % numRows;
+            if(first%10 == 0)
+                std::swap(container[row], that.container[that.beginRow]); //that's empty block becomes our end row
+            else
+                relocate_run(&container[row][first%10], &that.container[that.beginRow][first%10],
+                             std::min(mysize - pos, (size_type)(10 - first%10)));
+
+            for(size_type j = 1; j < rows; j++)
+                std::swap(container[(row + j) % numRows], that.container[(that.beginRow + j) % that.numRows]);
+
+            that.beginCol = first%10;
+            that.endRow   = (that.beginRow + rows - 1) % that.numRows;
+            that.endCol   = endCol;
+            endRow = row;
+            endCol = first%10;
+
+            assert(valid());
+            assert(that.valid());
+            return that;}
+
         // ----
         // swap
         // ----
@@ -1128,7 +2075,19 @@ class Deque {
             std::swap(endCol, that.endCol);
             std::swap(numRows, that.numRows);
             std::swap(container, that.container);
+            std::swap(nextContainer, that.nextContainer);
+            std::swap(nextGap, that.nextGap);
+            std::swap(migrated, that.migrated);
+            std::swap(incremental, that.incremental);
+            std::swap(outer_a, that.outer_a); //the blocks go back to the allocator they came from
+            std::swap(a, that.a);
                         
             assert(valid());}};
 
+// -----------
+// Deque<bool>
+// -----------
+
+#include "BitDeque.h" // the bit-packed specialization
+
 #endif // Deque_h
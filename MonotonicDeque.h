@@ -0,0 +1,172 @@
+// -------------------------------
+// projects/deque/MonotonicDeque.h
+// Copyright (C) 2010
+// Glenn P. Downing
+// -------------------------------
+
+#ifndef MonotonicDeque_h
+#define MonotonicDeque_h
+
+// --------
+// includes
+// --------
+
+#include <cassert>    // assert
+#include <functional> // less
+#include <memory>     // allocator, allocator_traits
+#include <utility>    // move, pair
+
+#include "Deque.h"
+
+// --------------
+// MonotonicDeque
+// --------------
+
+/**
+ * The extreme (the minimum for Compare = less) of a sliding window: push_back
+ * adds the newest item of the window, pop_front drops the oldest one, front is
+ * the extreme of the items in between. Only the items that can still become
+ * the extreme are kept, in a Deque, in window order and sorted by Compare:
+ * push_back first pops every kept item that isn't better than the new one.
+ * Every operation is O(1) amortized, as each item is popped at most once.
+ */
+template < typename T, typename Compare = std::less<T>, typename A = std::allocator<T> >
+class MonotonicDeque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef A                                        allocator_type;
+        typedef typename allocator_type::value_type      value_type;
+
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::difference_type difference_type;
+
+        typedef const T&                                 const_reference;
+
+    private:
+        /**
+         * a kept item and its position in the window's stream
+         */
+        typedef std::pair<T, size_type> Entry;
+
+        typedef typename std::allocator_traits<A>::template rebind_alloc<Entry> entry_allocator_type;
+
+        // ----
+        // data
+        // ----
+
+        Deque<Entry, entry_allocator_type> kept;    //candidates, oldest first, best first
+        Compare comp;
+        size_type pushed, popped;                   //items that entered and left the window so far
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        /*
+         * @return true if MonotonicDeque is valid
+         */
+        bool valid () const {
+            if(popped > pushed || kept.size() > pushed - popped)
+                return false;
+            return kept.empty() || (kept.front().second >= popped && kept.back().second == pushed - 1);}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Constructs an empty window
+         * @param comp the order, front() is the item no other one is less than
+         */
+        explicit MonotonicDeque (const Compare& comp = Compare()) : comp(comp), pushed(0), popped(0) {
+            assert(valid());}
+
+        // Default copy, destructor, and copy assignment.
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * empties the window
+         */
+        void clear () {
+            kept.clear();
+            popped = pushed;
+            assert(valid());}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return size == 0
+         */
+        bool empty () const {
+            return !size();}
+
+        // -----
+        // front
+        // -----
+
+        /**
+         * @return the extreme of the window
+         * @pre not empty
+         */
+        const_reference front () const {
+            return kept.front().first;}
+
+        // ---
+        // pop
+        // ---
+
+        /**
+         * drops the oldest item of the window
+         * @pre not empty
+         */
+        void pop_front () {
+            if(kept.front().second == popped)
+                kept.pop_front();
+            popped++;
+            assert(valid());}
+
+        // ----
+        // push
+        // ----
+
+        /**
+         * adds item as the newest one of the window
+         * @param item object to be added
+         */
+        void push_back (const_reference item) {
+            while(!kept.empty() && !comp(kept.back().first, item))
+                kept.pop_back();
+            kept.push_back(Entry(item, pushed++));
+            assert(valid());}
+
+        /**
+         * moves item in as the newest one of the window
+         * @param item object to be moved in
+         */
+        void push_back (value_type&& item) {
+            while(!kept.empty() && !comp(kept.back().first, item))
+                kept.pop_back();
+            kept.push_back(Entry(std::move(item), pushed++));
+            assert(valid());}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return the number of items in the window, kept or not
+         */
+        size_type size () const {
+            return pushed - popped;}};
+
+#endif // MonotonicDeque_h
@@ -0,0 +1,432 @@
+// ------------------------------
+// projects/deque/NumaAllocator.h
+// Copyright (C) 2010
+// Glenn P. Downing
+// ------------------------------
+
+#ifndef NumaAllocator_h
+#define NumaAllocator_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm>   // max
+#include <cstddef>     // ptrdiff_t, size_t
+#include <cstdlib>     // atoi
+#include <fstream>     // ifstream
+#include <map>         // map
+#include <memory>      // make_shared, shared_ptr
+#include <mutex>       // mutex, lock_guard
+#include <new>         // bad_alloc
+#include <string>      // getline, string
+#include <type_traits> // false_type, true_type
+#include <utility>     // make_pair, pair
+#include <vector>     // vector
+
+#include <sys/mman.h>    // madvise, mincore, mmap, munmap
+#include <sys/syscall.h> // SYS_getcpu, SYS_mbind, SYS_move_pages
+#include <unistd.h>      // syscall
+
+// ---------
+// NumaStats
+// ---------
+
+/**
+ * where a NumaAllocator's memory is; see NumaArenas::stats
+ */
+struct NumaStats {
+    int requestedNode;                    //the node asked for, NumaPolicy::anyNode if none
+    int node;                             //the node the arenas are bound to, anyNode if they aren't
+    std::size_t arenas;                   //arenas mapped, 2 MiB ones and oversized ones
+    std::size_t hugetlbArenas;            //of those, backed by explicit huge pages
+    std::size_t transparentArenas;        //of those, advised to transparent huge pages
+    std::size_t bytesMapped;
+    std::size_t bytesInUse;               //handed out and not yet given back
+    std::size_t bindFailures;             //no such node, or mbind refused
+    std::size_t hugetlbFallbacks;         //explicit huge pages asked for but none reserved
+    std::vector<std::size_t> pagesOnNode; //4 KiB pages touched, by the node they are on
+    std::size_t untouchedPages;};         //pages not touched yet, so on no node
+
+// ----------
+// NumaPolicy
+// ----------
+
+/**
+ * the choices a NumaAllocator is made with, and what the machine offers
+ */
+struct NumaPolicy {
+    enum Pages {smallPages, transparentHugePages, explicitHugePages};
+
+    static const int anyNode   = -1;  //first touch decides
+    static const int localNode = -2;  //the node of the constructing thread's CPU
+
+    static const std::size_t arenaBytes = 2 << 20;
+    static const std::size_t pageBytes  = 4 << 10;
+
+    // -----
+    // nodes
+    // -----
+
+    /**
+     * @return the number of NUMA nodes, 1 on a machine (or kernel) without NUMA
+     */
+    static int nodes () {
+        std::ifstream in("/sys/devices/system/node/possible");
+        std::string s;
+        if(!std::getline(in, s) || s.empty())
+            return 1;
+        //reads like "0" or "0-3": the last number is the highest node
+        std::size_t k = s.find_last_of(",-");
+        return std::atoi(s.c_str() + (k == std::string::npos ? 0 : k + 1)) + 1;}
+
+    // ------------
+    // current_node
+    // ------------
+
+    /**
+     * @return the node of the CPU the calling thread is on, 0 if unknown
+     */
+    static int current_node () {
+        unsigned cpu = 0, node = 0;
+        if(::syscall(SYS_getcpu, &cpu, &node, 0) != 0)
+            return 0;
+        return node;}};
+
+// ----------
+// NumaArenas
+// ----------
+
+/**
+ * The 2 MiB arenas and free lists the copies of a NumaAllocator share.
+ * Thread safe: a Deque and the one it is swapped with may be on different threads.
+ */
+class NumaArenas : public NumaPolicy {
+    private:
+        // ----
+        // data
+        // ----
+
+        int requested;
+        int node;
+        Pages pages;
+        bool strict;
+        std::mutex m;
+        std::vector< std::pair<char*, std::size_t> > arenas;                       //address, bytes
+        std::map< std::pair<std::size_t, std::size_t>, std::vector<char*> > spare; //freed blocks, by bytes and alignment
+        char* next;                                                                //free space in the last arena
+        char* end;
+        std::size_t bytesInUse, hugetlbArenas, transparentArenas, bindFailures, hugetlbFallbacks;
+
+    private:
+        // ---
+        // map
+        // ---
+
+        /**
+         * @return bytes (a multiple of arenaBytes) of fresh memory, with the page
+         * size and node asked for where the machine allows
+         */
+        char* map (std::size_t bytes) {
+            void* p = MAP_FAILED;
+            if(pages == explicitHugePages)
+            {
+                p = ::mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if(p != MAP_FAILED)
+                    ++hugetlbArenas;
+                else
+                    ++hugetlbFallbacks;
+            }
+            if(p == MAP_FAILED)
+            {
+                //map an extra arena's worth to cut a 2 MiB aligned piece out of
+                char* q = static_cast<char*>(::mmap(0, bytes + arenaBytes, PROT_READ | PROT_WRITE,
+                                                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+                if(q == MAP_FAILED)
+                    throw std::bad_alloc();
+                char* b = q + (arenaBytes - reinterpret_cast<std::size_t>(q) % arenaBytes) % arenaBytes;
+                if(b != q)
+                    ::munmap(q, b - q);
+                ::munmap(b + bytes, q + arenaBytes - b);
+                p = b;
+                if(pages == smallPages)
+                    ::madvise(p, bytes, MADV_NOHUGEPAGE);
+                else if(::madvise(p, bytes, MADV_HUGEPAGE) == 0)
+                    ++transparentArenas;
+            }
+            if(node != anyNode && !bind(p, bytes))
+                ++bindFailures;
+            arenas.push_back(std::make_pair(static_cast<char*>(p), bytes));
+            return static_cast<char*>(p);}
+
+        // ----
+        // bind
+        // ----
+
+        /**
+         * binds [p, p + bytes) to node, or prefers it unless strict
+         * @return false if the kernel refused
+         */
+        bool bind (void* p, std::size_t bytes) {
+            const int preferred = 1, bound = 2;  //MPOL_PREFERRED, MPOL_BIND
+            const std::size_t bits = 8 * sizeof(unsigned long);
+            unsigned long mask[16] = {0};
+            if(node >= (int)(16 * bits))
+                return false;
+            mask[node / bits] = 1UL << (node % bits);
+            return ::syscall(SYS_mbind, p, bytes, strict ? bound : preferred, mask, 16 * bits, 0) == 0;}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * @param node a node number, anyNode or localNode
+         * @param pages the page size to back the arenas with
+         * @param strict bind to the node rather than prefer it
+         */
+        NumaArenas (int node, Pages pages, bool strict) :
+                requested(node), node(node == localNode ? current_node() : node), pages(pages), strict(strict),
+                next(0), end(0), bytesInUse(0), hugetlbArenas(0), transparentArenas(0), bindFailures(0),
+                hugetlbFallbacks(0) {
+            if(this->node >= nodes())
+            {
+                this->node = anyNode;
+                ++bindFailures;
+            }}
+
+        NumaArenas (const NumaArenas&) = delete;
+        NumaArenas& operator = (const NumaArenas&) = delete;
+
+        // ----------
+        // destructor
+        // ----------
+
+        ~NumaArenas () {
+            for(std::size_t i = 0; i < arenas.size(); i++)
+                ::munmap(arenas[i].first, arenas[i].second);}
+
+        // --------
+        // allocate
+        // --------
+
+        /**
+         * @param bytes a multiple of align
+         * @param align a power of 2
+         * @return bytes of memory aligned to align, a freed block of the same size if there is one
+         */
+        char* allocate (std::size_t bytes, std::size_t align) {
+            std::lock_guard<std::mutex> lock(m);
+            std::vector<char*>& f = spare[std::make_pair(bytes, align)];
+            char* p;
+            if(!f.empty())
+            {
+                p = f.back();
+                f.pop_back();
+            }
+            else if(bytes > arenaBytes / 4)
+                p = map((bytes + arenaBytes - 1) / arenaBytes * arenaBytes); //an arena of its own
+            else
+            {
+                p = next + (align - reinterpret_cast<std::size_t>(next) % align) % align;
+                if(next == 0 || p + bytes > end)
+                {
+                    next = map(arenaBytes);
+                    end  = next + arenaBytes;
+                    p    = next;
+                }
+                next = p + bytes;
+            }
+            bytesInUse += bytes;
+            return p;}
+
+        // ----------
+        // deallocate
+        // ----------
+
+        /**
+         * puts p on the free list for its size; an oversized block's pages go back
+         * to the system now, its addresses when the arenas do
+         */
+        void deallocate (char* p, std::size_t bytes, std::size_t align) {
+            std::lock_guard<std::mutex> lock(m);
+            bytesInUse -= bytes;
+            if(bytes > arenaBytes / 4)
+                ::madvise(p, bytes, MADV_DONTNEED);
+            spare[std::make_pair(bytes, align)].push_back(p);}
+
+        // -----
+        // stats
+        // -----
+
+        /**
+         * @return the arenas' placement; asks the kernel which node each page is on
+         * (move_pages, or mincore and node 0 without NUMA), a system call per arena
+         */
+        NumaStats stats () {
+            std::lock_guard<std::mutex> lock(m);
+            NumaStats s;
+            s.requestedNode     = requested;
+            s.node              = node;
+            s.arenas            = arenas.size();
+            s.hugetlbArenas     = hugetlbArenas;
+            s.transparentArenas = transparentArenas;
+            s.bytesMapped       = 0;
+            s.bytesInUse        = bytesInUse;
+            s.bindFailures      = bindFailures;
+            s.hugetlbFallbacks  = hugetlbFallbacks;
+            s.pagesOnNode.assign(nodes(), 0);
+            s.untouchedPages    = 0;
+            std::vector<void*> addresses;
+            std::vector<int> status;
+            std::vector<unsigned char> resident;
+            for(std::size_t i = 0; i < arenas.size(); i++)
+            {
+                char* p = arenas[i].first;
+                std::size_t bytes = arenas[i].second;
+                s.bytesMapped += bytes;
+                addresses.clear();
+                for(std::size_t k = 0; k < bytes; k += pageBytes)
+                    addresses.push_back(p + k);
+                status.assign(addresses.size(), -1);
+                if(::syscall(SYS_move_pages, 0, addresses.size(), &addresses[0], 0, &status[0], 0) != 0)
+                {
+                    resident.assign(addresses.size(), 0);
+                    ::mincore(p, bytes, &resident[0]);
+                    for(std::size_t k = 0; k < status.size(); k++)
+                        status[k] = (resident[k] & 1) ? 0 : -1;
+                }
+                for(std::size_t k = 0; k < status.size(); k++)
+                    if(status[k] >= 0 && status[k] < (int)s.pagesOnNode.size())
+                        ++s.pagesOnNode[status[k]];
+                    else
+                        ++s.untouchedPages;
+            }
+            return s;}};
+
+// -------------
+// NumaAllocator
+// -------------
+
+/**
+ * An allocator that carves blocks out of 2 MiB arenas it maps itself, so that a
+ * Deque's tiny blocks sit together on few (or huge) pages and on a chosen node.
+ *
+ * Each arena is bound to the node (mbind) before anything touches it, so its pages
+ * land there whichever thread touches them first; localNode picks the node of the
+ * CPU constructing the allocator, e.g. the consumer's. Pages are small (even where
+ * transparent huge pages are always on), transparent huge (2 MiB aligned and
+ * madvised) or explicit huge (MAP_HUGETLB, falling back to transparent when none
+ * are reserved). A node the machine doesn't have, or a kernel without NUMA, leaves
+ * the arenas unbound: the allocator still works, and stats says so.
+ *
+ * Freed blocks go on a free list by size and are reused; the arenas are only
+ * unmapped when the last copy of the allocator goes. Copies and rebinds share the
+ * arenas and compare equal; Deque hands its allocator to its map, its copies and
+ * across swap, so a whole Deque lives in one set of arenas (as do TieredDeque,
+ * CowDeque, CompressedDeque and RecordDeque). Allocators with arenas of their own
+ * compare unequal, and propagate on copy, move and swap, so a standard container
+ * never frees a block into arenas it didn't come from.
+ */
+template <typename T>
+class NumaAllocator : public NumaPolicy {
+    template <typename U>
+    friend class NumaAllocator;
+
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef T              value_type;
+        typedef std::size_t    size_type;
+        typedef std::ptrdiff_t difference_type;
+
+        typedef std::false_type is_always_equal;
+        typedef std::true_type  propagate_on_container_copy_assignment;
+        typedef std::true_type  propagate_on_container_move_assignment;
+        typedef std::true_type  propagate_on_container_swap;
+
+        template <typename U>
+        struct rebind {
+            typedef NumaAllocator<U> other;};
+
+    private:
+        // ----
+        // data
+        // ----
+
+        std::shared_ptr<NumaArenas> arenas;
+
+    private:
+        /**
+         * @return T's alignment, 8 at least; blocks are packed no looser than that
+         */
+        static size_type alignment () {
+            return std::max<size_type>(8, alignof(T));}
+
+        /**
+         * @return the bytes of n T's, rounded up to whole units of alignment
+         */
+        static size_type bytes (size_type n) {
+            return (n * sizeof(T) + alignment() - 1) / alignment() * alignment();}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Constructs an allocator with arenas of its own
+         * @param node the node to put the arenas on: a node number, anyNode or localNode
+         * @param pages the page size to back them with
+         * @param strict bind to the node rather than prefer it, failing when it is full
+         */
+        explicit NumaAllocator (int node = anyNode, Pages pages = smallPages, bool strict = false) :
+                arenas(std::make_shared<NumaArenas>(node, pages, strict)) {}
+
+        /**
+         * Constructs an allocator sharing that's arenas
+         */
+        template <typename U>
+        NumaAllocator (const NumaAllocator<U>& that) :
+                NumaPolicy(), arenas(that.arenas) {}
+
+        // --------
+        // allocate
+        // --------
+
+        T* allocate (size_type n, const void* = 0) {
+            return reinterpret_cast<T*>(arenas->allocate(bytes(n), alignment()));}
+
+        // ----------
+        // deallocate
+        // ----------
+
+        void deallocate (T* p, size_type n) {
+            arenas->deallocate(reinterpret_cast<char*>(p), bytes(n), alignment());}
+
+        // -----
+        // stats
+        // -----
+
+        /**
+         * @return where the arenas are; see NumaArenas::stats
+         */
+        NumaStats stats () const {
+            return arenas->stats();}
+
+        // -----------
+        // operator ==
+        // -----------
+
+        template <typename U>
+        bool operator == (const NumaAllocator<U>& that) const {
+            return arenas.get() == that.arenas.get();}
+
+        template <typename U>
+        bool operator != (const NumaAllocator<U>& that) const {
+            return arenas.get() != that.arenas.get();}};
+
+#endif // NumaAllocator_h
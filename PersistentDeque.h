@@ -0,0 +1,953 @@
+// --------------------------------
+// projects/deque/PersistentDeque.h
+// Copyright (C) 2010
+// Glenn P. Downing
+// --------------------------------
+
+#ifndef PersistentDeque_h
+#define PersistentDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // equal, lexicographical_compare
+#include <cassert>   // assert
+#include <cstddef>   // size_t, ptrdiff_t
+#include <iterator>  // bidirectional_iterator_tag
+#include <memory>    // shared_ptr, make_shared
+#include <new>       // placement new
+#include <stdexcept> // out_of_range
+#include <type_traits> // aligned_storage
+#include <utility>   // !=, <=, >, >=, pair
+
+// -----
+// using
+// -----
+
+using std::rel_ops::operator!=;
+using std::rel_ops::operator<=;
+using std::rel_ops::operator>;
+using std::rel_ops::operator>=;
+
+// ---------------
+// PersistentDeque
+// ---------------
+
+/**
+ * An immutable deque. Every "modifying" operation leaves this version alone and
+ * returns a new one that shares all but O(log n) of its structure with it.
+ *
+ * The items live in immutable chunks of up to 10 (Deque's block size), and the
+ * chunks are the leaves of a 2-3 finger tree annotated with sizes (Hinze and
+ * Paterson), which gives
+ *     push/pop at either end   O(log n) worst case, O(1) amortized along one line of versions
+ *     operator [], at          O(log n)
+ *     split_at, concat         O(log n)
+ * The tree is strict, not lazy, so the amortized bound only holds when each
+ * version is pushed or popped once, each built from the last. Pushing again and
+ * again onto one older version whose digits are full repeats the same O(log n)
+ * cascade down its spine every time.
+ * Versions can be handed to other threads freely, nothing is ever written after
+ * it is shared.
+ */
+template <typename T>
+class PersistentDeque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef T                 value_type;
+
+        typedef std::size_t       size_type;
+        typedef std::ptrdiff_t    difference_type;
+
+        typedef const T*          const_pointer;
+        typedef const T&          const_reference;
+
+    public:
+        // -----------
+        // operator ==
+        // -----------
+
+        /**
+         * @param lhs the PersistentDeque on the left hand side of operator ==
+         * @param rhs the PersistentDeque on the right hand side of operator ==
+         * @return true if they are equal false otherwise
+         */
+        friend bool operator == (const PersistentDeque& lhs, const PersistentDeque& rhs) {
+            return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());}
+
+        // ----------
+        // operator <
+        // ----------
+
+        /**
+         * @param lhs the PersistentDeque on the left hand side of operator <
+         * @param rhs the PersistentDeque on the right hand side of operator <
+         * @return true if lhs < rhs is true, false otherwise
+         */
+        friend bool operator < (const PersistentDeque& lhs, const PersistentDeque& rhs) {
+            return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());}
+
+    private:
+        // ----
+        // Node
+        // ----
+
+        /**
+         * an element of the tree: a Chunk of items at the top level, a Branch
+         * of 2 or 3 elements of the level above further down
+         */
+        struct Node {
+            size_type size;     //number of items under this node
+            bool leaf;};
+
+        typedef std::shared_ptr<const Node> NodePtr;
+
+        /**
+         * up to 10 items, never changed once it is shared
+         */
+        struct Chunk : Node {
+            size_type count;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type items[10];
+
+            Chunk () : count(0) {
+                this->size = 0;
+                this->leaf = true;}
+
+            ~Chunk () {
+                for(size_type i = 0; i < count; i++)
+                    item(i).~T();}
+
+            const T& item (size_type i) const {
+                return *reinterpret_cast<const T*>(&items[i]);}
+
+            /**
+             * constructs a copy of v after the last item
+             */
+            void add (const T& v) {
+                assert(count < 10);
+                ::new (static_cast<void*>(&items[count])) T(v);
+                count++;
+                this->size = count;}};
+
+        /**
+         * 2 or 3 elements of the level above
+         */
+        struct Branch : Node {
+            size_type count;
+            NodePtr kids[3];};
+
+        // ----
+        // Tree
+        // ----
+
+        struct Tree;
+        typedef std::shared_ptr<const Tree> TreePtr;
+
+        /**
+         * empty is a NULL TreePtr, a single element has npre == 1 and nsuf == 0,
+         * otherwise the prefix and suffix digits hold 1 to 4 elements each
+         */
+        struct Tree {
+            size_type size;
+            size_type npre, nsuf;
+            NodePtr pre[4], suf[4];
+            TreePtr mid;};
+
+        // ----
+        // data
+        // ----
+
+        TreePtr root;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        /*
+         * @return true if PersistentDeque is valid
+         */
+        bool valid () const {
+            if(!root)
+                return true;
+            return root->npre >= 1 && root->npre <= 4 && root->nsuf <= 4 && (root->nsuf != 0 || !root->mid);}
+
+        // -------
+        // helpers
+        // -------
+
+        static size_type size_of (const TreePtr& t) {
+            return t ? t->size : 0;}
+
+        static const Chunk* chunk (const NodePtr& n) {
+            return static_cast<const Chunk*>(n.get());}
+
+        static const Branch* branch (const Node* n) {
+            return static_cast<const Branch*>(n);}
+
+        static NodePtr node (const NodePtr& a, const NodePtr& b) {
+            std::shared_ptr<Branch> n = std::make_shared<Branch>();
+            n->leaf = false;
+            n->count = 2;
+            n->kids[0] = a;
+            n->kids[1] = b;
+            n->size = a->size + b->size;
+            return n;}
+
+        static NodePtr node (const NodePtr& a, const NodePtr& b, const NodePtr& c) {
+            std::shared_ptr<Branch> n = std::make_shared<Branch>();
+            n->leaf = false;
+            n->count = 3;
+            n->kids[0] = a;
+            n->kids[1] = b;
+            n->kids[2] = c;
+            n->size = a->size + b->size + c->size;
+            return n;}
+
+        static TreePtr single (const NodePtr& a) {
+            std::shared_ptr<Tree> t = std::make_shared<Tree>();
+            t->size = a->size;
+            t->npre = 1;
+            t->nsuf = 0;
+            t->pre[0] = a;
+            return t;}
+
+        /**
+         * @pre 1 <= npre, nsuf <= 4
+         */
+        static TreePtr deep (const NodePtr* pre, size_type npre, const TreePtr& mid, const NodePtr* suf, size_type nsuf) {
+            assert(npre >= 1 && npre <= 4 && nsuf >= 1 && nsuf <= 4);
+            std::shared_ptr<Tree> t = std::make_shared<Tree>();
+            t->size = size_of(mid);
+            t->npre = npre;
+            t->nsuf = nsuf;
+            for(size_type i = 0; i < npre; i++)
+            {
+                t->pre[i] = pre[i];
+                t->size += pre[i]->size;
+            }
+            for(size_type i = 0; i < nsuf; i++)
+            {
+                t->suf[i] = suf[i];
+                t->size += suf[i]->size;
+            }
+            t->mid = mid;
+            return t;}
+
+        /**
+         * @return a tree of the n <= 4 elements of e
+         */
+        static TreePtr from_digit (const NodePtr* e, size_type n) {
+            if(n == 0)
+                return TreePtr();
+            if(n == 1)
+                return single(e[0]);
+            return deep(e, n/2, TreePtr(), e + n/2, n - n/2);}
+
+        // ---------
+        // cons/snoc
+        // ---------
+
+        static TreePtr cons (const NodePtr& a, const TreePtr& t) {
+            if(!t)
+                return single(a);
+            if(t->nsuf == 0)
+                return deep(&a, 1, TreePtr(), t->pre, 1);
+            NodePtr p[4];
+            p[0] = a;
+            if(t->npre == 4)
+            {
+                p[1] = t->pre[0];
+                return deep(p, 2, cons(node(t->pre[1], t->pre[2], t->pre[3]), t->mid), t->suf, t->nsuf);
+            }
+            std::copy(t->pre, t->pre + t->npre, p + 1);
+            return deep(p, t->npre + 1, t->mid, t->suf, t->nsuf);}
+
+        static TreePtr snoc (const TreePtr& t, const NodePtr& a) {
+            if(!t)
+                return single(a);
+            if(t->nsuf == 0)
+                return deep(t->pre, 1, TreePtr(), &a, 1);
+            NodePtr s[4];
+            if(t->nsuf == 4)
+            {
+                s[0] = t->suf[3];
+                s[1] = a;
+                return deep(t->pre, t->npre, snoc(t->mid, node(t->suf[0], t->suf[1], t->suf[2])), s, 2);
+            }
+            std::copy(t->suf, t->suf + t->nsuf, s);
+            s[t->nsuf] = a;
+            return deep(t->pre, t->npre, t->mid, s, t->nsuf + 1);}
+
+        // -----------
+        // viewl/viewr
+        // -----------
+
+        /**
+         * a deep tree whose prefix may be empty, borrowing from mid or suf if it is
+         */
+        static TreePtr deep_l (const NodePtr* pre, size_type npre, const TreePtr& mid, const NodePtr* suf, size_type nsuf) {
+            if(npre != 0)
+                return deep(pre, npre, mid, suf, nsuf);
+            if(!mid)
+                return from_digit(suf, nsuf);
+            NodePtr n;
+            TreePtr m = viewl(mid, n);
+            return deep(branch(n.get())->kids, branch(n.get())->count, m, suf, nsuf);}
+
+        /**
+         * a deep tree whose suffix may be empty, borrowing from mid or pre if it is
+         */
+        static TreePtr deep_r (const NodePtr* pre, size_type npre, const TreePtr& mid, const NodePtr* suf, size_type nsuf) {
+            if(nsuf != 0)
+                return deep(pre, npre, mid, suf, nsuf);
+            if(!mid)
+                return from_digit(pre, npre);
+            NodePtr n;
+            TreePtr m = viewr(mid, n);
+            return deep(pre, npre, m, branch(n.get())->kids, branch(n.get())->count);}
+
+        /**
+         * @param head set to the first element of t
+         * @return t without its first element
+         * @pre t not empty
+         */
+        static TreePtr viewl (const TreePtr& t, NodePtr& head) {
+            head = t->pre[0];
+            if(t->nsuf == 0)
+                return TreePtr();
+            return deep_l(t->pre + 1, t->npre - 1, t->mid, t->suf, t->nsuf);}
+
+        /**
+         * @param last set to the last element of t
+         * @return t without its last element
+         * @pre t not empty
+         */
+        static TreePtr viewr (const TreePtr& t, NodePtr& last) {
+            if(t->nsuf == 0)
+            {
+                last = t->pre[0];
+                return TreePtr();
+            }
+            last = t->suf[t->nsuf - 1];
+            return deep_r(t->pre, t->npre, t->mid, t->suf, t->nsuf - 1);}
+
+        /**
+         * @return t with its first element (or last, if back) replaced by n
+         * @pre t not empty
+         */
+        static TreePtr replace (const TreePtr& t, const NodePtr& n, bool back) {
+            if(t->nsuf == 0)
+                return single(n);
+            NodePtr e[4];
+            if(back)
+            {
+                std::copy(t->suf, t->suf + t->nsuf, e);
+                e[t->nsuf - 1] = n;
+                return deep(t->pre, t->npre, t->mid, e, t->nsuf);
+            }
+            std::copy(t->pre, t->pre + t->npre, e);
+            e[0] = n;
+            return deep(e, t->npre, t->mid, t->suf, t->nsuf);}
+
+        // ----
+        // find
+        // ----
+
+        /**
+         * @param i index of an item under n, set to its index under the returned child
+         * @return the child of branch n that holds item i
+         */
+        static const Node* child (const Node* n, size_type& i) {
+            const Branch* b = branch(n);
+            size_type k = 0;
+            while(i >= b->kids[k]->size)
+                i -= b->kids[k++]->size;
+            return b->kids[k].get();}
+
+        /**
+         * @param i index of an item in t, set to its index in the returned element
+         * @return the element of t that holds item i
+         * @pre i < t->size
+         */
+        static const Node* find (const Tree* t, size_type& i) {
+            for(size_type k = 0; k < t->npre; k++)
+            {
+                if(i < t->pre[k]->size)
+                    return t->pre[k].get();
+                i -= t->pre[k]->size;
+            }
+            if(i < size_of(t->mid))
+                return child(find(t->mid.get(), i), i);
+            i -= size_of(t->mid);
+            size_type k = 0;
+            while(i >= t->suf[k]->size)
+                i -= t->suf[k++]->size;
+            return t->suf[k].get();}
+
+        // -----
+        // split
+        // -----
+
+        /**
+         * splits t into the elements before the one holding item i, that element
+         * and the elements after it
+         * @param i index of an item in t, set to its index in x
+         * @pre i < t->size
+         */
+        static void split (const TreePtr& t, size_type& i, TreePtr& l, NodePtr& x, TreePtr& r) {
+            if(t->nsuf == 0)
+            {
+                l = r = TreePtr();
+                x = t->pre[0];
+                return;
+            }
+
+            size_type k = 0;
+            for(; k < t->npre; k++)
+            {
+                if(i < t->pre[k]->size)
+                {
+                    l = from_digit(t->pre, k);
+                    x = t->pre[k];
+                    r = deep_l(t->pre + k + 1, t->npre - k - 1, t->mid, t->suf, t->nsuf);
+                    return;
+                }
+                i -= t->pre[k]->size;
+            }
+
+            if(i < size_of(t->mid))
+            {
+                TreePtr ml, mr;
+                NodePtr xs;
+                split(t->mid, i, ml, xs, mr);
+                const Branch* b = branch(xs.get());
+                for(k = 0; i >= b->kids[k]->size; k++)
+                    i -= b->kids[k]->size;
+                l = deep_r(t->pre, t->npre, ml, b->kids, k);
+                x = b->kids[k];
+                r = deep_l(b->kids + k + 1, b->count - k - 1, mr, t->suf, t->nsuf);
+                return;
+            }
+            i -= size_of(t->mid);
+
+            for(k = 0; i >= t->suf[k]->size; k++)
+                i -= t->suf[k]->size;
+            l = deep_r(t->pre, t->npre, t->mid, t->suf, k);
+            x = t->suf[k];
+            r = from_digit(t->suf + k + 1, t->nsuf - k - 1);}
+
+        // ------
+        // concat
+        // ------
+
+        /**
+         * groups the 2 to 12 elements of e into nodes of 2 or 3
+         * @return the number of nodes written to out
+         */
+        static size_type nodes (const NodePtr* e, size_type n, NodePtr* out) {
+            size_type m = 0;
+            while(n > 4)
+            {
+                out[m++] = node(e[0], e[1], e[2]);
+                e += 3;
+                n -= 3;
+            }
+            if(n == 4)
+            {
+                out[m++] = node(e[0], e[1]);
+                out[m++] = node(e[2], e[3]);
+            }
+            else if(n == 3)
+                out[m++] = node(e[0], e[1], e[2]);
+            else
+                out[m++] = node(e[0], e[1]);
+            return m;}
+
+        /**
+         * @return the elements of l, then the n elements of e, then the elements of r
+         */
+        static TreePtr app3 (const TreePtr& l, const NodePtr* e, size_type n, const TreePtr& r) {
+            if(!l)
+            {
+                TreePtr t = r;
+                while(n != 0)
+                    t = cons(e[--n], t);
+                return t;
+            }
+            if(!r)
+            {
+                TreePtr t = l;
+                for(size_type k = 0; k < n; k++)
+                    t = snoc(t, e[k]);
+                return t;
+            }
+            if(l->nsuf == 0)
+                return cons(l->pre[0], app3(TreePtr(), e, n, r));
+            if(r->nsuf == 0)
+                return snoc(app3(l, e, n, TreePtr()), r->pre[0]);
+
+            NodePtr all[12];
+            size_type m = 0;
+            for(size_type k = 0; k < l->nsuf; k++)
+                all[m++] = l->suf[k];
+            for(size_type k = 0; k < n; k++)
+                all[m++] = e[k];
+            for(size_type k = 0; k < r->npre; k++)
+                all[m++] = r->pre[k];
+            NodePtr ns[4];
+            size_type nn = nodes(all, m, ns);
+            return deep(l->pre, l->npre, app3(l->mid, ns, nn, r->mid), r->suf, r->nsuf);}
+
+        // ------
+        // chunks
+        // ------
+
+        /**
+         * @return a chunk of items [b, e) of c, with x before them if front and after them if back
+         */
+        static NodePtr make_chunk (const Chunk* c, size_type b, size_type e, const T* front = 0, const T* back = 0) {
+            std::shared_ptr<Chunk> n = std::make_shared<Chunk>();
+            if(front != 0)
+                n->add(*front);
+            for(; b < e; b++)
+                n->add(c->item(b));
+            if(back != 0)
+                n->add(*back);
+            return n;}
+
+        static NodePtr first (const TreePtr& t) {
+            return t->pre[0];}
+
+        static NodePtr last (const TreePtr& t) {
+            return t->nsuf == 0 ? t->pre[0] : t->suf[t->nsuf - 1];}
+
+        explicit PersistentDeque (const TreePtr& root) : root(root) {
+            assert(valid());}
+
+    public:
+        // --------------
+        // const_iterator
+        // --------------
+
+        /**
+         * remembers the chunk it is in, so it only searches the tree once per chunk
+         */
+        class const_iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::bidirectional_iterator_tag           iterator_category;
+                typedef typename PersistentDeque::value_type      value_type;
+                typedef typename PersistentDeque::difference_type difference_type;
+                typedef typename PersistentDeque::const_pointer   pointer;
+                typedef typename PersistentDeque::const_reference reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                /**
+                 * @param lhs the iterator on the left hand side of operator ==
+                 * @param rhs the iterator on the right hand side of operator ==
+                 * @return true if lhs == rhs is true, false otherwise
+                 */
+                friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs.index == rhs.index && lhs.myDeque == rhs.myDeque;}
+
+                // ----------
+                // operator +
+                // ----------
+
+                /**
+                 * Increments the iterator by rhs
+                 * @param lhs the iterator on the left hand side of operator +
+                 * @param rhs the amount to increment by
+                 */
+                friend const_iterator operator + (const_iterator lhs, difference_type rhs) {
+                    return lhs += rhs;}
+
+                // ----------
+                // operator -
+                // ----------
+
+                /**
+                 * Decrements the iterator by rhs
+                 * @param lhs the iterator on the left hand side of operator -
+                 * @param rhs the amount to decrement by
+                 */
+                friend const_iterator operator - (const_iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;}
+
+            private:
+                // ----
+                // data
+                // ----
+
+                size_type index;                    //index to the item we are pointing at
+                const PersistentDeque* myDeque;     //the version which the iterator is reading
+                mutable const Chunk* current;       //chunk holding items [first, first + current->count)
+                mutable size_type first;
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                /**
+                 * @param myDeque the PersistentDeque to iterate over
+                 * @param index the index location in myDeque to point at initially
+                 */
+                const_iterator (const PersistentDeque& myDeque, size_type index) :
+                        index(index), myDeque(&myDeque), current(0), first(0) {}
+
+                // ----------
+                // operator *
+                // ----------
+
+                /**
+                 * @return the element which this iterator is currently pointing at
+                 */
+                reference operator * () const {
+                    if(current == 0 || index < first || index >= first + current->count)
+                    {
+                        size_type i = index;
+                        current = myDeque->locate(i);
+                        first = index - i;
+                    }
+                    return current->item(index - first);}
+
+                // -----------
+                // operator ->
+                // -----------
+
+                /**
+                 * @return dereferenced element with access to members
+                 */
+                pointer operator -> () const {
+                    return &**this;}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                /**
+                 * Increments the iterator one place
+                 * @return the iterator after being incremented
+                 */
+                const_iterator& operator ++ () {
+                    index++;
+                    return *this;}
+
+                /**
+                 * Increments the iterator one place
+                 * @return the iterator before being incremented
+                 */
+                const_iterator operator ++ (int) {
+                    const_iterator x = *this;
+                    ++(*this);
+                    return x;}
+
+                // -----------
+                // operator --
+                // -----------
+
+                /**
+                 * Decrements the iterator one place
+                 * @return the iterator after being decremented
+                 */
+                const_iterator& operator -- () {
+                    index--;
+                    return *this;}
+
+                /**
+                 * Decrements the iterator one place
+                 * @return the iterator before being decremented
+                 */
+                const_iterator operator -- (int) {
+                    const_iterator x = *this;
+                    --(*this);
+                    return x;}
+
+                // -----------
+                // operator +=
+                // -----------
+
+                /**
+                 * Increments the iterator by d
+                 * @param d the amount to increment by
+                 * @return the iterator after being incremented
+                 */
+                const_iterator& operator += (difference_type d) {
+                    index += d;
+                    return *this;}
+
+                // -----------
+                // operator -=
+                // -----------
+
+                /**
+                 * Decrements the iterator by d
+                 * @param d the amount to decrement by
+                 * @return the iterator after being decremented
+                 */
+                const_iterator& operator -= (difference_type d) {
+                    index -= d;
+                    return *this;}};
+
+    private:
+        /**
+         * @param i index of an item, set to its index in the returned chunk
+         * @return the chunk holding item i
+         */
+        const Chunk* locate (size_type& i) const {
+            return static_cast<const Chunk*>(find(root.get(), i));}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Constructs empty PersistentDeque
+         */
+        PersistentDeque () {}
+
+        /**
+         * Constructs PersistentDeque of size s with initial values v
+         * @param s size of deque
+         * @param v intial value to use
+         */
+        explicit PersistentDeque (size_type s, const_reference v = value_type()) {
+            while(s != 0)
+            {
+                std::shared_ptr<Chunk> c = std::make_shared<Chunk>();
+                for(; s != 0 && c->count < 10; s--)
+                    c->add(v);
+                root = snoc(root, c);
+            }
+            assert(valid());}
+
+        // Default copy, destructor, and copy assignment, all O(1).
+        // PersistentDeque (const PersistentDeque&);
+        // ~PersistentDeque ();
+        // PersistentDeque& operator = (const PersistentDeque&);
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+         * @return const reference to the item at index, in O(log n)
+         * @pre index w/in range [0, size())
+         */
+        const_reference operator [] (size_type index) const {
+            const Chunk* c = locate(index);
+            return c->item(index);}
+
+        // --
+        // at
+        // --
+
+        /**
+         * @return const reference to the item at index
+         * @throws out_of_range exception if index not in [0, size())
+         */
+        const_reference at (size_type index) const {
+            if(index >= size())
+                throw std::out_of_range("PersistentDeque::at()");
+            return (*this)[index];}
+
+        // ----
+        // back
+        // ----
+
+        /**
+         * @pre not empty
+         * @return const reference to last item in deque
+         */
+        const_reference back () const {
+            const Chunk* c = chunk(last(root));
+            return c->item(c->count - 1);}
+
+        // -----
+        // begin
+        // -----
+
+        /**
+         * @return const_iterator pointing to start of deque
+         */
+        const_iterator begin () const {
+            return const_iterator(*this, 0);}
+
+        // ------
+        // concat
+        // ------
+
+        /**
+         * @return this version's items followed by that's, in O(log n)
+         */
+        PersistentDeque concat (const PersistentDeque& that) const {
+            if(!root)
+                return that;
+            if(!that.root)
+                return *this;
+
+            const Chunk* l = chunk(last(root));
+            const Chunk* r = chunk(first(that.root));
+            if(l->count + r->count > 10)
+                return PersistentDeque(app3(root, 0, 0, that.root));
+
+            //merge the two chunks at the seam so repeated concats don't leave a trail of small ones
+            std::shared_ptr<Chunk> c = std::make_shared<Chunk>();
+            for(size_type i = 0; i < l->count; i++)
+                c->add(l->item(i));
+            for(size_type i = 0; i < r->count; i++)
+                c->add(r->item(i));
+            NodePtr n;
+            TreePtr lt = viewr(root, n);
+            TreePtr rt = viewl(that.root, n);
+            NodePtr e = c;
+            return PersistentDeque(app3(lt, &e, 1, rt));}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return size == 0
+         */
+        bool empty () const {
+            return !root;}
+
+        // ---
+        // end
+        // ---
+
+        /**
+         * @return const_iterator pointing to one past the last item
+         */
+        const_iterator end () const {
+            return const_iterator(*this, size());}
+
+        // -----
+        // front
+        // -----
+
+        /**
+         * @return const reference to item at front of deque
+         * @pre not empty
+         */
+        const_reference front () const {
+            return chunk(first(root))->item(0);}
+
+        // ---
+        // pop
+        // ---
+
+        /**
+         * @return this version without its last item
+         * @pre not empty
+         */
+        PersistentDeque pop_back () const {
+            const Chunk* c = chunk(last(root));
+            if(c->count == 1)
+            {
+                NodePtr n;
+                return PersistentDeque(viewr(root, n));
+            }
+            return PersistentDeque(replace(root, make_chunk(c, 0, c->count - 1), true));}
+
+        /**
+         * @return this version without its first item
+         * @pre not empty
+         */
+        PersistentDeque pop_front () const {
+            const Chunk* c = chunk(first(root));
+            if(c->count == 1)
+            {
+                NodePtr n;
+                return PersistentDeque(viewl(root, n));
+            }
+            return PersistentDeque(replace(root, make_chunk(c, 1, c->count), false));}
+
+        // ----
+        // push
+        // ----
+
+        /**
+         * @return this version with item added to the back
+         */
+        PersistentDeque push_back (const_reference item) const {
+            if(root)
+            {
+                const Chunk* c = chunk(last(root));
+                if(c->count < 10)
+                    return PersistentDeque(replace(root, make_chunk(c, 0, c->count, 0, &item), true));
+            }
+            return PersistentDeque(snoc(root, make_chunk(0, 0, 0, 0, &item)));}
+
+        /**
+         * @return this version with item added to the front
+         */
+        PersistentDeque push_front (const_reference item) const {
+            if(root)
+            {
+                const Chunk* c = chunk(first(root));
+                if(c->count < 10)
+                    return PersistentDeque(replace(root, make_chunk(c, 0, c->count, &item), false));
+            }
+            return PersistentDeque(cons(make_chunk(0, 0, 0, &item), root));}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return the number of elements in the deque
+         */
+        size_type size () const {
+            return size_of(root);}
+
+        // --------
+        // split_at
+        // --------
+
+        /**
+         * @return the first pos items and the rest, in O(log n)
+         * @pre pos w/in range [0, size()]
+         */
+        std::pair<PersistentDeque, PersistentDeque> split_at (size_type pos) const {
+            if(pos == 0)
+                return std::make_pair(PersistentDeque(), *this);
+            if(pos == size())
+                return std::make_pair(*this, PersistentDeque());
+
+            TreePtr l, r;
+            NodePtr x;
+            split(root, pos, l, x, r);
+            if(pos == 0)
+                return std::make_pair(PersistentDeque(l), PersistentDeque(cons(x, r)));
+
+            const Chunk* c = chunk(x);
+            return std::make_pair(PersistentDeque(snoc(l, make_chunk(c, 0, pos))),
+                                  PersistentDeque(cons(make_chunk(c, pos, c->count), r)));}
+
+        // ----
+        // swap
+        // ----
+
+        /**
+         * @param that PersistentDeque to swap with
+         */
+        void swap (PersistentDeque& that) {
+            root.swap(that.root);}};
+
+#endif // PersistentDeque_h
@@ -0,0 +1,190 @@
+// --------------------------
+// projects/deque/Reclaimer.h
+// Copyright (C) 2010
+// Glenn P. Downing
+// --------------------------
+
+#ifndef Reclaimer_h
+#define Reclaimer_h
+
+// --------
+// includes
+// --------
+
+#include <cassert>            // assert
+#include <condition_variable> // condition_variable
+#include <cstddef>            // size_t
+#include <functional>         // function
+#include <mutex>              // mutex, lock_guard, unique_lock
+#include <thread>             // thread
+#include <utility>            // move
+
+#if defined(__linux__)
+#include <pthread.h>          // pthread_self, pthread_setschedparam
+#include <sched.h>            // sched_param, SCHED_IDLE
+#endif
+
+#include "Deque.h"
+
+// ---------
+// Reclaimer
+// ---------
+
+/**
+ * A background thread that runs teardown tasks, the ones Deque::release_async
+ * hands out, so the thread that let a huge Deque go doesn't pay for destroying
+ * its items and freeing its blocks:
+ *
+ *     Reclaimer r;
+ *     x.release_async(r);     // O(1); x is empty, its old items go on r's thread
+ *
+ * Tasks run one at a time, oldest first. With idle (the default, on Linux) the
+ * thread runs under SCHED_IDLE, so teardown takes only CPU nothing else wants
+ * and never preempts the threads doing real work. The destructor runs whatever
+ * is still queued before it returns.
+ */
+class Reclaimer {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef std::function<void ()> task_type;
+
+    private:
+        // ----
+        // data
+        // ----
+
+        std::mutex m;
+        std::condition_variable posted;  //a task is queued, or stopping
+        std::condition_variable drained; //the queue is empty and no task is running
+        Deque<task_type> tasks;
+        std::size_t done;
+        bool running, stopping;
+        std::thread worker;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        /*
+         * @return true if Reclaimer is valid; called with the lock held
+         */
+        bool valid () const {
+            return stopping || worker.joinable();}
+
+        /**
+         * the worker: runs tasks until stopping and drained
+         */
+        void run (bool idle) {
+            #if defined(__linux__)
+            if(idle)
+            {
+                sched_param p = sched_param();
+                pthread_setschedparam(pthread_self(), SCHED_IDLE, &p);
+            }
+            #else
+            (void)idle;
+            #endif
+            std::unique_lock<std::mutex> lock(m);
+            for(;;)
+            {
+                posted.wait(lock, [this] () {return stopping || !tasks.empty();});
+                if(tasks.empty())
+                    return;
+                task_type t(std::move(tasks.front()));
+                tasks.pop_front();
+                running = true;
+                lock.unlock();
+                t();
+                t = task_type();            //whatever the task still owns goes here, not on the poster's thread
+                lock.lock();
+                running = false;
+                ++done;
+                if(tasks.empty())
+                    drained.notify_all();
+            }}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Starts the worker
+         * @param idle run it under SCHED_IDLE (Linux only; ignored elsewhere)
+         */
+        explicit Reclaimer (bool idle = true) :
+                done(0), running(false), stopping(false), worker(&Reclaimer::run, this, idle) {}
+
+        Reclaimer (const Reclaimer&) = delete;
+        Reclaimer& operator = (const Reclaimer&) = delete;
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * Runs the tasks still queued, then stops the worker
+         */
+        ~Reclaimer () {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                stopping = true;
+                assert(valid());
+            }
+            posted.notify_one();
+            worker.join();}
+
+        // -----------
+        // operator ()
+        // -----------
+
+        /**
+         * Queues t to run on the worker; what Deque::release_async calls
+         * @param t the task, moved from
+         */
+        void operator () (task_type t) {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                tasks.push_back(std::move(t));
+                assert(valid());
+            }
+            posted.notify_one();}
+
+        // -------
+        // pending
+        // -------
+
+        /**
+         * @return the tasks queued or running
+         */
+        std::size_t pending () {
+            std::lock_guard<std::mutex> lock(m);
+            return tasks.size() + (running ? 1 : 0);}
+
+        // ---------
+        // reclaimed
+        // ---------
+
+        /**
+         * @return the tasks run to the end so far
+         */
+        std::size_t reclaimed () {
+            std::lock_guard<std::mutex> lock(m);
+            return done;}
+
+        // ----
+        // wait
+        // ----
+
+        /**
+         * Blocks until every task queued so far has run
+         */
+        void wait () {
+            std::unique_lock<std::mutex> lock(m);
+            drained.wait(lock, [this] () {return tasks.empty() && !running;});}};
+
+#endif // Reclaimer_h
@@ -0,0 +1,460 @@
+// ----------------------------
+// projects/deque/RecordDeque.h
+// Copyright (C) 2010
+// Glenn P. Downing
+// ----------------------------
+
+#ifndef RecordDeque_h
+#define RecordDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // min, swap
+#include <cassert>   // assert
+#include <cstdint>   // uint32_t
+#include <cstring>   // memcpy
+#include <memory>    // allocator, allocator_traits
+#include <string>    // string
+#include <utility>   // pair
+
+#include "Deque.h"
+
+// -----------
+// RecordDeque
+// -----------
+
+/**
+ * A FIFO of variable-length byte records (serialized messages) packed back to
+ * back into blocks of BlockSize bytes, each record a 4-byte length followed by
+ * its bytes. Like Deque's rows, the blocks hang off a map, here a Deque of block
+ * pointers, so a push appends bytes to the last block and a pop just moves the
+ * read position; a block is only allocated when the last one fills, and the
+ * block a pop empties is kept as a spare for the next one, so a queue in steady
+ * state allocates nothing.
+ *
+ * front() is a view of the first record: its bytes in one fragment, or in one
+ * per block when the record straddles blocks. It is valid until the next pop_front.
+ */
+template < std::size_t BlockSize = 256 * 1024, typename A = std::allocator<char> >
+class RecordDeque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef A                                        allocator_type;
+        typedef typename allocator_type::value_type      value_type;
+
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::difference_type difference_type;
+
+        static const size_type blockSize = BlockSize;
+
+    private:
+        typedef typename std::allocator_traits<A>::template rebind_alloc<char*> map_allocator_type;
+        typedef std::uint32_t                                                   length_type;
+
+        static const size_type maxSpare = 2;
+
+    public:
+        // ------
+        // Record
+        // ------
+
+        /**
+         * a view of a record's bytes, as fragments of at most one per block
+         */
+        class Record {
+            private:
+                const RecordDeque* myDeque;
+                size_type pos;  //offset of the bytes from the start of the first block
+                size_type len;  //number of bytes
+
+            public:
+                /**
+                 * @param myDeque the RecordDeque holding the record
+                 * @param pos offset of the record's bytes from the start of myDeque's first block
+                 * @param len number of bytes in the record
+                 */
+                Record (const RecordDeque& myDeque, size_type pos, size_type len) :
+                        myDeque(&myDeque), pos(pos), len(len) {}
+
+                /**
+                 * @return true if the bytes are in one fragment (or there are none)
+                 */
+                bool contiguous () const {
+                    return fragments() <= 1;}
+
+                /**
+                 * copies the bytes to out
+                 * @param out where to copy them, room for size() bytes
+                 */
+                void copy (char* out) const {
+                    for(size_type k = 0; k < fragments(); k++)
+                    {
+                        std::pair<const char*, size_type> f = fragment(k);
+                        std::memcpy(out, f.first, f.second);
+                        out += f.second;
+                    }}
+
+                /**
+                 * @return the bytes
+                 * @pre contiguous()
+                 */
+                const char* data () const {
+                    return len ? fragment(0).first : 0;}
+
+                /**
+                 * @return fragment k, its first byte and its length
+                 * @pre k < fragments()
+                 */
+                std::pair<const char*, size_type> fragment (size_type k) const {
+                    size_type first = pos / blockSize + k;
+                    size_type b = (k == 0) ? pos : first * blockSize;
+                    size_type e = std::min(pos + len, (first + 1) * blockSize);
+                    const char* block = (first == 0) ? myDeque->frontBlock : myDeque->blocks[first];
+                    return std::make_pair(block + b % blockSize, e - b);}
+
+                /**
+                 * @return the number of fragments, 0 if there are no bytes
+                 */
+                size_type fragments () const {
+                    return len ? (pos + len - 1) / blockSize - pos / blockSize + 1 : 0;}
+
+                /**
+                 * @return the number of bytes
+                 */
+                size_type size () const {
+                    return len;}
+
+                /**
+                 * @return the bytes as a string
+                 */
+                std::string str () const {
+                    std::string s(len, '\0');
+                    if(len)
+                        copy(&s[0]);
+                    return s;}};
+
+    private:
+        // ----
+        // data
+        // ----
+
+        allocator_type a;                           //allocator of blocks
+        Deque<char*, map_allocator_type> blocks;    //the blocks, in order
+        Deque<char*, map_allocator_type> spare;     //emptied blocks kept for reuse
+        size_type head;                             //offset of the first record from the start of blocks[0]
+        size_type tail;                             //offset one past the last record
+        size_type mysize;                           //number of records
+        //the first and last blocks, and the offset of the end of the last, kept out
+        //of blocks so most pushes and pops don't index the map
+        char* frontBlock;
+        char* backBlock;
+        size_type backEnd;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        /*
+         * @return true if RecordDeque is valid
+         */
+        bool valid () const {
+            return head <= tail && head < blockSize && (tail + blockSize - 1) / blockSize <= blocks.size() &&
+                   spare.size() <= maxSpare && (mysize != 0 || head == tail);}
+
+        // -----
+        // bytes
+        // -----
+
+        /**
+         * copies n bytes from src to offset pos, adding blocks as needed
+         */
+        void write (size_type pos, const char* src, size_type n) {
+            while(n != 0)
+            {
+                if(pos >= backEnd)
+                {
+                    blocks.push_back(new_block());
+                    refresh();
+                }
+                size_type off = pos % blockSize;
+                size_type m   = std::min(n, blockSize - off);
+                std::memcpy(blocks[pos / blockSize] + off, src, m);
+                pos += m;
+                src += m;
+                n   -= m;
+            }}
+
+        /**
+         * copies n bytes from offset pos to out
+         */
+        void read (size_type pos, char* out, size_type n) const {
+            while(n != 0)
+            {
+                size_type off = pos % blockSize;
+                size_type m   = std::min(n, blockSize - off);
+                std::memcpy(out, blocks[pos / blockSize] + off, m);
+                pos += m;
+                out += m;
+                n   -= m;
+            }}
+
+        /**
+         * @return the length of the record at offset pos
+         */
+        size_type length (size_type pos) const {
+            length_type n;
+            if(pos + sizeof(n) <= blockSize)
+                std::memcpy(&n, frontBlock + pos, sizeof(n));
+            else
+                read(pos, reinterpret_cast<char*>(&n), sizeof(n));
+            return n;}
+
+        /**
+         * points frontBlock, backBlock and backEnd at the blocks
+         */
+        void refresh () {
+            frontBlock = blocks.empty() ? 0 : blocks.front();
+            backBlock  = blocks.empty() ? 0 : blocks.back();
+            backEnd    = blocks.size() * blockSize;}
+
+        // ------
+        // blocks
+        // ------
+
+        /**
+         * @return a spare block if there is one, a new one otherwise
+         */
+        char* new_block () {
+            if(spare.empty())
+                return std::allocator_traits<A>::allocate(a, blockSize);
+            char* b = spare.back();
+            spare.pop_back();
+            return b;}
+
+        /**
+         * keeps b as a spare, or frees it if there are enough spares
+         */
+        void recycle (char* b) {
+            if(spare.size() < maxSpare)
+                spare.push_back(b);
+            else
+                std::allocator_traits<A>::deallocate(a, b, blockSize);}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Constructs empty RecordDeque
+         * @param a allocator to use
+         */
+        explicit RecordDeque (const allocator_type& a = allocator_type()) :
+                a(a), blocks(map_allocator_type(a)), spare(map_allocator_type(a)), head(0), tail(0), mysize(0),
+                frontBlock(0), backBlock(0), backEnd(0) {
+            assert(valid());}
+
+        /**
+         * Copy constructor, copies the records
+         * @param that RecordDeque to copy
+         */
+        RecordDeque (const RecordDeque& that) :
+                a(that.a), blocks(map_allocator_type(that.a)), spare(map_allocator_type(that.a)), head(0), tail(0), mysize(0),
+                frontBlock(0), backBlock(0), backEnd(0) {
+            for(size_type pos = that.head; pos != that.tail; pos += sizeof(length_type) + that.length(pos))
+            {
+                Record r(that, pos + sizeof(length_type), that.length(pos));
+                length_type m = (length_type)r.size();
+                write(tail, reinterpret_cast<const char*>(&m), sizeof(m));
+                tail += sizeof(m);
+                for(size_type k = 0; k < r.fragments(); k++)
+                {
+                    write(tail, r.fragment(k).first, r.fragment(k).second);
+                    tail += r.fragment(k).second;
+                }
+                ++mysize;
+            }
+            assert(valid());}
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * Frees the blocks and the spares
+         */
+        ~RecordDeque () {
+            for(size_type k = 0; k < blocks.size(); k++)
+                std::allocator_traits<A>::deallocate(a, blocks[k], blockSize);
+            for(size_type k = 0; k < spare.size(); k++)
+                std::allocator_traits<A>::deallocate(a, spare[k], blockSize);}
+
+        // ----------
+        // operator =
+        // ----------
+
+        /**
+         * assign rhs to this
+         * @param rhs RecordDeque whose records we'll copy
+         */
+        RecordDeque& operator = (const RecordDeque& rhs) {
+            RecordDeque that(rhs);
+            swap(that);
+            return *this;}
+
+        // -----
+        // bytes
+        // -----
+
+        /**
+         * @return the bytes the records take, lengths included
+         */
+        size_type bytes () const {
+            return tail - head;}
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * removes every record, keeping up to maxSpare blocks as spares
+         */
+        void clear () {
+            while(!blocks.empty())
+            {
+                recycle(blocks.back());
+                blocks.pop_back();
+            }
+            head = tail = mysize = 0;
+            refresh();
+            assert(valid());}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return size == 0
+         */
+        bool empty () const {
+            return !size();}
+
+        // -----
+        // front
+        // -----
+
+        /**
+         * @pre not empty
+         * @return a view of the first record, valid until the next pop_front
+         */
+        Record front () const {
+            return Record(*this, head + sizeof(length_type), length(head));}
+
+        // ---------
+        // pop_front
+        // ---------
+
+        /**
+         * Deletes the first record, keeping the block it empties as a spare
+         * @pre not empty
+         */
+        void pop_front () {
+            head += sizeof(length_type) + length(head);
+            if(--mysize == 0)
+            {
+                //start over at the start of the last block, the rest are empty
+                while(blocks.size() > 1 && head >= blockSize)
+                {
+                    recycle(blocks.front());
+                    blocks.pop_front();
+                    head -= blockSize;
+                }
+                head = tail = 0;
+                refresh();
+            }
+            else
+            {
+                if(head >= blockSize)
+                {
+                    while(head >= blockSize)
+                    {
+                        recycle(blocks.front());
+                        blocks.pop_front();
+                        head -= blockSize;
+                        tail -= blockSize;
+                    }
+                    refresh();
+                }
+            }
+            assert(valid());}
+
+        // ---------
+        // push_back
+        // ---------
+
+        /**
+         * adds a record of n bytes to the back of the container
+         * @param data the record's bytes
+         * @param n the number of bytes, less than 2^32
+         */
+        void push_back (const void* data, size_type n) {
+            assert(n == (length_type)n);
+            length_type m = (length_type)n;
+            if(tail + sizeof(m) + n <= backEnd && tail >= backEnd - blockSize)
+            {
+                //fits in the last block
+                char* p = backBlock + (tail - (backEnd - blockSize));
+                std::memcpy(p, &m, sizeof(m));
+                std::memcpy(p + sizeof(m), data, n);
+            }
+            else
+            {
+                write(tail, reinterpret_cast<const char*>(&m), sizeof(m));
+                write(tail + sizeof(m), static_cast<const char*>(data), n);
+            }
+            tail += sizeof(m) + n;
+            ++mysize;
+            assert(valid());}
+
+        /**
+         * adds a record holding s's bytes to the back of the container
+         * @param s the record's bytes
+         */
+        void push_back (const std::string& s) {
+            push_back(s.data(), s.size());}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return the number of records
+         */
+        size_type size () const {
+            return mysize;}
+
+        // ----
+        // swap
+        // ----
+
+        /**
+         * @param that RecordDeque to swap underlying data with
+         */
+        void swap (RecordDeque& that) {
+            blocks.swap(that.blocks);
+            spare.swap(that.spare);
+            std::swap(head, that.head);
+            std::swap(tail, that.tail);
+            std::swap(mysize, that.mysize);
+            std::swap(a, that.a); //the blocks go back to the allocator they came from
+            refresh();
+            that.refresh();
+            assert(valid());}};
+
+#endif // RecordDeque_h
@@ -0,0 +1,523 @@
+// -------------------------
+// projects/deque/ShmDeque.h
+// Copyright (C) 2010
+// Glenn P. Downing
+// -------------------------
+
+#ifndef ShmDeque_h
+#define ShmDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm>    // max
+#include <atomic>       // atomic, atomic_thread_fence
+#include <chrono>       // milliseconds
+#include <cassert>      // assert
+#include <cerrno>       // errno
+#include <climits>      // INT_MAX
+#include <cstdint>      // uint32_t, uint64_t
+#include <cstring>      // strncmp, strncpy
+#include <new>          // placement new
+#include <stdexcept>    // runtime_error
+#include <string>       // string
+#include <system_error> // system_error, system_category
+#include <thread>       // hardware_concurrency, sleep_for
+#include <type_traits>  // is_trivially_copyable
+
+#include <fcntl.h>        // O_CREAT, O_EXCL, O_RDWR
+#include <linux/futex.h>  // FUTEX_WAIT, FUTEX_WAKE
+#include <sys/mman.h>     // mmap, munmap, shm_open, shm_unlink
+#include <sys/stat.h>     // fstat
+#include <sys/syscall.h>  // SYS_futex
+#include <unistd.h>       // close, ftruncate, syscall
+
+// --------
+// ShmDeque
+// --------
+
+/**
+ * A queue of trivially copyable records in a POSIX shared-memory segment, so a
+ * producer and a consumer in different processes (or several producers, with
+ * MultiProducer) pass records through memory: one copy into the slot on push,
+ * and the consumer can read it in place with front().
+ *
+ * The segment holds Deque's layout with offsets in place of pointers: a header
+ * with the cursors, a map of numBlocks block offsets from the segment's start,
+ * and the blocks of blockItems slots. Record i is slot i % blockItems of block
+ * (i / blockItems) % numBlocks, so the capacity is fixed at numBlocks * blockItems
+ * and the cursors only count up. Each process maps the segment wherever mmap
+ * puts it, which is why the map holds offsets. The creator sets the header's
+ * ready flag, with a release store, only once the header and map are complete;
+ * a process opening the segment waits for it.
+ *
+ * The cursors are lock-free atomics on their own cache lines. With one producer
+ * the tail is published with a release store; with MultiProducer producers claim
+ * slots with a CAS on the tail and publish each one with a per-slot sequence
+ * number. A side that has to wait spins a little (not at all on one CPU) and
+ * then sleeps on a futex in the segment, which the other side wakes only when
+ * someone is waiting.
+ */
+template <typename T, bool MultiProducer = false>
+class ShmDeque {
+    static_assert(std::is_trivially_copyable<T>::value, "ShmDeque records must be trivially copyable");
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "ShmDeque needs address-free atomics");
+
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef T             value_type;
+        typedef std::size_t   size_type;
+        typedef T&            reference;
+        typedef const T&      const_reference;
+
+    private:
+        typedef std::uint64_t Offset;
+        typedef std::uint64_t Cursor;
+
+        /**
+         * the start of the segment
+         */
+        struct Header {
+            char magic[16];
+            std::atomic<std::uint32_t> ready;                   //1 once the creator has filled in the rest
+            std::uint64_t itemSize, blockItems, numBlocks, multiProducer;
+            alignas(64) std::atomic<Cursor> tail;               //records pushed (claimed, with MultiProducer)
+            alignas(64) std::atomic<Cursor> head;               //records popped
+            alignas(64) std::atomic<std::uint32_t> itemsEvent;  //futex the consumer sleeps on
+            std::atomic<std::uint32_t> consumerWaiting;         //1 while the consumer may be asleep
+            alignas(64) std::atomic<std::uint32_t> spaceEvent;  //futex producers sleep on
+            std::atomic<std::uint32_t> producersWaiting;};      //1 while a producer may be asleep
+
+        static const char* magic () {
+            return "ShmDeque v2";}
+
+        /**
+         * how long an opener waits for the creator to finish the segment
+         */
+        static const int openMillis = 1000;
+
+        /**
+         * @return n rounded up to a cache line
+         */
+        static size_type line (size_type n) {
+            return (n + 63) / 64 * 64;}
+
+        /**
+         * @return the smallest power of 2 >= n
+         */
+        static size_type pow2 (size_type n) {
+            size_type p = 1;
+            while(p < n)
+                p *= 2;
+            return p;}
+
+        // ----
+        // data
+        // ----
+
+        std::string name;               //the segment's name
+        bool owner;                     //whether this handle created the segment and unlinks it
+        int fd;
+        char* base;                     //where the segment is mapped in this process
+        size_type bytes;                //the segment's size
+        Header* h;
+        const Offset* map;              //block offsets from base
+        std::atomic<Cursor>* seq;       //per slot: index + 1 once published, with MultiProducer
+        size_type blockShift, blockMask, rowMask;
+        int spins;                      //polls before sleeping
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        /*
+         * @return true if ShmDeque is valid
+         */
+        bool valid () const {
+            return h != 0 && h->head.load() <= h->tail.load() && h->tail.load() - h->head.load() <= capacity();}
+
+        // ------
+        // layout
+        // ------
+
+        /**
+         * @return the bytes before the blocks: header, map and sequence numbers
+         */
+        static size_type prefix (size_type blockItems, size_type numBlocks) {
+            return line(sizeof(Header)) + line(numBlocks * sizeof(Offset)) +
+                   (MultiProducer ? line(blockItems * numBlocks * sizeof(Cursor)) : 0);}
+
+        /**
+         * @return the bytes of a block
+         */
+        static size_type block_bytes (size_type blockItems) {
+            return line(blockItems * sizeof(T));}
+
+        /**
+         * maps the open segment fd of the given size and points the fields into it
+         */
+        void attach (size_type size) {
+            void* p = ::mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if(p == MAP_FAILED)
+                fail("mmap");
+            base  = static_cast<char*>(p);
+            bytes = size;
+            h     = reinterpret_cast<Header*>(base);}
+
+        /**
+         * points map, seq and the slot arithmetic at the header's layout
+         */
+        void locate () {
+            map = reinterpret_cast<const Offset*>(base + line(sizeof(Header)));
+            seq = MultiProducer ?
+                  reinterpret_cast<std::atomic<Cursor>*>(base + line(sizeof(Header)) + line(h->numBlocks * sizeof(Offset))) : 0;
+            blockShift = 0;
+            while(((size_type)1 << blockShift) < h->blockItems)
+                ++blockShift;
+            blockMask = h->blockItems - 1;
+            rowMask   = h->numBlocks - 1;
+            spins     = (std::thread::hardware_concurrency() > 1) ? 2000 : 0;}
+
+        /**
+         * closes what is open and throws a system_error for what failed
+         */
+        void fail (const char* what) {
+            int e = errno;
+            if(fd >= 0)
+                ::close(fd);
+            if(owner)
+                ::shm_unlink(name.c_str());
+            throw std::system_error(e, std::system_category(), what);}
+
+        /**
+         * unmaps and closes the segment and throws a runtime_error saying why
+         */
+        void reject (const char* why) {
+            if(base != 0)
+                ::munmap(base, bytes);
+            ::close(fd);
+            throw std::runtime_error("ShmDeque: " + name + " " + why);}
+
+        /**
+         * @return the slot of record i
+         */
+        T* slot (Cursor i) const {
+            return reinterpret_cast<T*>(base + map[(i >> blockShift) & rowMask]) + (i & blockMask);}
+
+        // -------
+        // waiting
+        // -------
+
+        static void futex_wait (std::atomic<std::uint32_t>& event, std::uint32_t seen) {
+            ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&event), FUTEX_WAIT, seen, 0, 0, 0);}
+
+        static void futex_wake (std::atomic<std::uint32_t>& event) {
+            ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&event), FUTEX_WAKE, INT_MAX, 0, 0, 0);}
+
+        /**
+         * returns once ready() is true, polling then sleeping on event; waiting is
+         * set while someone may be asleep, and cleared by whoever wakes them
+         */
+        template <typename F>
+        void wait (std::atomic<std::uint32_t>& event, std::atomic<std::uint32_t>& waiting, F ready) const {
+            for(int i = 0; i < spins; i++)
+                if(ready())
+                    return;
+            while(!ready())
+            {
+                std::uint32_t seen = event.load(std::memory_order_acquire);
+                waiting.store(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if(!ready())
+                    futex_wait(event, seen);
+            }}
+
+        /**
+         * wakes whoever sleeps on event, after a cursor or sequence number was
+         * published; a syscall only the first time after someone went to sleep
+         */
+        static void wake (std::atomic<std::uint32_t>& event, std::atomic<std::uint32_t>& waiting) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if(waiting.load(std::memory_order_relaxed) != 0 && waiting.exchange(0, std::memory_order_relaxed) != 0)
+            {
+                event.fetch_add(1, std::memory_order_release);
+                futex_wake(event);
+            }}
+
+        /**
+         * @return true if record i has been published
+         */
+        bool published (Cursor i) const {
+            if(MultiProducer)
+                return seq[i & (capacity() - 1)].load(std::memory_order_acquire) == i + 1;
+            return h->tail.load(std::memory_order_acquire) > i;}
+
+        /**
+         * waits until the first record has been published
+         * @return its index
+         */
+        Cursor wait_front () const {
+            Cursor i = h->head.load(std::memory_order_relaxed);
+            wait(h->itemsEvent, h->consumerWaiting, [this, i] () {return this->published(i);});
+            return i;}
+
+        /**
+         * @param block whether to wait for a free slot when there is none
+         * @return the index of a free slot claimed for a record, ~0 if there is none and not block
+         */
+        Cursor claim (bool block) {
+            Cursor t = h->tail.load(std::memory_order_relaxed);
+            for(;;)
+            {
+                if(t - h->head.load(std::memory_order_acquire) >= capacity())
+                {
+                    //another producer may have moved the tail, and the head, past a stale t
+                    Cursor now = h->tail.load(std::memory_order_relaxed);
+                    if(now != t)
+                    {
+                        t = now;
+                        continue;
+                    }
+                    if(!block)
+                        return ~(Cursor)0;
+                    Header* hh = h;
+                    size_type c = capacity();
+                    wait(h->spaceEvent, h->producersWaiting, [hh, c, &t] () {
+                        Cursor head = hh->head.load(std::memory_order_acquire);    //before the tail, so head <= t
+                        t = hh->tail.load(std::memory_order_relaxed);
+                        return t - head < c;});
+                    continue;
+                }
+                if(!MultiProducer)
+                    return t;
+                if(h->tail.compare_exchange_weak(t, t + 1, std::memory_order_relaxed))
+                    return t;
+            }}
+
+        /**
+         * writes item to claimed slot t and publishes it
+         */
+        void publish (Cursor t, const_reference item) {
+            *slot(t) = item;
+            if(MultiProducer)
+                seq[t & (capacity() - 1)].store(t + 1, std::memory_order_release);
+            else
+                h->tail.store(t + 1, std::memory_order_release);
+            wake(h->itemsEvent, h->consumerWaiting);}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Creates the segment name holding at least capacity records, and unlinks it
+         * when destroyed; other processes open it with ShmDeque(name)
+         * @param name the segment's name, "/" followed by up to 254 characters
+         * @param capacity the least number of records it has to hold
+         * @throws system_error if the segment can't be created (e.g. it exists)
+         */
+        ShmDeque (const std::string& name, size_type capacity) :
+                name(name), owner(true), fd(-1), base(0), bytes(0), h(0), map(0), seq(0) {
+            size_type blockItems = pow2(std::max<size_type>(1, 4096 / sizeof(T)));
+            size_type numBlocks  = pow2((std::max<size_type>(capacity, 1) + blockItems - 1) / blockItems);
+            size_type size = prefix(blockItems, numBlocks) + numBlocks * block_bytes(blockItems);
+
+            fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if(fd < 0)
+            {
+                owner = false;
+                fail("shm_open");
+            }
+            if(::ftruncate(fd, size) != 0)
+                fail("ftruncate");
+            attach(size);
+
+            Header* hh = new (base) Header;
+            std::strncpy(hh->magic, magic(), sizeof(hh->magic));
+            hh->itemSize      = sizeof(T);
+            hh->blockItems    = blockItems;
+            hh->numBlocks     = numBlocks;
+            hh->multiProducer = MultiProducer;
+            new (&hh->tail) std::atomic<Cursor>(0);
+            new (&hh->head) std::atomic<Cursor>(0);
+            new (&hh->itemsEvent) std::atomic<std::uint32_t>(0);
+            new (&hh->consumerWaiting) std::atomic<std::uint32_t>(0);
+            new (&hh->spaceEvent) std::atomic<std::uint32_t>(0);
+            new (&hh->producersWaiting) std::atomic<std::uint32_t>(0);
+
+            Offset* m = reinterpret_cast<Offset*>(base + line(sizeof(Header)));
+            for(size_type k = 0; k < numBlocks; k++)
+                m[k] = prefix(blockItems, numBlocks) + k * block_bytes(blockItems);
+            locate();
+            if(MultiProducer)
+                for(size_type i = 0; i < this->capacity(); i++)
+                    new (&seq[i]) std::atomic<Cursor>(0);
+            hh->ready.store(1, std::memory_order_release);
+            assert(valid());}
+
+        /**
+         * Opens the segment name created by another ShmDeque, waiting up to
+         * openMillis for its creator to finish it
+         * @param name the segment's name
+         * @throws system_error if it can't be opened, runtime_error if it holds another
+         * kind of ShmDeque or was never finished
+         */
+        explicit ShmDeque (const std::string& name) :
+                name(name), owner(false), fd(-1), base(0), bytes(0), h(0), map(0), seq(0) {
+            fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+            if(fd < 0)
+                fail("shm_open");
+            struct stat st;
+            for(int ms = 0; ; ms++)
+            {
+                if(::fstat(fd, &st) != 0)
+                    fail("fstat");
+                if(base == 0 && (size_type)st.st_size >= line(sizeof(Header)))
+                    attach(line(sizeof(Header)));
+                if(base != 0 && h->ready.load(std::memory_order_acquire) != 0)
+                    break;
+                if(ms == openMillis)
+                    reject("was never finished by its creator");
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            if(std::strncmp(h->magic, magic(), sizeof(h->magic)) != 0 || h->itemSize != sizeof(T) ||
+               h->multiProducer != MultiProducer)
+                reject("holds another kind of queue");
+            size_type blockItems = h->blockItems, numBlocks = h->numBlocks;
+            if(blockItems == 0 || (blockItems & (blockItems - 1)) != 0 || numBlocks == 0 || (numBlocks & (numBlocks - 1)) != 0 ||
+               ::fstat(fd, &st) != 0 || (size_type)st.st_size < prefix(blockItems, numBlocks) + numBlocks * block_bytes(blockItems))
+                reject("is corrupt");
+            ::munmap(base, bytes);
+            base = 0;
+            attach(prefix(blockItems, numBlocks) + numBlocks * block_bytes(blockItems));
+            locate();
+            assert(valid());}
+
+        ShmDeque (const ShmDeque&) = delete;
+        ShmDeque& operator = (const ShmDeque&) = delete;
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * Unmaps the segment, and unlinks its name if this handle created it; the
+         * other processes' mappings stay valid
+         */
+        ~ShmDeque () {
+            ::munmap(base, bytes);
+            ::close(fd);
+            if(owner)
+                ::shm_unlink(name.c_str());}
+
+        // --------
+        // capacity
+        // --------
+
+        /**
+         * @return the number of records the segment holds
+         */
+        size_type capacity () const {
+            return h->blockItems * h->numBlocks;}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return size == 0
+         */
+        bool empty () const {
+            return !size();}
+
+        // -----
+        // front
+        // -----
+
+        /**
+         * Consumer only. Waits for a record.
+         * @return the first record, read in place in the segment, valid until pop_front
+         */
+        const_reference front () const {
+            return *slot(wait_front());}
+
+        // ---------
+        // pop_front
+        // ---------
+
+        /**
+         * Consumer only. Waits for a record, then removes the first one.
+         */
+        void pop_front () {
+            Cursor i = wait_front();
+            h->head.store(i + 1, std::memory_order_release);
+            wake(h->spaceEvent, h->producersWaiting);}
+
+        /**
+         * Consumer only. Waits for a record, then moves the first one to out.
+         */
+        void pop_front (reference out) {
+            Cursor i = wait_front();
+            out = *slot(i);
+            h->head.store(i + 1, std::memory_order_release);
+            wake(h->spaceEvent, h->producersWaiting);}
+
+        // ---------
+        // push_back
+        // ---------
+
+        /**
+         * Producer. Copies item into the next slot, waiting for one if full.
+         */
+        void push_back (const_reference item) {
+            publish(claim(true), item);}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return the number of records pushed (with MultiProducer, claimed) and not popped
+         */
+        size_type size () const {
+            return h->tail.load(std::memory_order_acquire) - h->head.load(std::memory_order_acquire);}
+
+        // -------------
+        // try_pop_front
+        // -------------
+
+        /**
+         * Consumer only. Moves the first record to out if there is one.
+         * @return whether there was one
+         */
+        bool try_pop_front (reference out) {
+            Cursor i = h->head.load(std::memory_order_relaxed);
+            if(!published(i))
+                return false;
+            out = *slot(i);
+            h->head.store(i + 1, std::memory_order_release);
+            wake(h->spaceEvent, h->producersWaiting);
+            return true;}
+
+        // --------------
+        // try_push_back
+        // --------------
+
+        /**
+         * Producer. Copies item into the next slot if there is one.
+         * @return whether there was one
+         */
+        bool try_push_back (const_reference item) {
+            Cursor t = claim(false);
+            if(t == ~(Cursor)0)
+                return false;
+            publish(t, item);
+            return true;}};
+
+#endif // ShmDeque_h
@@ -0,0 +1,280 @@
+// ------------------------------
+// projects/deque/SlidingWindow.h
+// Copyright (C) 2010
+// Glenn P. Downing
+// ------------------------------
+
+#ifndef SlidingWindow_h
+#define SlidingWindow_h
+
+// --------
+// includes
+// --------
+
+#include <cassert>    // assert
+#include <functional> // plus
+#include <memory>     // allocator, allocator_traits
+#include <utility>    // move
+
+#include "Deque.h"
+
+// -------------
+// SlidingWindow
+// -------------
+
+/**
+ * The aggregate, under any associative op, of a FIFO window of items:
+ * push_back adds the newest item, pop_front drops the oldest one and query
+ * returns op(op(...op(first, second)...), last) in O(1). op needs no inverse.
+ *
+ * The items sit in a Deque, next to the aggregates used to answer queries,
+ * in three runs: front [0, mid) and middle [mid, back) hold suffix aggregates
+ * (aggregate of the item and every later one in its run) and back [back, size())
+ * holds only its total, backAgg. This is the two-stack algorithm with the
+ * stack flip done in place on the deque: the back run is frozen into the
+ * middle one, whose suffix aggregates are computed from its end, and the front
+ * run's suffix aggregates then get the middle's total folded in from the end,
+ * after which front and middle are one run again.
+ *
+ * WorstCase = false flips once the front run is empty, which makes each
+ * operation O(1) amortized. WorstCase = true starts flipping as soon as the
+ * back run outgrows the front one and does three steps of it per operation,
+ * which always finishes before the front run runs out, so each operation
+ * is O(1) in the worst case (this is the idea of DABA, the De-Amortized
+ * Bankers' Aggregator).
+ */
+template < typename T, typename Op = std::plus<T>, bool WorstCase = true, typename A = std::allocator<T> >
+class SlidingWindow {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef A                                        allocator_type;
+        typedef typename allocator_type::value_type      value_type;
+
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::difference_type difference_type;
+
+        typedef const T&                                 const_reference;
+
+    private:
+        /**
+         * an item of the window and, in the front and middle runs, the
+         * aggregate from it to the end of its run
+         */
+        struct Entry {
+            T value;
+            T agg;
+
+            Entry (const T& value, const T& agg) : value(value), agg(agg) {}};
+
+        typedef typename std::allocator_traits<A>::template rebind_alloc<Entry> entry_allocator_type;
+
+        // ----
+        // data
+        // ----
+
+        Deque<Entry, entry_allocator_type> items;
+        Op op;
+        T identity;
+        //runs, as indices into items: front [0, mid), middle [mid, back), back [back, size())
+        size_type mid, back;
+        //a flip in progress: the suffix aggregates of [next, back) are done in the middle
+        //run, then the front run's ones in [next, mid) get midAgg folded in
+        size_type next;
+        bool folding;
+        T midAgg, backAgg;      //totals of the middle and back runs
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        /*
+         * @return true if SlidingWindow is valid
+         */
+        bool valid () const {
+            if(mid > back || back > items.size())
+                return false;
+            if(flipping() && (folding ? next > mid : (next < mid || next > back)))
+                return false;
+            return true;}
+
+        // ----
+        // flip
+        // ----
+
+        /**
+         * @return true if a flip is in progress
+         */
+        bool flipping () const {
+            return mid != back;}
+
+        /**
+         * freezes the back run into the middle one
+         * @pre not flipping
+         */
+        void start_flip () {
+            next    = items.size();
+            back    = items.size();
+            folding = false;
+            midAgg  = backAgg;
+            backAgg = identity;}
+
+        /**
+         * does one step of the flip in progress: one suffix aggregate of the middle
+         * run, or folding midAgg into one of the front run, or joining the two runs
+         */
+        void step () {
+            if(!folding)
+            {
+                next--;
+                items[next].agg = (next + 1 == back) ? items[next].value : op(items[next].value, items[next + 1].agg);
+                if(next == mid)
+                    folding = true;
+                return;
+            }
+
+            if(next == 0)
+            {
+                mid = back; //front and middle are one run now
+                folding = false;
+                return;
+            }
+            next--;
+            items[next].agg = op(items[next].agg, midAgg);}
+
+        /**
+         * helper for push_back and pop_front, starts and advances flips
+         */
+        void fixup () {
+            if(WorstCase)
+            {
+                if(!flipping() && items.size() - back > mid)
+                    start_flip();
+                for(int k = 0; k < 3 && flipping(); k++)
+                    step();
+            }
+            else if(mid == 0 && !flipping() && back != items.size())
+            {
+                start_flip();
+                while(flipping())
+                    step();
+            }}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Constructs an empty window
+         * @param identity the identity of op, the query of an empty window
+         * @param op an associative binary operation on T's
+         */
+        explicit SlidingWindow (const T& identity = T(), const Op& op = Op()) :
+                op(op), identity(identity), mid(0), back(0), next(0), folding(false),
+                midAgg(identity), backAgg(identity) {
+            items.set_incremental_growth(WorstCase); //no map copy in one go either
+            assert(valid());}
+
+        // Default copy, destructor, and copy assignment.
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * empties the window
+         */
+        void clear () {
+            items.clear();
+            mid = back = next = 0;
+            folding = false;
+            midAgg = backAgg = identity;
+            assert(valid());}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return size == 0
+         */
+        bool empty () const {
+            return items.empty();}
+
+        // -----
+        // front
+        // -----
+
+        /**
+         * @return the oldest item of the window
+         * @pre not empty
+         */
+        const_reference front () const {
+            return items.front().value;}
+
+        // ---
+        // pop
+        // ---
+
+        /**
+         * drops the oldest item of the window
+         * @pre not empty
+         */
+        void pop_front () {
+            if(mid == 0 && flipping())      //flips finish before the front run runs out, just in case
+                while(flipping())
+                    step();
+            items.pop_front();
+            mid--;
+            back--;
+            if(next > 0)
+                next--;
+            fixup();
+            assert(valid());}
+
+        // ----
+        // push
+        // ----
+
+        /**
+         * adds item as the newest one of the window
+         * @param item object to be added
+         */
+        void push_back (const_reference item) {
+            backAgg = op(backAgg, item);
+            items.push_back(Entry(item, identity));
+            fixup();
+            assert(valid());}
+
+        // -----
+        // query
+        // -----
+
+        /**
+         * @return the aggregate of the window's items, oldest first; identity if empty
+         */
+        T query () const {
+            if(items.empty())
+                return identity;
+            const T& first = items.front().agg;
+            if(!flipping())
+                return (mid == 0) ? backAgg : op(first, backAgg);
+            if(folding && next == 0)        //every front aggregate already includes the middle
+                return op(first, backAgg);
+            return (mid == 0) ? op(midAgg, backAgg) : op(op(first, midAgg), backAgg);}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return the number of items in the window
+         */
+        size_type size () const {
+            return items.size();}};
+
+#endif // SlidingWindow_h
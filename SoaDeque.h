@@ -0,0 +1,525 @@
+// -------------------------
+// projects/deque/SoaDeque.h
+// Copyright (C) 2010
+// Glenn P. Downing
+// -------------------------
+
+#ifndef SoaDeque_h
+#define SoaDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm>   // fill, min, swap
+#include <cassert>     // assert
+#include <cstddef>     // max_align_t, size_t
+#include <memory>      // allocator
+#include <new>         // placement new
+#include <stdexcept>   // out_of_range
+#include <tuple>       // get, tuple, tuple_element
+#include <type_traits> // aligned_storage
+#include <utility>     // move
+
+// --------
+// SoaDeque
+// --------
+
+/**
+ * A Deque of records with the fields Fields..., stored as a struct of arrays: each
+ * row of the map holds one block per field, so a scan of one field only touches
+ * that field's blocks. The map and the cursors work exactly like Deque's (a ring
+ * of rows, beginRow/beginCol to endRow/endCol with the end EXCLUSIVE), but a row
+ * holds 256 records instead of 10 so that for_each_span hands out long contiguous
+ * runs of one field that a compiler can vectorize.
+ *
+ * Records go in and out whole, at either end; get<K>(i) is field K of record i.
+ */
+template <typename... Fields>
+class SoaDeque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef std::tuple<Fields...> value_type;
+        typedef std::size_t           size_type;
+        typedef std::ptrdiff_t        difference_type;
+
+        /**
+         * the type of field K
+         */
+        template <size_type K>
+        struct field {
+            typedef typename std::tuple_element<K, value_type>::type type;};
+
+        /**
+         * records per row
+         */
+        static const size_type rowSize = 256;
+
+    public:
+        // -----------
+        // operator ==
+        // -----------
+
+        /**
+         * @param lhs the SoaDeque on the left hand side of operator ==
+         * @param rhs the SoaDeque on the right hand side of operator ==
+         * @return true if they are equal false otherwise
+         */
+        friend bool operator == (const SoaDeque& lhs, const SoaDeque& rhs) {
+            if(lhs.size() != rhs.size())
+                return false;
+            for(size_type i = 0; i < lhs.size(); i++)
+                if(lhs[i] != rhs[i])
+                    return false;
+            return true;}
+
+    private:
+        // -------
+        // indices
+        // -------
+
+        template <size_type... Is>
+        struct indices {};
+
+        template <size_type N, size_type... Is>
+        struct make_indices : make_indices<N - 1, N - 1, Is...> {};
+
+        template <size_type... Is>
+        struct make_indices<0, Is...> {
+            typedef indices<Is...> type;};
+
+        typedef typename make_indices<sizeof...(Fields)>::type all_fields;
+
+        /**
+         * rows are allocated in units of the strictest fundamental alignment
+         */
+        typedef typename std::aligned_storage<sizeof(std::max_align_t), alignof(std::max_align_t)>::type Unit;
+
+        // ----
+        // data
+        // ----
+
+        std::allocator<Unit>  unit_a;   //allocator of rows
+        std::allocator<Unit*> outer_a;  //allocator of the map
+        Unit** container;               //our outer container (rows)
+        //end is EXCLUSIVE
+        size_type beginRow, endRow, beginCol, endCol, numRows;
+        size_type offsets[sizeof...(Fields)];   //byte offset of each field's block in a row
+        size_type rowUnits;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        /*
+         * @return true if SoaDeque is valid
+         */
+        bool valid () const {
+            if(beginRow >= numRows || endRow >= numRows || beginCol >= rowSize || endCol >= rowSize)
+                return false;
+            if(beginRow == endRow && beginCol > endCol)
+                return false;
+            return true;}
+
+        // ------
+        // layout
+        // ------
+
+        /**
+         * lays the blocks of the fields out one after the other in a row, each one aligned
+         */
+        void layout () {
+            const size_type sizes[]  = {sizeof(Fields)...};
+            const size_type aligns[] = {alignof(Fields)...};
+            size_type bytes = 0;
+            for(size_type k = 0; k < sizeof...(Fields); k++)
+            {
+                assert(aligns[k] <= alignof(Unit));
+                bytes = (bytes + aligns[k] - 1) / aligns[k] * aligns[k];
+                offsets[k] = bytes;
+                bytes += rowSize * sizes[k];
+            }
+            rowUnits = (bytes + sizeof(Unit) - 1) / sizeof(Unit);}
+
+        /**
+         * @return the block of field K in row
+         */
+        template <size_type K>
+        typename field<K>::type* block (size_type row) const {
+            return reinterpret_cast<typename field<K>::type*>(reinterpret_cast<char*>(container[row]) + offsets[K]);}
+
+        // -----------------
+        // construct/destroy
+        // -----------------
+
+        template <size_type... Is, typename... Args>
+        void construct (size_type row, size_type col, indices<Is...>, Args&&... args) {
+            int dummy[] = {0, (::new (static_cast<void*>(block<Is>(row) + col)) typename field<Is>::type(std::forward<Args>(args)), 0)...};
+            (void)dummy;}
+
+        template <size_type... Is>
+        void construct_tuple (size_type row, size_type col, indices<Is...> is, const value_type& v) {
+            construct(row, col, is, std::get<Is>(v)...);}
+
+        template <size_type... Is>
+        void destroy (size_type row, size_type col, indices<Is...>) {
+            int dummy[] = {0, (destroy_one(block<Is>(row) + col), 0)...};
+            (void)dummy;}
+
+        template <typename F>
+        static void destroy_one (F* p) {
+            p->~F();}
+
+        template <size_type... Is>
+        value_type record (size_type row, size_type col, indices<Is...>) const {
+            return value_type(block<Is>(row)[col]...);}
+
+        // ---
+        // map
+        // ---
+
+        /**
+         * allocates row if it isn't yet
+         */
+        void allocate_row (size_type row) {
+            if(container[row] == 0)
+                container[row] = unit_a.allocate(rowUnits);}
+
+        /**
+         * Helper for push methods to increase capacity by 2x, recentering the rows
+         * (spare ones included) in ring order from beginRow, like Deque::double_capacity
+         */
+        void double_capacity () {
+            size_type newNumRows  = numRows * 2;
+            size_type newBeginRow = newNumRows/2 - numRows/2;
+
+            Unit** containerTmp = outer_a.allocate(newNumRows);
+            std::fill(containerTmp, containerTmp + newNumRows, (Unit*)0);
+            for(size_type i = 0; i < numRows; i++)
+                containerTmp[newBeginRow + i] = container[(beginRow + i) % numRows];
+
+            endRow   = newBeginRow + (endRow + numRows - beginRow) % numRows;
+            beginRow = newBeginRow;
+            outer_a.deallocate(container, numRows);
+            container = containerTmp;
+            numRows   = newNumRows;}
+
+        /**
+         * sets row and col to where the record at index is
+         */
+        void locate (size_type index, size_type& row, size_type& col) const {
+            row = (beginRow + (beginCol + index) / rowSize) % numRows;
+            col = (beginCol + index) % rowSize;}
+
+        /**
+         * steps the end cursors past a new record, growing the map if needed
+         */
+        void advance_end () {
+            endCol = (endCol + 1) % rowSize;
+            if(endCol == 0)
+            {
+                if((endRow + 1) % numRows == beginRow)
+                    double_capacity();
+                endRow = (endRow + 1) % numRows;
+                allocate_row(endRow);
+            }}
+
+        /**
+         * steps the begin cursors in front of the first record, growing the map if needed
+         */
+        void retreat_begin () {
+            if(beginCol == 0)
+            {
+                size_type row = (beginRow + numRows - 1) % numRows;
+                if(row == endRow)
+                {
+                    double_capacity();
+                    row = beginRow - 1;
+                }
+                allocate_row(row);
+                beginRow = row;
+                beginCol = rowSize;
+            }
+            beginCol--;}
+
+        /**
+         * helper for constructors
+         */
+        void init () {
+            layout();
+            numRows = 8;
+            container = outer_a.allocate(numRows);
+            std::fill(container, container + numRows, (Unit*)0);
+            beginRow = endRow = numRows/2;
+            beginCol = endCol = rowSize/2;
+            allocate_row(beginRow);}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Constructs empty SoaDeque
+         */
+        SoaDeque () {
+            init();
+            assert(valid());}
+
+        /**
+         * Copy constructor
+         * @param that SoaDeque to copy
+         */
+        SoaDeque (const SoaDeque& that) {
+            init();
+            for(size_type i = 0; i < that.size(); i++)
+                push_back(that[i]);
+            assert(valid());}
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * Destroys the records and frees the rows
+         */
+        ~SoaDeque () {
+            clear();
+            for(size_type i = 0; i < numRows; i++)
+                if(container[i] != 0)
+                    unit_a.deallocate(container[i], rowUnits);
+            outer_a.deallocate(container, numRows);}
+
+        // ----------
+        // operator =
+        // ----------
+
+        /**
+         * assign rhs to this
+         * @param rhs SoaDeque whose records we'll copy
+         */
+        SoaDeque& operator = (const SoaDeque& rhs) {
+            SoaDeque that(rhs);
+            swap(that);
+            return *this;}
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+         * @return a copy of the record at index
+         * @pre index w/in range [0, size())
+         */
+        value_type operator [] (size_type index) const {
+            size_type row, col;
+            locate(index, row, col);
+            return record(row, col, all_fields());}
+
+        // --
+        // at
+        // --
+
+        /**
+         * @return a copy of the record at index
+         * @throws out_of_range exception if index not in [0, size())
+         */
+        value_type at (size_type index) const {
+            if(index >= size())
+                throw std::out_of_range("SoaDeque::at()");
+            return (*this)[index];}
+
+        // ----
+        // back
+        // ----
+
+        /**
+         * @pre not empty
+         * @return a copy of the last record
+         */
+        value_type back () const {
+            return (*this)[size() - 1];}
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * destroys every record, leaving size = 0
+         */
+        void clear () {
+            while(!empty())
+                pop_back();
+            assert(valid());}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return size == 0
+         */
+        bool empty () const {
+            return !size();}
+
+        // -------------
+        // for_each_span
+        // -------------
+
+        /**
+         * Calls f(p, n) for each run of field K, in order: p points at n consecutive
+         * values of field K, at most rowSize of them, together covering every record.
+         * @param f called as f(field<K>::type*, size_type)
+         */
+        template <size_type K, typename F>
+        void for_each_span (F f) {
+            size_type p = beginRow * rowSize + beginCol;
+            size_type e = p + size();
+            while(p != e)
+            {
+                size_type n = std::min(e - p, rowSize - p % rowSize);
+                f(block<K>((p / rowSize) % numRows) + p % rowSize, n);
+                p += n;
+            }}
+
+        /**
+         * Calls f(p, n) for each run of field K, read only
+         * @param f called as f(const field<K>::type*, size_type)
+         */
+        template <size_type K, typename F>
+        void for_each_span (F f) const {
+            const_cast<SoaDeque*>(this)->template for_each_span<K>(
+                [&] (typename field<K>::type* p, size_type n) {f(static_cast<const typename field<K>::type*>(p), n);});}
+
+        // -----
+        // front
+        // -----
+
+        /**
+         * @pre not empty
+         * @return a copy of the first record
+         */
+        value_type front () const {
+            return (*this)[0];}
+
+        // ---
+        // get
+        // ---
+
+        /**
+         * @return reference to field K of the record at index
+         * @pre index w/in range [0, size())
+         */
+        template <size_type K>
+        typename field<K>::type& get (size_type index) {
+            size_type row, col;
+            locate(index, row, col);
+            return block<K>(row)[col];}
+
+        /**
+         * @return const reference to field K of the record at index
+         * @pre index w/in range [0, size())
+         */
+        template <size_type K>
+        const typename field<K>::type& get (size_type index) const {
+            size_type row, col;
+            locate(index, row, col);
+            return block<K>(row)[col];}
+
+        // ---
+        // pop
+        // ---
+
+        /**
+         * Deletes the record at the back of the container
+         * @pre container not empty
+         */
+        void pop_back () {
+            if(endCol == 0)
+                endRow = (endRow + numRows - 1) % numRows;
+            endCol = (endCol + rowSize - 1) % rowSize;
+            destroy(endRow, endCol, all_fields());
+            assert(valid());}
+
+        /**
+         * Deletes the record at the front of the container.
+         * @pre container not empty
+         */
+        void pop_front () {
+            destroy(beginRow, beginCol, all_fields());
+            beginCol = (beginCol + 1) % rowSize;
+            if(beginCol == 0)
+                beginRow = (beginRow + 1) % numRows;
+            assert(valid());}
+
+        // ----
+        // push
+        // ----
+
+        /**
+         * adds a record to the back of the container
+         * @param fields the values of its fields
+         */
+        void push_back (const Fields&... fields) {
+            construct(endRow, endCol, all_fields(), fields...);
+            advance_end();
+            assert(valid());}
+
+        /**
+         * adds a record to the back of the container
+         * @param record the record
+         */
+        void push_back (const value_type& record) {
+            construct_tuple(endRow, endCol, all_fields(), record);
+            advance_end();
+            assert(valid());}
+
+        /**
+         * adds a record to the front of the container
+         * @param fields the values of its fields
+         */
+        void push_front (const Fields&... fields) {
+            retreat_begin();
+            construct(beginRow, beginCol, all_fields(), fields...);
+            assert(valid());}
+
+        /**
+         * adds a record to the front of the container
+         * @param record the record
+         */
+        void push_front (const value_type& record) {
+            retreat_begin();
+            construct_tuple(beginRow, beginCol, all_fields(), record);
+            assert(valid());}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return the number of records in the deque
+         */
+        size_type size () const {
+            return ((endRow + numRows - beginRow) % numRows) * rowSize + endCol - beginCol;}
+
+        // ----
+        // swap
+        // ----
+
+        /**
+         * @param that SoaDeque to swap underlying data with
+         */
+        void swap (SoaDeque& that) {
+            std::swap(container, that.container);
+            std::swap(beginRow, that.beginRow);
+            std::swap(endRow, that.endRow);
+            std::swap(beginCol, that.beginCol);
+            std::swap(endCol, that.endCol);
+            std::swap(numRows, that.numRows);
+            assert(valid());}};
+
+#endif // SoaDeque_h
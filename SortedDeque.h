@@ -0,0 +1,354 @@
+// ----------------------------
+// projects/deque/SortedDeque.h
+// Copyright (C) 2010
+// Glenn P. Downing
+// ----------------------------
+
+#ifndef SortedDeque_h
+#define SortedDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm>  // min
+#include <cassert>    // assert
+#include <functional> // less
+#include <memory>     // allocator
+#include <utility>    // move, pair
+
+#include "Deque.h"
+
+// -----------
+// SortedDeque
+// -----------
+
+/**
+ * A Deque kept in order, for queues that only take newer items at the back and
+ * expire the oldest at the front, e.g. events by timestamp.
+ *
+ * Item i (counting every item ever pushed) belongs to block i / blockItems; for
+ * each block that still has items, maxima holds its greatest (its last) item.
+ * Searches binary-search maxima for the block a key falls in, then the at most
+ * blockItems items of that block, so they touch O(log blocks) summaries, which
+ * sit blockItems to a cache-friendly run, and O(log blockItems) items, instead of
+ * stepping std::lower_bound through a bidirectional iterator. A block's least
+ * item needs no summary: in order, it follows the previous block's greatest.
+ *
+ * pop_front_while(pred) gallops over maxima from the front to the first block
+ * whose greatest item isn't expired, so dropping k items costs O(log k) probes,
+ * and drops everything before it with one pop_front_n, which frees trivially
+ * destructible items without touching them.
+ *
+ * Positions are indices from the front, as for operator [].
+ */
+template < typename T, typename C = std::less<T>, typename A = std::allocator<T> >
+class SortedDeque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef A                                        allocator_type;
+        typedef C                                        value_compare;
+        typedef typename allocator_type::value_type      value_type;
+
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::difference_type difference_type;
+
+        typedef value_type&                              reference;
+        typedef const value_type&                        const_reference;
+
+        typedef typename Deque<T, A>::const_iterator     const_iterator;
+
+        /**
+         * items per summarized block, the same as a Deque block
+         */
+        static const size_type blockItems = 10;
+
+    private:
+        // ----
+        // data
+        // ----
+
+        value_compare cmp;
+        Deque<T, A> items;
+        Deque<T, A> maxima;     //the greatest item of each block, from the front item's on
+        size_type head;         //items popped so far, the number of the front item
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        /*
+         * @return true if SortedDeque is valid
+         */
+        bool valid () const {
+            if(items.empty())
+                return maxima.empty();
+            return maxima.size() == (head + items.size() - 1)/blockItems - head/blockItems + 1 &&
+                   !cmp(maxima.back(), items.back()) && !cmp(items.back(), maxima.back());}
+
+        /**
+         * @return the index of the first item of block b of maxima, 0 for the front block
+         */
+        size_type block_begin (size_type b) const {
+            return b == 0 ? 0 : (head/blockItems + b)*blockItems - head;}
+
+        /**
+         * @return the first index i in [b, e) for which below(items[i]) is false,
+         * e if there is none
+         * @pre below is true on a prefix of [b, e) and false after it
+         */
+        template <typename P>
+        size_type partition_items (size_type b, size_type e, P below) const {
+            while(b != e)
+            {
+                size_type m = b + (e - b)/2;
+                if(below(items[m]))
+                    b = m + 1;
+                else
+                    e = m;
+            }
+            return b;}
+
+        /**
+         * @return the first index for which below is false, size() if there is none
+         * @param b, e the blocks of maxima it is known to be in
+         * @pre below is true on a prefix of the items and false after it
+         */
+        template <typename P>
+        size_type partition_point (P below, size_type b, size_type e) const {
+            while(b != e)
+            {
+                size_type m = b + (e - b)/2;
+                if(below(maxima[m]))
+                    b = m + 1;
+                else
+                    e = m;
+            }
+            if(b == maxima.size())
+                return items.size();
+            return partition_items(block_begin(b), std::min(block_begin(b + 1), items.size()), below);}
+
+        /**
+         * drops the first n items and the summaries of the blocks they empty
+         */
+        void drop_front (size_type n) {
+            size_type blocks = (head + n)/blockItems - head/blockItems;
+            if(n == items.size())
+                blocks = maxima.size();
+            items.pop_front_n(n);
+            maxima.pop_front_n(blocks);
+            head += n;}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Constructs an empty SortedDeque
+         * @param c the order of the items
+         * @param a allocator to use
+         */
+        explicit SortedDeque (const value_compare& c = value_compare(), const allocator_type& a = allocator_type()) :
+                cmp(c), items(a), maxima(a), head(0) {
+            assert(valid());}
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+         * @return the item at index
+         * @pre index w/in range [0, size())
+         */
+        const_reference operator [] (size_type index) const {
+            return items[index];}
+
+        // ----
+        // back
+        // ----
+
+        /**
+         * @return the greatest item
+         * @pre !empty()
+         */
+        const_reference back () const {
+            return items.back();}
+
+        // -----
+        // begin
+        // -----
+
+        /**
+         * @return const_iterator pointing to the least item
+         */
+        const_iterator begin () const {
+            return items.begin();}
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * Drops every item
+         */
+        void clear () {
+            drop_front(items.size());
+            assert(valid());}
+
+        // -----
+        // count
+        // -----
+
+        /**
+         * @return the number of items in [lo, hi)
+         */
+        size_type count (const_reference lo, const_reference hi) const {
+            if(!cmp(lo, hi))
+                return 0;
+            return lower_bound(hi) - lower_bound(lo);}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return size == 0
+         */
+        bool empty () const {
+            return items.empty();}
+
+        // ---
+        // end
+        // ---
+
+        /**
+         * @return const_iterator pointing to one past the greatest item
+         */
+        const_iterator end () const {
+            return items.end();}
+
+        // -----------
+        // equal_range
+        // -----------
+
+        /**
+         * @return the indices [lower_bound(v), upper_bound(v)) of the items equivalent to v
+         */
+        std::pair<size_type, size_type> equal_range (const_reference v) const {
+            size_type b = lower_bound(v);
+            size_type e = b;
+            if(b != items.size() && !cmp(v, items[b]))
+                e = upper_bound(v);
+            return std::make_pair(b, e);}
+
+        // -----
+        // front
+        // -----
+
+        /**
+         * @return the least item
+         * @pre !empty()
+         */
+        const_reference front () const {
+            return items.front();}
+
+        // -----------
+        // lower_bound
+        // -----------
+
+        /**
+         * @return the index of the first item not less than v, size() if there is none
+         */
+        size_type lower_bound (const_reference v) const {
+            const value_compare& c = cmp;
+            return partition_point([&c, &v] (const_reference x) {return c(x, v);}, 0, maxima.size());}
+
+        // ---
+        // pop
+        // ---
+
+        /**
+         * Drops the least item
+         * @pre !empty()
+         */
+        void pop_front () {
+            assert(!empty());
+            drop_front(1);
+            assert(valid());}
+
+        /**
+         * Drops the items from the front for which pred holds, whole blocks at a time
+         * @param pred true of every item before some point in the order and of none after
+         * @return the number of items dropped
+         */
+        template <typename P>
+        size_type pop_front_while (P pred) {
+            //gallop over the blocks from the front, so that dropping k items costs O(log k)
+            size_type b = 0, e = 1;
+            while(e < maxima.size() && pred(maxima[e - 1]))
+            {
+                b = e;
+                e = std::min(2*e + 1, maxima.size());
+            }
+            size_type n = partition_point([&pred] (const_reference x) {return bool(pred(x));}, b, std::min(e, maxima.size()));
+            drop_front(n);
+            assert(valid());
+            return n;}
+
+        // ----
+        // push
+        // ----
+
+        /**
+         * Adds v at the back
+         * @pre empty() or v is not less than back()
+         */
+        void push_back (const_reference v) {
+            assert(empty() || !cmp(v, back()));
+            if(empty() || (head + items.size()) % blockItems == 0)
+                maxima.push_back(v);
+            else
+                maxima.back() = v;
+            items.push_back(v);
+            assert(valid());}
+
+        /**
+         * Adds v at the back
+         * @pre empty() or v is not less than back()
+         */
+        void push_back (value_type&& v) {
+            assert(empty() || !cmp(v, back()));
+            if(empty() || (head + items.size()) % blockItems == 0)
+                maxima.push_back(v);
+            else
+                maxima.back() = v;
+            items.push_back(std::move(v));
+            assert(valid());}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return the number of items
+         */
+        size_type size () const {
+            return items.size();}
+
+        // -----------
+        // upper_bound
+        // -----------
+
+        /**
+         * @return the index of the first item greater than v, size() if there is none
+         */
+        size_type upper_bound (const_reference v) const {
+            const value_compare& c = cmp;
+            return partition_point([&c, &v] (const_reference x) {return !c(v, x);}, 0, maxima.size());}};
+
+#endif // SortedDeque_h
@@ -0,0 +1,652 @@
+// ---------------------------
+// projects/deque/SpillDeque.h
+// Copyright (C) 2010
+// Glenn P. Downing
+// ---------------------------
+
+#ifndef SpillDeque_h
+#define SpillDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm>          // find, max, min
+#include <cassert>            // assert
+#include <cerrno>             // errno
+#include <condition_variable> // condition_variable
+#include <cstdlib>            // mkstemp
+#include <memory>             // allocator, allocator_traits
+#include <mutex>              // mutex, unique_lock
+#include <string>             // string
+#include <system_error>       // system_error, system_category
+#include <thread>             // thread
+#include <type_traits>        // is_trivially_copyable
+#include <vector>             // vector
+
+#include <sys/types.h> // off_t
+#include <unistd.h>    // close, pread, pwrite, unlink
+
+#include "Deque.h"
+
+// ----------
+// SpillDeque
+// ----------
+
+/**
+ * A Deque for backlogs that may outgrow memory: under a memory budget, the
+ * interior rows are written to a spill file and read back before they are needed.
+ *
+ * Rows of rowItems records hang off a map, a Deque of Row, as in Deque. The map
+ * is split into a front window [0, f), a middle [f, b) and a back window [b, n).
+ * The windows are in memory; the middle rows are in the file, or on their way.
+ * When a new row takes the rows in memory over the budget, the row at b (or f - 1,
+ * when the back window is down to the row being pushed into) moves to the middle:
+ * a background I/O thread writes it to the file and then its memory is freed.
+ * Popping keeps the front window prefetchRows + 1 rows deep by handing the
+ * middle's first rows to the I/O thread to read back, so a FIFO consumer finds
+ * its rows in memory. Pushes and pops at the ends touch only the end rows;
+ * the map and the I/O thread's queues are only visited at row boundaries.
+ *
+ * Only the owning thread touches the map; the I/O thread just runs the jobs it is
+ * given and hands them back, so only its two job queues are locked. The spill
+ * file is unlinked as soon as it is created; a crash leaves nothing behind. An I/O
+ * error is thrown as system_error by the next operation that crosses a row, and
+ * by every one after it: a row whose write failed stays in memory, but a row
+ * whose read failed holds garbage, so after an error a SpillDeque can only be
+ * cleared or destroyed.
+ */
+template < typename T, typename A = std::allocator<T> >
+class SpillDeque {
+    static_assert(std::is_trivially_copyable<T>::value, "SpillDeque records are written to disk as bytes");
+
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef A                                        allocator_type;
+        typedef typename allocator_type::value_type      value_type;
+
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::difference_type difference_type;
+
+        typedef value_type&                              reference;
+        typedef const value_type&                        const_reference;
+
+        /**
+         * rows the front window keeps beyond the one being popped
+         */
+        static const size_type prefetchRows = 3;
+
+        /**
+         * spills the I/O thread may have in flight before a push waits for them
+         */
+        static const size_type maxWrites = 8;
+
+    private:
+        enum State {resident, spilling, spilled, loading};
+
+        /**
+         * a row of the map: its records when in memory, its place in the file
+         * once written, and where it is on the way between the two
+         */
+        struct Row {
+            T* items;
+            off_t offset;   //-1 until first written
+            State state;
+            bool writing;}; //a write of items is in flight
+
+        /**
+         * a row handed to the I/O thread
+         */
+        struct Job {
+            size_type id;   //firstId + index of the row; a row keeps its id while it lives
+            T* items;
+            off_t offset;
+            bool write;
+            int error;};    //errno of a failed write or read, 0 if it succeeded
+
+        // ----
+        // data
+        // ----
+
+        allocator_type a;
+        size_type rowItems;         //records per row
+        size_type budgetRows;       //rows allowed in memory
+        Deque<Row> rows;            //the map
+        size_type firstId;          //id of rows[0], modulo size_type; ids don't change as rows come and go
+        size_type f, b;             //the front window, middle and back window
+        size_type beginCol, endCol; //first record of rows[0], one past the last of the last row
+        size_type mysize;
+        T* frontItems;              //rows.front().items
+        T* backItems;               //rows.back().items
+        size_type live;             //buffers allocated, rows in memory and on their way
+        size_type writes;           //writes in flight
+        std::vector<T*> spare;      //one freed buffer kept for the next row
+        std::vector<T*> orphans;    //buffers of removed rows whose writes are in flight
+        std::vector<off_t> freeSlots;
+        off_t fileEnd;
+        int fd;
+
+        std::mutex m;
+        std::condition_variable wake;   //jobs for the I/O thread, or stop
+        std::condition_variable done;   //jobs back from it
+        Deque<Job> todo, finished;
+        int ioError;
+        bool stop;
+        std::thread io;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        /*
+         * @return true if SpillDeque is valid
+         */
+        bool valid () const {
+            return f <= b && b <= rows.size() && (mysize != 0 || rows.empty()) && beginCol <= rowItems && endCol <= rowItems;}
+
+        // -------
+        // buffers
+        // -------
+
+        T* new_buffer () {
+            ++live;
+            if(!spare.empty())
+            {
+                T* p = spare.back();
+                spare.pop_back();
+                return p;
+            }
+            return std::allocator_traits<A>::allocate(a, rowItems);}
+
+        void free_buffer (T* p) {
+            --live;
+            if(spare.empty())
+                spare.push_back(p);
+            else
+                std::allocator_traits<A>::deallocate(a, p, rowItems);}
+
+        /**
+         * @return the file offset of a free row-sized slot
+         */
+        off_t new_slot () {
+            if(!freeSlots.empty())
+            {
+                off_t s = freeSlots.back();
+                freeSlots.pop_back();
+                return s;
+            }
+            off_t s = fileEnd;
+            fileEnd += rowItems * sizeof(T);
+            return s;}
+
+        // --
+        // io
+        // --
+
+        /**
+         * the I/O thread: runs the jobs, in order, until stopped
+         */
+        void run () {
+            std::unique_lock<std::mutex> lock(m);
+            for(;;)
+            {
+                wake.wait(lock, [this] () {return stop || !todo.empty();});
+                if(todo.empty())
+                    return;
+                Job j = todo.front();
+                todo.pop_front();
+                lock.unlock();
+
+                char* p = reinterpret_cast<char*>(j.items);
+                size_type n = rowItems * sizeof(T);
+                int error = 0;
+                for(size_type k = 0; k < n && error == 0; )
+                {
+                    ssize_t r = j.write ? ::pwrite(fd, p + k, n - k, j.offset + k) : ::pread(fd, p + k, n - k, j.offset + k);
+                    if(r > 0)
+                        k += r;
+                    else if(r == 0 || errno != EINTR)
+                        error = r == 0 ? EIO : errno;
+                }
+
+                lock.lock();
+                if(error != 0 && ioError == 0)
+                    ioError = error;
+                j.error = error;
+                finished.push_back(j);
+                done.notify_one();
+            }}
+
+        /**
+         * hands row k to the I/O thread, to write when write and to read otherwise
+         */
+        void submit (size_type k, bool write) {
+            Row& r = rows[k];
+            Job j = {firstId + k, r.items, r.offset, write, 0};
+            std::lock_guard<std::mutex> lock(m);
+            todo.push_back(j);
+            wake.notify_one();}
+
+        /**
+         * applies the jobs the I/O thread has finished, waiting for one first if wait
+         * @return the first I/O error, 0 if there has been none
+         */
+        int collect (bool wait) {
+            Deque<Job> jobs;
+            int error;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                if(wait)
+                    done.wait(lock, [this] () {return !finished.empty();});
+                jobs.swap(finished);
+                error = ioError;
+            }
+            //apply every job, failed or not, so writes and loading rows always settle
+            for(size_type i = 0; i < jobs.size(); i++)
+            {
+                const Job& j = jobs[i];
+                if(j.write)
+                {
+                    --writes;
+                    typename std::vector<T*>::iterator o = std::find(orphans.begin(), orphans.end(), j.items);
+                    if(o != orphans.end())
+                    {
+                        orphans.erase(o);
+                        free_buffer(j.items);
+                        continue;
+                    }
+                    Row& r = rows[j.id - firstId];
+                    r.writing = false;
+                    if(r.state == spilling && j.error != 0)
+                        r.state = resident;     //not in the file: keep it in memory
+                    else if(r.state == spilling)
+                    {
+                        free_buffer(r.items);
+                        r.items = 0;
+                        r.state = spilled;
+                    }
+                }
+                else
+                    rows[j.id - firstId].state = resident;
+            }
+            return error;}
+
+        /**
+         * applies the jobs the I/O thread has finished, waiting for one first if wait
+         * @throws system_error if an I/O error has happened
+         */
+        void reap (bool wait = false) {
+            int error = collect(wait);
+            if(error != 0)
+                throw std::system_error(error, std::system_category(), "SpillDeque spill file");}
+
+        // ------
+        // policy
+        // ------
+
+        /**
+         * moves row k out of memory
+         */
+        void spill (size_type k) {
+            Row& r = rows[k];
+            if(r.offset < 0)
+                r.offset = new_slot();
+            r.state   = spilling;
+            r.writing = true;
+            ++writes;
+            submit(k, true);}
+
+        /**
+         * spills rows until the rows in memory, not counting those on their way out,
+         * fit the budget
+         */
+        void enforce () {
+            if(f == b)
+            {
+                //nothing spilled: give the front window its rows first
+                while(b < prefetchRows + 1 && b + 1 < rows.size())
+                    ++b;
+                f = b;
+            }
+            while(live - writes > budgetRows)
+            {
+                if(b + 1 < rows.size() && rows[b].state == resident && !rows[b].writing)
+                    spill(b++);
+                else if(f > prefetchRows + 1 && rows[f - 1].state == resident && !rows[f - 1].writing)
+                    spill(--f);
+                else
+                    break;
+            }
+            while(writes > maxWrites)
+                reap(true);}
+
+        /**
+         * brings the middle's first rows into the front window
+         */
+        void prefetch () {
+            while(f < b && f < prefetchRows + 1)
+            {
+                Row& r = rows[f];
+                if(r.state == spilling || r.state == resident)
+                    r.state = resident;     //still in memory: keep it, its write finishes on its own
+                else
+                {
+                    r.items = new_buffer();
+                    r.state = loading;
+                    submit(f, false);
+                }
+                ++f;
+            }}
+
+        /**
+         * makes sure rows[0] is in memory
+         */
+        void ensure_front () {
+            reap();
+            prefetch();
+            while(rows.front().state == loading)
+                reap(true);
+            frontItems = rows.front().items;
+            backItems  = rows.back().items;}
+
+        /**
+         * makes sure the last row is in memory, reading it back at once if need be
+         */
+        void ensure_back () {
+            reap();
+            size_type k = rows.size() - 1;
+            if(b > k)
+            {
+                Row& r = rows[k];
+                if(r.state == spilling)
+                    r.state = resident;
+                else if(r.state == spilled)
+                {
+                    r.items = new_buffer();
+                    r.state = loading;
+                    submit(k, false);
+                }
+                b = k;
+                f = std::min(f, b);
+            }
+            while(rows.back().state == loading)
+                reap(true);
+            frontItems = rows.front().items;
+            backItems  = rows.back().items;}
+
+        /**
+         * gives up row k's buffer (once its write finishes, if one is in flight) and file slot
+         */
+        void release (size_type k) {
+            Row& r = rows[k];
+            if(r.writing)
+                orphans.push_back(r.items);
+            else if(r.items != 0)
+                free_buffer(r.items);
+            if(r.offset >= 0)
+                freeSlots.push_back(r.offset);}
+
+        /**
+         * removes every row, even after an I/O error
+         */
+        void release_all () {
+            for(size_type k = 0; k < rows.size(); k++)
+            {
+                while(rows[k].state == loading)
+                    collect(true);
+                release(k);
+            }
+            rows.clear();
+            f = b = beginCol = endCol = mysize = 0;}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Constructs an empty SpillDeque
+         * @param budget the bytes of records to keep in memory, at least prefetchRows + 2 rows' worth
+         * @param directory where to put the spill file
+         * @param rowBytes the bytes per row, rounded down to whole records
+         * @param a allocator to use
+         * @throws system_error if the spill file can't be created
+         */
+        explicit SpillDeque (size_type budget, const std::string& directory = "/tmp", size_type rowBytes = 1 << 20,
+                             const allocator_type& a = allocator_type()) :
+                a(a), rowItems(std::max<size_type>(1, rowBytes / sizeof(T))),
+                budgetRows(std::max<size_type>(prefetchRows + 2, budget / (rowItems * sizeof(T)))),
+                firstId(0), f(0), b(0), beginCol(0), endCol(0), mysize(0), frontItems(0), backItems(0),
+                live(0), writes(0), fileEnd(0), fd(-1), ioError(0), stop(false) {
+            std::string path = directory + "/SpillDeque-XXXXXX";
+            std::vector<char> name(path.begin(), path.end());
+            name.push_back('\0');
+            fd = ::mkstemp(&name[0]);
+            if(fd < 0)
+                throw std::system_error(errno, std::system_category(), "SpillDeque mkstemp");
+            ::unlink(&name[0]);
+            io = std::thread(&SpillDeque::run, this);
+            assert(valid());}
+
+        SpillDeque (const SpillDeque&) = delete;
+        SpillDeque& operator = (const SpillDeque&) = delete;
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * Stops the I/O thread, frees the rows and closes the spill file
+         */
+        ~SpillDeque () {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                stop = true;
+                wake.notify_one();
+            }
+            io.join();
+            collect(false);     //the I/O thread ran every job before it stopped: none is left to wait for
+            assert(writes == 0 && orphans.empty());
+            for(size_type k = 0; k < rows.size(); k++)
+                if(rows[k].items != 0)
+                    std::allocator_traits<A>::deallocate(a, rows[k].items, rowItems);
+            for(size_type i = 0; i < spare.size(); i++)
+                std::allocator_traits<A>::deallocate(a, spare[i], rowItems);
+            ::close(fd);}
+
+        // ----
+        // back
+        // ----
+
+        /**
+         * @pre not empty
+         * @return a reference to the last record
+         */
+        reference back () {
+            return backItems[endCol - 1];}
+
+        /**
+         * @pre not empty
+         * @return a const reference to the last record
+         */
+        const_reference back () const {
+            return backItems[endCol - 1];}
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * removes every record, emptying the spill file
+         */
+        void clear () {
+            release_all();
+            assert(valid());}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return size == 0
+         */
+        bool empty () const {
+            return !size();}
+
+        // -----
+        // front
+        // -----
+
+        /**
+         * @pre not empty
+         * @return a reference to the first record
+         */
+        reference front () {
+            return frontItems[beginCol];}
+
+        /**
+         * @pre not empty
+         * @return a const reference to the first record
+         */
+        const_reference front () const {
+            return frontItems[beginCol];}
+
+        // ---
+        // pop
+        // ---
+
+        /**
+         * Deletes the record at the back of the container, reading the last row back
+         * at once if it was spilled
+         * @pre container not empty
+         */
+        void pop_back () {
+            --endCol;
+            if(--mysize == 0)
+                release_all();
+            else if(endCol == 0)
+            {
+                release(rows.size() - 1);
+                rows.pop_back();
+                f = std::min(f, rows.size());
+                b = std::min(b, rows.size());
+                endCol = rowItems;
+                ensure_back();
+            }
+            assert(valid());}
+
+        /**
+         * Deletes the record at the front of the container
+         * @pre container not empty
+         */
+        void pop_front () {
+            ++beginCol;
+            if(--mysize == 0)
+                release_all();
+            else if(beginCol == rowItems)
+            {
+                release(0);
+                rows.pop_front();
+                ++firstId;
+                f = f ? f - 1 : 0;
+                b = b ? b - 1 : 0;
+                beginCol = 0;
+                ensure_front();
+            }
+            assert(valid());}
+
+        // ----
+        // push
+        // ----
+
+        /**
+         * adds item to the back of the container, spilling an interior row when
+         * a new row takes it over the budget
+         * @param item object to be added
+         */
+        void push_back (const_reference item) {
+            if(rows.empty() || endCol == rowItems)
+            {
+                reap();
+                Row r = {new_buffer(), -1, resident, false};
+                rows.push_back(r);
+                if(rows.size() == 1)
+                    frontItems = r.items;
+                backItems = r.items;
+                beginCol = rows.size() == 1 ? 0 : beginCol;
+                endCol = 0;
+                enforce();
+            }
+            backItems[endCol++] = item;
+            ++mysize;
+            assert(valid());}
+
+        /**
+         * adds item to the front of the container, spilling an interior row when
+         * a new row takes it over the budget
+         * @param item object to be added
+         */
+        void push_front (const_reference item) {
+            if(rows.empty() || beginCol == 0)
+            {
+                reap();
+                Row r = {new_buffer(), -1, resident, false};
+                bool first = rows.empty();
+                rows.push_front(r);
+                --firstId;
+                if(first)
+                {
+                    backItems = r.items;
+                    endCol = rowItems;
+                }
+                else
+                {
+                    ++f;
+                    ++b;
+                }
+                frontItems = r.items;
+                beginCol = rowItems;
+                enforce();
+            }
+            frontItems[--beginCol] = item;
+            ++mysize;
+            assert(valid());}
+
+        // --------------
+        // resident_bytes
+        // --------------
+
+        /**
+         * @return the bytes of rows in memory, including rows on their way to or from the file
+         */
+        size_type resident_bytes () const {
+            return live * rowItems * sizeof(T);}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return the number of records
+         */
+        size_type size () const {
+            return mysize;}
+
+        // -------------
+        // spilled_bytes
+        // -------------
+
+        /**
+         * @return the bytes of records only in the spill file
+         */
+        size_type spilled_bytes () const {
+            size_type n = 0;
+            for(size_type k = f; k < b; k++)
+                n += rows[k].state == spilled;
+            return n * rowItems * sizeof(T);}};
+
+#endif // SpillDeque_h
@@ -0,0 +1,166 @@
+// ---------------------------------------
+// projects/deque/TestAlignedAllocator.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// ---------------------------------------
+
+/*
+To test the program:
+    % g++ -std=c++11 -pedantic -pthread -lcppunit -ldl -Wall TestAlignedAllocator.c++ -o TestAlignedAllocator.app
+    % valgrind TestAlignedAllocator.app >& TestAlignedAllocator.out
+*/
+
+// --------
+// includes
+// --------
+
+#include <atomic>      // atomic
+#include <cstdint>     // uintptr_t
+#include <memory>      // allocator
+#include <thread>      // thread
+#include <type_traits> // is_same
+#include <vector>      // vector
+
+#include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
+#include "cppunit/TestFixture.h"             // TestFixture
+#include "cppunit/TestSuite.h"               // TestSuite
+#include "cppunit/TextTestRunner.h"          // TestRunner
+
+#include "AlignedAllocator.h"
+#include "Deque.h"
+
+// ----
+// Vec8
+// ----
+
+/**
+ * eight floats, as a 256-bit SIMD register holds them
+ */
+struct alignas(32) Vec8 {
+    float v[8];
+
+    explicit Vec8 (float f = 0) {
+        for(int i = 0; i < 8; i++)
+            v[i] = f + i;}};
+
+// --------------------
+// TestAlignedAllocator
+// --------------------
+
+struct TestAlignedAllocator : CppUnit::TestFixture {
+    static std::uintptr_t address (const void* p) {
+        return reinterpret_cast<std::uintptr_t>(p);}
+
+    /**
+     * @return true if every item of x, and the start of every full block, is
+     * aligned as asked
+     */
+    template <typename C>
+    static bool aligned (const C& x, std::size_t item, std::size_t block) {
+        bool ok = true;
+        for(std::size_t i = 0; i < x.size(); i++)
+            ok = ok && address(&x[i]) % item == 0;
+        x.for_each_span([&ok, block] (const typename C::value_type* p, std::size_t n) {
+            ok = ok && (n != 10 || address(p) % block == 0);});
+        return ok;}
+
+    // -----------------
+    // test_over_aligned
+    // -----------------
+
+    void test_over_aligned () {
+        Deque<Vec8> x;
+        for(int i = 0; i < 500; i++)
+        {
+            x.push_back(Vec8(i));
+            if(i % 3 == 0)
+                x.push_front(Vec8(-i));
+        }
+        CPPUNIT_ASSERT(aligned(x, 32, 32));
+        CPPUNIT_ASSERT(x.back().v[7] == 499 + 7 && x.front().v[0] == -498);
+
+        #if !defined(__cpp_aligned_new)
+        CPPUNIT_ASSERT((std::is_same<Deque<Vec8>::allocator_type, AlignedAllocator<Vec8> >::value));
+        #endif
+        CPPUNIT_ASSERT((std::is_same<Deque<int>::allocator_type, std::allocator<int> >::value));
+    }
+
+    // --------------
+    // test_cacheline
+    // --------------
+
+    void test_cacheline () {
+        typedef AlignedAllocator<int, Alignment::cacheLine> allocator_type;
+        Deque<int, allocator_type> x;
+        for(int i = 0; i < 1000; i++)
+            x.push_back(i);
+        x.shrink_to_fit();
+        CPPUNIT_ASSERT(aligned(x, alignof(int), 64) && x[999] == 999);
+
+        Deque<int, AlignedAllocator<int, Alignment::page> > y;
+        for(int i = 0; i < 100; i++)
+            y.push_front(i);
+        CPPUNIT_ASSERT(aligned(y, alignof(int), 4096) && y[0] == 99);
+
+        allocator_type::rebind<char>::other a;
+        char* p = a.allocate(3);
+        CPPUNIT_ASSERT(address(p) % 64 == 0 && a == allocator_type());
+        a.deallocate(p, 3);
+        CPPUNIT_ASSERT(allocator_type::alignment == 64 && AlignedAllocator<Vec8>::alignment == 32);
+    }
+
+    // -----------
+    // test_padded
+    // -----------
+
+    void test_padded () {
+        CPPUNIT_ASSERT(sizeof(Padded<int>) == 64 && alignof(Padded<int>) == 64);
+        CPPUNIT_ASSERT(sizeof(Padded<Vec8, 128>) == 128);
+
+        const int threads = 4, n = 20000;
+        Deque< Padded< std::atomic<long> > > x;
+        x.emplace_back_n(threads * 3, 0L);
+        CPPUNIT_ASSERT(aligned(x, 64, 64));
+        std::vector<std::thread> t;
+        for(int k = 0; k < threads; k++)
+            t.push_back(std::thread([&x, k, threads] () {   // thread k owns slots k, k + threads, ...
+                for(int i = 0; i < n; i++)
+                    for(std::size_t s = k; s < x.size(); s += threads)
+                        x[s].get().fetch_add(1, std::memory_order_relaxed);}));
+        for(int k = 0; k < threads; k++)
+            t[k].join();
+        bool all = true;
+        for(std::size_t s = 0; s < x.size(); s++)
+            all = all && x[s].get() == n;
+        CPPUNIT_ASSERT(all);
+
+        Padded<int> p(7), q(p);
+        q.get() += 1;
+        CPPUNIT_ASSERT(p.value == 7 && q.value == 8);
+    }
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestAlignedAllocator);
+    CPPUNIT_TEST(test_over_aligned);
+    CPPUNIT_TEST(test_cacheline);
+    CPPUNIT_TEST(test_padded);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    ios_base::sync_with_stdio(false);  // turn off synchronization with C I/O
+    cout << "TestAlignedAllocator.c++" << endl;
+
+    CppUnit::TextTestRunner tr;
+    tr.addTest(TestAlignedAllocator::suite());
+    tr.run();
+
+    cout << "Done." << endl;
+    return 0;}
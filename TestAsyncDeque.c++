@@ -0,0 +1,329 @@
+// ---------------------------------
+// projects/deque/TestAsyncDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// ---------------------------------
+
+/*
+To test the program:
+    % g++ -std=c++20 -pedantic -pthread -lcppunit -ldl -Wall TestAsyncDeque.c++ -o TestAsyncDeque.app
+    % valgrind TestAsyncDeque.app >& TestAsyncDeque.out
+*/
+
+// --------
+// includes
+// --------
+
+#include <condition_variable> // condition_variable
+#include <coroutine>          // coroutine_handle, suspend_never
+#include <deque>              // deque
+#include <exception>          // terminate
+#include <mutex>              // mutex, unique_lock
+#include <string>             // string
+#include <thread>             // thread
+#include <vector>             // vector
+
+#include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
+#include "cppunit/TestFixture.h"             // TestFixture
+#include "cppunit/TestSuite.h"               // TestSuite
+#include "cppunit/TextTestRunner.h"          // TestRunner
+
+#include "AsyncDeque.h"
+
+// --------
+// Detached
+// --------
+
+/**
+ * a coroutine nobody waits for: it starts at once and frees itself when done
+ */
+struct Detached {
+    struct promise_type {
+        Detached get_return_object () {
+            return Detached();}
+
+        std::suspend_never initial_suspend () {
+            return std::suspend_never();}
+
+        std::suspend_never final_suspend () noexcept {
+            return std::suspend_never();}
+
+        void return_void () {}
+
+        void unhandled_exception () {
+            std::terminate();}};};
+
+// ----
+// Loop
+// ----
+
+/**
+ * a thread running the coroutines posted to it, in order
+ */
+class Loop {
+    private:
+        std::mutex m;
+        std::condition_variable c;
+        std::deque< std::coroutine_handle<> > q;
+        bool stop;
+        std::thread t;
+
+        void run () {
+            std::unique_lock<std::mutex> lock(m);
+            for(;;)
+            {
+                c.wait(lock, [this] () {return stop || !q.empty();});
+                if(q.empty())
+                    return;
+                std::coroutine_handle<> h = q.front();
+                q.pop_front();
+                lock.unlock();
+                h.resume();
+                lock.lock();
+            }}
+
+    public:
+        Loop () :
+                stop(false), t(&Loop::run, this) {}
+
+        ~Loop () {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                stop = true;
+            }
+            c.notify_one();
+            t.join();}
+
+        void post (std::coroutine_handle<> h) {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                q.push_back(h);
+            }
+            c.notify_one();}
+
+        /**
+         * @return an executor posting to this loop
+         */
+        AsyncDeque<int>::executor_type executor () {
+            return [this] (std::coroutine_handle<> h) {post(h);};}
+
+        /**
+         * resumes the calling coroutine on this loop
+         */
+        auto schedule () {
+            struct Awaiter {
+                Loop* loop;
+                bool await_ready () const {return false;}
+                void await_suspend (std::coroutine_handle<> h) {loop->post(h);}
+                void await_resume () const {}};
+            return Awaiter{this};}};
+
+// --------------
+// TestAsyncDeque
+// --------------
+
+struct TestAsyncDeque : CppUnit::TestFixture {
+    typedef AsyncDeque<int> channel;
+
+    /**
+     * pops n items (or until closed) into out
+     */
+    static Detached consume (channel& q, int n, std::vector<int>& out) {
+        for(int i = 0; i < n; i++)
+        {
+            std::optional<int> v = co_await q.pop_front();
+            if(!v)
+            {
+                out.push_back(-1);
+                co_return;
+            }
+            out.push_back(*v);
+        }}
+
+    /**
+     * pushes first, first + 1, ..., first + n - 1, counting them into done
+     */
+    static Detached produce (channel& q, int first, int n, int& done) {
+        for(int i = 0; i < n; i++)
+            if(co_await q.push_back(first + i))
+                ++done;}
+
+    // --------
+    // test_try
+    // --------
+
+    void test_try () {
+        channel x(2);
+        CPPUNIT_ASSERT(x.empty() && x.capacity() == 2 && !x.try_pop_front());
+        CPPUNIT_ASSERT(x.try_push_back(1) && x.try_push_back(2) && !x.try_push_back(3));
+        CPPUNIT_ASSERT(x.size() == 2 && *x.try_pop_front() == 1);
+        int v[] = {7, 8, 9};
+        CPPUNIT_ASSERT(x.try_push_back(v, v + 3) == 1 && x.size() == 2);
+        x.close();
+        CPPUNIT_ASSERT(x.closed() && !x.try_push_back(4));
+        CPPUNIT_ASSERT(*x.try_pop_front() == 2 && *x.try_pop_front() == 7 && !x.try_pop_front());
+
+        AsyncDeque<std::string> y;
+        y.try_push_back(std::string(100, 'a'));
+        CPPUNIT_ASSERT(y.try_pop_front()->size() == 100);
+    }
+
+    // --------
+    // test_pop
+    // --------
+
+    void test_pop () {
+        channel x;
+        std::vector<int> a, b;
+        consume(x, 2, a);                       // suspends at once
+        consume(x, 2, b);
+        CPPUNIT_ASSERT(a.empty() && b.empty());
+        for(int i = 0; i < 4; i++)
+            x.try_push_back(i);                 // resumes the oldest waiter inline
+        CPPUNIT_ASSERT(a == std::vector<int>({0, 2}) && b == std::vector<int>({1, 3}) && x.empty());
+        x.try_push_back(5);
+        std::vector<int> c;
+        consume(x, 1, c);                       // doesn't suspend
+        CPPUNIT_ASSERT(c == std::vector<int>({5}));
+    }
+
+    // ---------
+    // test_push
+    // ---------
+
+    void test_push () {
+        channel x(2);
+        int p = 0, q = 0;
+        produce(x, 0, 4, p);                    // two in, suspends on the third
+        produce(x, 10, 2, q);
+        CPPUNIT_ASSERT(p == 2 && q == 0 && x.size() == 2);
+        std::vector<int> out;
+        for(int i = 0; i < 6; i++)
+            out.push_back(*x.try_pop_front());  // each pop lets the oldest waiting producer in
+        CPPUNIT_ASSERT(out == std::vector<int>({0, 1, 2, 10, 3, 11}) && p == 4 && q == 2);
+    }
+
+    // ----------
+    // test_close
+    // ----------
+
+    void test_close () {
+        channel x(1);
+        std::vector<int> a;
+        consume(x, 1, a);
+        x.close();
+        CPPUNIT_ASSERT(a == std::vector<int>({-1}));
+
+        channel y(1);
+        int p = 0;
+        produce(y, 0, 3, p);
+        CPPUNIT_ASSERT(p == 1);
+        y.close();
+        CPPUNIT_ASSERT(p == 1 && *y.try_pop_front() == 0 && !y.try_pop_front());
+    }
+
+    // ----------
+    // test_batch
+    // ----------
+
+    void test_batch () {
+        std::vector< std::coroutine_handle<> > posted;
+        channel x(0, [&] (std::coroutine_handle<> h) {posted.push_back(h);});
+        std::vector<int> a, b, c;
+        consume(x, 1, a);
+        consume(x, 1, b);
+        consume(x, 1, c);
+        int v[] = {1, 2, 3, 4};
+        CPPUNIT_ASSERT(x.try_push_back(v, v + 4) == 4 && x.size() == 1);
+        CPPUNIT_ASSERT(posted.size() == 3 && a.empty());  // handed to the executor, not resumed
+        for(std::size_t i = 0; i < posted.size(); i++)
+            posted[i].resume();
+        CPPUNIT_ASSERT(a == std::vector<int>({1}) && b == std::vector<int>({2}) && c == std::vector<int>({3}));
+    }
+
+    // ------------
+    // test_threads
+    // ------------
+
+    /**
+     * on loop, pops from in and pushes one more to out, n times; the last
+     * value popped goes in last
+     */
+    static Detached player (Loop& loop, channel& in, channel& out, int n, int& last, std::mutex& m,
+                            std::condition_variable& done) {
+        co_await loop.schedule();
+        int v = 0;
+        for(int i = 0; i < n; i++)
+        {
+            v = *co_await in.pop_front();
+            co_await out.push_back(v + 1);
+        }
+        std::lock_guard<std::mutex> lock(m);
+        last = v;
+        done.notify_one();}
+
+    void test_threads () {
+        const int n = 20000;
+        Loop one, two;
+        channel ping(4, two.executor()), pong(4, one.executor());
+        std::mutex m;
+        std::condition_variable done;
+        int a = 0, b = 0;
+        std::unique_lock<std::mutex> lock(m);
+        player(one, pong, ping, n, a, m, done);
+        player(two, ping, pong, n, b, m, done);
+        ping.try_push_back(0);
+        done.wait(lock, [&] () {return a == 2 * n - 1 && b == 2 * n - 2;});
+        lock.unlock();
+        CPPUNIT_ASSERT(*ping.try_pop_front() == 2 * n && pong.empty());
+
+        const int producers = 4;
+        channel x(16);
+        std::vector<std::thread> threads;
+        for(int p = 0; p < producers; p++)
+            threads.push_back(std::thread([&x, p] () {
+                for(int i = 0; i < n; i++)
+                    while(!x.try_push_back(p * n + i))
+                        std::this_thread::yield();}));
+        std::vector<int> next(producers, 0);
+        bool ordered = true;
+        for(int i = 0; i < producers * n; i++)
+        {
+            std::optional<int> v;
+            while(!(v = x.try_pop_front()))
+                std::this_thread::yield();
+            ordered = ordered && *v % n == next[*v / n]++;
+        }
+        for(int p = 0; p < producers; p++)
+            threads[p].join();
+        CPPUNIT_ASSERT(ordered && x.empty());
+    }
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestAsyncDeque);
+    CPPUNIT_TEST(test_try);
+    CPPUNIT_TEST(test_pop);
+    CPPUNIT_TEST(test_push);
+    CPPUNIT_TEST(test_close);
+    CPPUNIT_TEST(test_batch);
+    CPPUNIT_TEST(test_threads);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    ios_base::sync_with_stdio(false);  // turn off synchronization with C I/O
+    cout << "TestAsyncDeque.c++" << endl;
+
+    CppUnit::TextTestRunner tr;
+    tr.addTest(TestAsyncDeque::suite());
+    tr.run();
+
+    cout << "Done." << endl;
+    return 0;}
@@ -0,0 +1,308 @@
+// -------------------------------
+// projects/deque/TestBitDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// -------------------------------
+
+/*
+To test the program:
+    % g++ -std=c++11 -pedantic -lcppunit -ldl -Wall TestBitDeque.c++ -o TestBitDeque.app
+    % valgrind TestBitDeque.app >& TestBitDeque.out
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm>  // count, equal, find
+#include <cstdlib>    // rand, srand
+#include <deque>      // deque
+#include <functional> // function
+#include <iterator>   // back_inserter
+#include <stdexcept>  // out_of_range
+#include <utility>    // move
+#include <vector>     // vector
+
+#include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
+#include "cppunit/TestFixture.h"             // TestFixture
+#include "cppunit/TestSuite.h"               // TestSuite
+#include "cppunit/TextTestRunner.h"          // TestRunner
+
+#include "Deque.h"
+
+// ------------
+// TestBitDeque
+// ------------
+
+struct TestBitDeque : CppUnit::TestFixture {
+    typedef Deque<bool> D;
+
+    // ---------
+    // test_push
+    // ---------
+
+    void test_push () {
+        D x;
+        CPPUNIT_ASSERT(x.empty());
+        for(int i = 0; i < 200; i++)
+            x.push_back(i % 3 == 0);
+        for(int i = 0; i < 200; i++)
+            x.push_front(i % 5 == 0);
+        CPPUNIT_ASSERT(x.size() == 400 && x.count() == 67 + 40);
+        CPPUNIT_ASSERT(x.front() == false && x.back() == false && x[200] == true);
+        x[0] = true;
+        x[1] = x[0];
+        x.back().flip();
+        CPPUNIT_ASSERT(x[1] && x.back() && x.count() == 67 + 40 + 3);
+        const D& y = x;
+        CPPUNIT_ASSERT(y.at(1) && std::count(y.begin(), y.end(), true) == (long)y.count());
+        try
+        {
+            x.at(400);
+            CPPUNIT_ASSERT(false);
+        }
+        catch(std::out_of_range&)
+        {}
+        D z(100, true);
+        CPPUNIT_ASSERT(z.size() == 100 && z.count() == 100);
+        z.resize(30);
+        CPPUNIT_ASSERT(z.count() == 30);
+        z.resize(200, false);
+        CPPUNIT_ASSERT(z.count() == 30 && z.find_first(false) == 30);
+    }
+
+    // -----------
+    // test_random
+    // -----------
+
+    void test_random () {
+        srand(5);
+        D x;
+        std::deque<bool> y;
+        for(int k = 0; k < 100000; k++)
+        {
+            int op = rand() % 10;
+            bool v = rand() % 3 == 0;
+            if(op < 3 || y.empty())
+            {
+                x.push_back(v);
+                y.push_back(v);
+            }
+            else if(op < 5)
+            {
+                x.push_front(v);
+                y.push_front(v);
+            }
+            else if(op == 5)
+            {
+                x.pop_back();
+                y.pop_back();
+            }
+            else if(op == 6)
+            {
+                x.pop_front();
+                y.pop_front();
+            }
+            else if(op == 7)
+            {
+                std::size_t i = rand() % y.size();
+                x[i] = v;
+                y[i] = v;
+            }
+            else if(op == 8 && k % 50 == 0)
+            {
+                std::size_t i = rand() % (y.size() + 1);
+                x.insert(x.begin() + i, v);
+                y.insert(y.begin() + i, v);
+                if(!y.empty() && k % 100 == 0)
+                {
+                    i = rand() % y.size();
+                    x.erase(x.begin() + i);
+                    y.erase(y.begin() + i);
+                }
+            }
+            else
+            {
+                std::size_t i = rand() % y.size(), j = i + rand() % (y.size() - i + 1);
+                CPPUNIT_ASSERT(x.count(i, j) == (std::size_t)std::count(y.begin() + i, y.begin() + j, true));
+                CPPUNIT_ASSERT(x.find_first(v, i) == (std::size_t)(std::find(y.begin() + i, y.end(), v) - y.begin()));
+            }
+        }
+        CPPUNIT_ASSERT(x.size() == y.size());
+        CPPUNIT_ASSERT(x.count() == (std::size_t)std::count(y.begin(), y.end(), true));
+        CPPUNIT_ASSERT(std::equal(y.begin(), y.end(), x.begin()));
+    }
+
+    // ----------
+    // test_words
+    // ----------
+
+    void test_words () {
+        D x;
+        std::deque<bool> y;
+        x.push_front(true);
+        y.push_front(true);
+        for(int r = 0; r < 50; r++)
+        {
+            D::word_type w = (D::word_type)rand() << 40 ^ (D::word_type)rand() << 20 ^ rand();
+            std::size_t n = rand() % 65;
+            x.push_back_bits(w, n);
+            for(std::size_t i = 0; i < n; i++)
+                y.push_back((w >> i) & 1);
+            std::size_t m = rand() % (y.size() / 2 + 1);
+            x.pop_front_n(m);
+            y.erase(y.begin(), y.begin() + m);
+            CPPUNIT_ASSERT(x.size() == y.size() && std::equal(y.begin(), y.end(), x.begin()));
+            CPPUNIT_ASSERT(x.count() == (std::size_t)std::count(y.begin(), y.end(), true));
+        }
+    }
+
+    // ---------
+    // test_copy
+    // ---------
+
+    void test_copy () {
+        D x;
+        for(int i = 0; i < 1000; i++)
+            x.push_back(i % 7 == 0);
+        D y(x);
+        CPPUNIT_ASSERT(x == y);
+        y[3] = true;
+        CPPUNIT_ASSERT(x < y && !(x == y));
+        x = y;
+        CPPUNIT_ASSERT(x == y);
+        D z(std::move(x));
+        CPPUNIT_ASSERT(z == y && x.empty() && x.count() == 0);
+        x = std::move(y);                       //takes y's words, doesn't copy them
+        CPPUNIT_ASSERT(x == z && y.empty() && y.count() == 0);
+        y = x.split_at(500);
+        CPPUNIT_ASSERT(x.size() == 500 && y.size() == 500 && y[4] == (504 % 7 == 0));
+        z.clear();
+        CPPUNIT_ASSERT(z.empty() && z.count() == 0 && z.find_first() == 0);
+    }
+
+    // -----------
+    // test_splice
+    // -----------
+
+    void test_splice () {
+        srand(7);
+        D x;
+        std::deque<bool> y;
+        for(int k = 0; k < 2000; k++)
+        {
+            D z;
+            std::deque<bool> w;
+            for(int i = rand() % 200; i != 0; i--)
+            {
+                bool v = rand() % 3 == 0;
+                if(i % 2)
+                {
+                    z.push_back(v);
+                    w.push_back(v);
+                }
+                else
+                {
+                    z.push_front(v);
+                    w.push_front(v);
+                }
+            }
+            int op = rand() % 3;
+            if(op == 0)
+            {
+                x.append(std::move(z));
+                y.insert(y.end(), w.begin(), w.end());
+            }
+            else if(op == 1)
+            {
+                x.prepend(std::move(z));
+                y.insert(y.begin(), w.begin(), w.end());
+            }
+            else
+            {
+                std::size_t pos = rand() % (y.size() + 1);
+                z = x.split_at(pos);
+                CPPUNIT_ASSERT(z.size() == y.size() - pos && std::equal(y.begin() + pos, y.end(), z.begin()));
+                CPPUNIT_ASSERT(z.count() == (std::size_t)std::count(y.begin() + pos, y.end(), true));
+                if(k % 2)
+                    x.append(std::move(z));             //and join them back
+                else
+                    y.erase(y.begin() + pos, y.end());
+            }
+            CPPUNIT_ASSERT(z.empty() || (op == 2 && k % 2 == 0));
+            CPPUNIT_ASSERT(x.size() == y.size() && std::equal(y.begin(), y.end(), x.begin()));
+            CPPUNIT_ASSERT(x.count() == (std::size_t)std::count(y.begin(), y.end(), true));
+            if(y.size() > 5000)
+            {
+                x.pop_front_n(y.size() - 1000);
+                y.erase(y.begin(), y.end() - 1000);
+            }
+        }
+    }
+
+    // ----------
+    // test_batch
+    // ----------
+
+    void test_batch () {
+        D x;
+        int i = 0;
+        x.push_back_n([&i] () {return i++ % 3 == 0;}, 200);
+        x.emplace_back_n(70, true);
+        x.emplace_back_n(10);
+        CPPUNIT_ASSERT(x.size() == 280 && x.count() == 67 + 70 && x[198] && x[200] && !x[279]);
+        x.pop_front();
+        std::vector<bool> v;
+        x.pop_front_into(std::back_inserter(v), 130);
+        CPPUNIT_ASSERT(v.size() == 130 && !v[0] && v[2] && x.size() == 149);
+        bool rest[200];
+        CPPUNIT_ASSERT(x.pop_front_into(rest, 1000) == rest + 149 && rest[69] && rest[138] && !rest[139]);
+        CPPUNIT_ASSERT(x.empty() && x.count() == 0);
+
+        std::deque<bool> y;
+        for(int j = 0; j < 300; j++)
+        {
+            x.push_front(j % 5 == 0);
+            y.push_front(j % 5 == 0);
+        }
+        x.linearize();
+        CPPUNIT_ASSERT(std::equal(y.begin(), y.end(), x.begin()) && x.count() == 60);
+        CPPUNIT_ASSERT(std::equal(y.rbegin(), y.rend(), x.rbegin()) && std::equal(y.begin(), y.end(), x.cbegin()));
+        CPPUNIT_ASSERT(std::equal(x.crbegin(), x.crend(), y.rbegin()) && *x.rbegin() == x.back());
+
+        std::vector< std::function<void ()> > tasks;
+        x.release_async([&tasks] (std::function<void ()> t) {tasks.push_back(std::move(t));});
+        CPPUNIT_ASSERT(x.empty() && x.count() == 0 && tasks.size() == 1);
+        x.push_back(true);
+        tasks[0]();
+        CPPUNIT_ASSERT(x.size() == 1 && x.count() == 1);
+    }
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestBitDeque);
+    CPPUNIT_TEST(test_push);
+    CPPUNIT_TEST(test_random);
+    CPPUNIT_TEST(test_words);
+    CPPUNIT_TEST(test_copy);
+    CPPUNIT_TEST(test_splice);
+    CPPUNIT_TEST(test_batch);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    ios_base::sync_with_stdio(false);  // turn off synchronization with C I/O
+    cout << "TestBitDeque.c++" << endl;
+
+    CppUnit::TextTestRunner tr;
+    tr.addTest(TestBitDeque::suite());
+    tr.run();
+
+    cout << "Done." << endl;
+    return 0;}
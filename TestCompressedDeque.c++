@@ -0,0 +1,201 @@
+// --------------------------------------
+// projects/deque/TestCompressedDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// --------------------------------------
+
+/*
+To test the program:
+    % g++ -std=c++11 -pedantic -lcppunit -ldl -Wall TestCompressedDeque.c++ -o TestCompressedDeque.app
+    % valgrind TestCompressedDeque.app >& TestCompressedDeque.out
+*/
+
+// --------
+// includes
+// --------
+
+#include <cstdint>   // int64_t
+#include <cstdlib>   // rand, srand
+#include <deque>     // deque
+#include <limits>    // numeric_limits
+#include <stdexcept> // out_of_range
+#include <vector>    // vector
+
+#include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
+#include "cppunit/TestFixture.h"             // TestFixture
+#include "cppunit/TestSuite.h"               // TestSuite
+#include "cppunit/TextTestRunner.h"          // TestRunner
+
+#include "CompressedDeque.h"
+
+// -------------------
+// TestCompressedDeque
+// -------------------
+
+struct TestCompressedDeque : CppUnit::TestFixture {
+    typedef CompressedDeque<std::int64_t> D;
+
+    // ---------
+    // test_push
+    // ---------
+
+    void test_push () {
+        D x;
+        CPPUNIT_ASSERT(x.empty());
+        for(int i = 0; i < 1000; i++)
+            x.push_back(i);
+        for(int i = 1; i <= 1000; i++)
+            x.push_front(-i);
+        CPPUNIT_ASSERT(x.size() == 2000);
+        CPPUNIT_ASSERT(x.front() == -1000 && x.back() == 999);
+        for(int i = 0; i < 2000; i++)
+            CPPUNIT_ASSERT(x[i] == i - 1000);
+        try
+        {
+            x.at(2000);
+            CPPUNIT_ASSERT(false);
+        }
+        catch(std::out_of_range&)
+        {}
+    }
+
+    // -------------
+    // test_encoding
+    // -------------
+
+    void test_encoding () {
+        const std::int64_t big = std::numeric_limits<std::int64_t>::max();
+        const std::int64_t small = std::numeric_limits<std::int64_t>::min();
+        std::deque<std::int64_t> y;
+        srand(3);
+        for(int i = 0; i < 2000; i++)
+            y.push_back(1700000000000000000LL + i * 1000LL + rand() % 50); //timestamps
+        for(int i = 0; i < 2000; i++)
+            y.push_back(42);                                               //constant
+        for(int i = 0; i < 2000; i++)
+            y.push_back(i % 2 ? big : small);                              //full width
+        for(int i = 0; i < 2000; i++)
+            y.push_back((std::int64_t)(((std::uint64_t)rand() << 40) ^ rand())); //random
+        D x;
+        for(std::size_t i = 0; i < y.size(); i++)
+            x.push_back(y[i]);
+        for(std::size_t i = 0; i < y.size(); i++)
+            CPPUNIT_ASSERT(x[i] == y[i]);
+        CPPUNIT_ASSERT(std::equal(x.begin(), x.end(), y.begin()));
+        CPPUNIT_ASSERT(x.bytes() < y.size() * sizeof(std::int64_t));
+
+        x.push_front(7);
+        y.push_front(7);
+        std::vector<std::int64_t> spans;
+        x.for_each_span([&] (const std::int64_t* p, std::size_t n) {
+            spans.insert(spans.end(), p, p + n);});
+        CPPUNIT_ASSERT(spans.size() == y.size() && std::equal(spans.begin(), spans.end(), y.begin()));
+
+        D z;
+        for(int i = 0; i < 100000; i++)
+            z.push_back(1700000000000000000LL + i * 1000LL + rand() % 50);
+        CPPUNIT_ASSERT(z.bytes() * 4 < z.size() * sizeof(std::int64_t));
+
+        CompressedDeque<unsigned char> c;
+        for(int i = 0; i < 1000; i++)
+            c.push_front((unsigned char)(i * 37));
+        for(int i = 0; i < 1000; i++)
+            CPPUNIT_ASSERT(c[999 - i] == (unsigned char)(i * 37));
+    }
+
+    // -----------
+    // test_random
+    // -----------
+
+    void test_random () {
+        srand(7);
+        D x;
+        std::deque<std::int64_t> y;
+        std::int64_t v = 0;
+        for(int k = 0; k < 200000; k++)
+        {
+            int op = rand() % 7;
+            v += rand() % 100 - 20;
+            if(op < 2 || y.empty())
+            {
+                x.push_back(v);
+                y.push_back(v);
+            }
+            else if(op < 4)
+            {
+                x.push_front(v);
+                y.push_front(v);
+            }
+            else if(op == 4)
+            {
+                x.pop_back();
+                y.pop_back();
+            }
+            else if(op == 5)
+            {
+                x.pop_front();
+                y.pop_front();
+            }
+            else
+            {
+                std::size_t i = rand() % y.size();
+                CPPUNIT_ASSERT(x[i] == y[i]);
+            }
+        }
+        CPPUNIT_ASSERT(x.size() == y.size());
+        CPPUNIT_ASSERT(std::equal(x.begin(), x.end(), y.begin()));
+        while(!y.empty())
+        {
+            CPPUNIT_ASSERT(x.back() == y.back());
+            x.pop_back();
+            y.pop_back();
+        }
+        CPPUNIT_ASSERT(x.empty());
+    }
+
+    // ---------
+    // test_copy
+    // ---------
+
+    void test_copy () {
+        D x;
+        for(int i = 0; i < 5000; i++)
+            x.push_back(i * i);
+        D y(x);
+        CPPUNIT_ASSERT(x == y);
+        y.pop_front();
+        CPPUNIT_ASSERT(x < y);
+        x = y;
+        CPPUNIT_ASSERT(x == y && x[0] == 1);
+        y.clear();
+        CPPUNIT_ASSERT(y.empty() && x.size() == 4999);
+        x.swap(y);
+        CPPUNIT_ASSERT(x.empty() && y[4998] == 4999LL * 4999);
+    }
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestCompressedDeque);
+    CPPUNIT_TEST(test_push);
+    CPPUNIT_TEST(test_encoding);
+    CPPUNIT_TEST(test_random);
+    CPPUNIT_TEST(test_copy);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    ios_base::sync_with_stdio(false);  // turn off synchronization with C I/O
+    cout << "TestCompressedDeque.c++" << endl;
+
+    CppUnit::TextTestRunner tr;
+    tr.addTest(TestCompressedDeque::suite());
+    tr.run();
+
+    cout << "Done." << endl;
+    return 0;}
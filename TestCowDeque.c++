@@ -0,0 +1,240 @@
+// -------------------------------
+// projects/deque/TestCowDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// -------------------------------
+
+/*
+To test the program:
+    % g++ -std=c++11 -pedantic -pthread -lcppunit -ldl -Wall TestCowDeque.c++ -o TestCowDeque.app
+    % valgrind TestCowDeque.app >& TestCowDeque.out
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // equal
+#include <atomic>    // atomic
+#include <cstdlib>   // rand, srand
+#include <deque>     // deque
+#include <string>    // string
+#include <thread>    // thread
+#include <vector>    // vector
+
+#include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
+#include "cppunit/TestFixture.h"             // TestFixture
+#include "cppunit/TestSuite.h"               // TestSuite
+#include "cppunit/TextTestRunner.h"          // TestRunner
+
+#include "CowDeque.h"
+
+// ------------
+// TestCowDeque
+// ------------
+
+struct TestCowDeque : CppUnit::TestFixture {
+
+    // ----------------
+    // test_constructor
+    // ----------------
+
+    void test_constructor () {
+        const CowDeque<int> x;
+        const CowDeque<int> y(25, 2);
+        CPPUNIT_ASSERT(x.empty());
+        CPPUNIT_ASSERT(y.size() == 25);
+        for(int i = 0; i < 25; i++)
+            CPPUNIT_ASSERT(y.at(i) == 2);
+    }
+
+    // ----------
+    // test_share
+    // ----------
+
+    void test_share () {
+        CowDeque<int> x;
+        for(int i = 0; i < 100; i++)
+            x.push_back(i);
+
+        const CowDeque<int> y = x.snapshot();
+        CPPUNIT_ASSERT(x.shared() && y.shared());
+        CPPUNIT_ASSERT(&y[50] == &static_cast<const CowDeque<int>&>(x)[50]);
+        CPPUNIT_ASSERT(x == y);
+    }
+
+    // -------------------
+    // test_copy_on_write
+    // -------------------
+
+    void test_copy_on_write () {
+        CowDeque<int> x;
+        for(int i = 0; i < 100; i++)
+            x.push_back(i);
+
+        const CowDeque<int> y = x;
+        x[50] = -50;
+        x.push_back(100);
+        x.push_front(-1);
+        x.pop_back();
+
+        CPPUNIT_ASSERT(!y.shared());
+        CPPUNIT_ASSERT(x.size() == 101 && y.size() == 100);
+        CPPUNIT_ASSERT(x[51] == -50 && y[50] == 50);
+        CPPUNIT_ASSERT(&y[20] == &static_cast<const CowDeque<int>&>(x)[21]); //untouched block still shared
+        for(int i = 0; i < 100; i++)
+            CPPUNIT_ASSERT(y[i] == i);
+    }
+
+    // ---------
+    // test_pop
+    // ---------
+
+    void test_pop () {
+        CowDeque<std::string> x;
+        for(int i = 0; i < 30; i++)
+            x.push_back(std::string(20, 'a' + i));
+
+        CowDeque<std::string> y = x;
+        for(int i = 0; i < 15; i++)
+        {
+            x.pop_front();
+            y.pop_back();
+        }
+        x.push_front("front");
+        y.push_back("back");
+
+        CPPUNIT_ASSERT(x.size() == 16 && y.size() == 16);
+        CPPUNIT_ASSERT(x.front() == "front" && x[1] == std::string(20, 'a' + 15));
+        CPPUNIT_ASSERT(y.back() == "back" && y[14] == std::string(20, 'a' + 14));
+    }
+
+    // -----------
+    // test_random
+    // -----------
+
+    void test_random () {
+        srand(7);
+        CowDeque<int> x;
+        std::deque<int> y;
+        std::vector<CowDeque<int> > snapshots;
+        std::vector<std::deque<int> > copies;
+
+        for(int k = 0; k < 5000; k++)
+        {
+            int op = rand() % 6;
+            if(op == 0)
+            {
+                x.push_back(k);
+                y.push_back(k);
+            }
+            else if(op == 1)
+            {
+                x.push_front(k);
+                y.push_front(k);
+            }
+            else if(op == 2 && !y.empty())
+            {
+                x.pop_back();
+                y.pop_back();
+            }
+            else if(op == 3 && !y.empty())
+            {
+                x.pop_front();
+                y.pop_front();
+            }
+            else if(op == 4 && !y.empty())
+            {
+                x[k % y.size()] = -k;
+                y[k % y.size()] = -k;
+            }
+            else if(rand() % 20 == 0)
+            {
+                snapshots.push_back(x.snapshot());
+                copies.push_back(y);
+            }
+        }
+
+        CPPUNIT_ASSERT(x.size() == y.size() && std::equal(y.begin(), y.end(), x.begin()));
+        for(std::size_t i = 0; i < snapshots.size(); i++)
+        {
+            CPPUNIT_ASSERT(snapshots[i].size() == copies[i].size());
+            CPPUNIT_ASSERT(std::equal(copies[i].begin(), copies[i].end(), snapshots[i].begin()));
+        }
+    }
+
+    // ---------------
+    // test_assignment
+    // ---------------
+
+    void test_assignment () {
+        CowDeque<int> x(10, 2);
+        CowDeque<int> y(20, 3);
+        x = y;
+        CPPUNIT_ASSERT(x == y && x.shared());
+        y.clear();
+        CPPUNIT_ASSERT(y.empty() && !x.shared() && x.size() == 20);
+    }
+
+    // ------------
+    // test_readers
+    // ------------
+
+    void test_readers () {
+        CowDeque<int> writer;
+        for(int i = 0; i < 1000; i++)
+            writer.push_back(i);
+
+        std::vector<CowDeque<int> > versions(4, writer.snapshot());
+        std::atomic<bool> ok(true);
+        std::vector<std::thread> readers;
+        for(int r = 0; r < 4; r++)
+            readers.push_back(std::thread([&versions, &ok, r] () {
+                const CowDeque<int>& v = versions[r];
+                for(int k = 0; k < 50; k++)
+                    for(int i = 0; i < 1000; i++)
+                        if(v[i] != i)
+                            ok = false;}));
+
+        for(int i = 0; i < 20000; i++)
+        {
+            writer.pop_front();
+            writer.push_back(1000 + i);
+            writer[500] = -1;
+        }
+        for(std::size_t r = 0; r < readers.size(); r++)
+            readers[r].join();
+
+        CPPUNIT_ASSERT(ok);
+        CPPUNIT_ASSERT(writer.back() == 20999 && writer[500] == -1);
+    }
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestCowDeque);
+    CPPUNIT_TEST(test_constructor);
+    CPPUNIT_TEST(test_share);
+    CPPUNIT_TEST(test_copy_on_write);
+    CPPUNIT_TEST(test_pop);
+    CPPUNIT_TEST(test_random);
+    CPPUNIT_TEST(test_assignment);
+    CPPUNIT_TEST(test_readers);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    ios_base::sync_with_stdio(false);  // turn off synchronization with C I/O
+    cout << "TestCowDeque.c++" << endl;
+
+    CppUnit::TextTestRunner tr;
+    tr.addTest(TestCowDeque::suite());
+    tr.run();
+
+    cout << "Done." << endl;
+    return 0;}
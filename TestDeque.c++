@@ -6,7 +6,7 @@
 
 /*
 To test the program:
-    % g++ -ansi -pedantic -lcppunit -ldl -Wall TestDeque.c++ -o TestDeque.app
+    % g++ -std=c++11 -pedantic -lcppunit -ldl -Wall TestDeque.c++ -o TestDeque.app
     % valgrind TestDeque.app >& TestDeque.out
 */
 
@@ -16,8 +16,14 @@ To test the program:
 
 #include <algorithm> // copy, count, fill, reverse
 #include <deque>     // deque
-#include <memory>    // allocator
+#include <functional> // function
+#include <iterator>  // back_inserter, distance
+#include <stdexcept> // runtime_error
+#include <vector>    // vector
+#include <memory>    // allocator, unique_ptr
 #include <cstring>   // strcmp
+#include <string>    // string
+#include <utility>   // move
 
 #include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
 #include "cppunit/TestFixture.h"             // TestFixture
@@ -26,6 +32,45 @@ To test the program:
 
 #include "Deque.h"
 
+// -------
+// Tracked
+// -------
+
+/**
+ * counts the copies and moves made of it, opted in as trivially relocatable
+ */
+struct Tracked {
+    static int copies;
+    int* value;
+
+    explicit Tracked (int v) : value(new int(v)) {}
+    Tracked (const Tracked& that) : value(new int(*that.value)) {++copies;}
+    Tracked (Tracked&& that) : value(that.value) {that.value = 0; ++copies;}
+    ~Tracked () {delete value;}
+    Tracked& operator = (Tracked that) {std::swap(value, that.value); return *this;}};
+
+int Tracked::copies = 0;
+
+template <>
+struct is_trivially_relocatable<Tracked> : std::true_type {};
+
+// -------
+// Counter
+// -------
+
+/**
+ * generator of 0, 1, 2, ... that throws once it reaches limit
+ */
+struct Counter {
+    int next;
+    int limit;
+
+    explicit Counter (int next = 0, int limit = -1) : next(next), limit(limit) {}
+    int operator () () {
+        if(next == limit)
+            throw std::runtime_error("Counter");
+        return next++;}};
+
 // ---------
 // TestDeque
 // ---------
@@ -745,6 +790,539 @@ struct TestDeque : CppUnit::TestFixture {
         Deque<vector<int> > a(10, v);             
     }
 
+    // --------------
+    // test_relocate
+    // --------------
+
+    void test_relocate_erase () {
+        C x;
+        std::deque<int> y;
+        for(int i = 0; i < 200; i++)
+        {
+            x.push_front(i);
+            y.push_front(i);
+            x.push_back(-i);
+            y.push_back(-i);
+        }
+
+        for(int i = 0; i < 150; i++)
+        {
+            int at = (i * 37) % (int)y.size();
+            x.erase(x.begin() + at);
+            y.erase(y.begin() + at);
+        }
+
+        CPPUNIT_ASSERT(x.size() == y.size());
+        CPPUNIT_ASSERT(std::equal(y.begin(), y.end(), x.begin()));
+    }
+
+    void test_relocate_insert () {
+        C x;
+        std::deque<int> y;
+        for(int i = 0; i < 50; i++)
+        {
+            x.push_front(i);
+            y.push_front(i);
+        }
+
+        for(int i = 0; i < 300; i++)
+        {
+            int at = (i * 41) % ((int)y.size() + 1);
+            x.insert(x.begin() + at, i);
+            y.insert(y.begin() + at, i);
+        }
+
+        x.insert(x.begin() + 3, x[7]); //inserting one of our own items
+        y.insert(y.begin() + 3, y[7]);
+
+        CPPUNIT_ASSERT(x.size() == y.size());
+        CPPUNIT_ASSERT(std::equal(y.begin(), y.end(), x.begin()));
+    }
+
+    void test_relocate_move_only () {
+        Deque<std::unique_ptr<int> > x;
+        for(int i = 0; i < 60; i++)
+            x.push_front(std::unique_ptr<int>(new int(59 - i)));
+
+        x.erase(x.begin() + 25);
+        x.insert(x.begin() + 25, std::unique_ptr<int>(new int(25)));
+        x.insert(x.end(), std::unique_ptr<int>(new int(60)));
+        x.erase(x.begin());
+        x.shrink_to_fit();
+
+        CPPUNIT_ASSERT(x.size() == 60);
+        for(int i = 0; i < 60; i++)
+            CPPUNIT_ASSERT(*x[i] == i + 1);
+    }
+
+    void test_relocate_non_trivial () {
+        Deque<std::string> x;
+        std::deque<std::string> y;
+        for(int i = 0; i < 45; i++)
+        {
+            x.push_front(std::string(i + 20, 'a' + i % 26));
+            y.push_front(std::string(i + 20, 'a' + i % 26));
+        }
+
+        x.erase(x.begin() + 12);
+        y.erase(y.begin() + 12);
+        x.insert(x.begin() + 30, std::string(40, 'z'));
+        y.insert(y.begin() + 30, std::string(40, 'z'));
+        x.linearize();
+
+        CPPUNIT_ASSERT(x.size() == y.size());
+        CPPUNIT_ASSERT(std::equal(y.begin(), y.end(), x.begin()));
+    }
+
+    void test_relocate_trivially_relocatable () {
+        Deque<Tracked> x;
+        for(int i = 0; i < 40; i++)
+            x.push_back(Tracked(i));
+
+        Tracked::copies = 0;
+        x.erase(x.begin() + 3);
+        CPPUNIT_ASSERT(Tracked::copies == 0);
+
+        x.insert(x.begin() + 3, Tracked(3));
+        CPPUNIT_ASSERT(Tracked::copies == 2); //into the temporary and into the gap, none for the shift
+
+        Tracked::copies = 0;
+        x.shrink_to_fit();
+        CPPUNIT_ASSERT(Tracked::copies == 0);
+
+        for(int i = 0; i < 40; i++)
+            CPPUNIT_ASSERT(*x[i].value == i);
+    }
+
+    // --------------
+    // test_linearize
+    // --------------
+
+    void test_linearize () {
+        C x;
+        for(int i = 0; i < 57; i++)
+            x.push_front(56 - i);
+        for(int i = 57; i < 130; i++)
+            x.push_back(i);
+
+        x.linearize();
+        CPPUNIT_ASSERT(x.size() == 130);
+        for(int i = 0; i < 130; i++)
+            CPPUNIT_ASSERT(&x[i] == &x[i - i%10] + i%10);
+        for(int i = 0; i < 130; i++)
+            CPPUNIT_ASSERT(x[i] == i);
+
+        x.push_front(-1);
+        x.push_back(130);
+        CPPUNIT_ASSERT(x.front() == -1 && x.back() == 130);
+    }
+
+    // ------------------
+    // test_shrink_to_fit
+    // ------------------
+
+    void test_shrink_to_fit () {
+        C x;
+        for(int i = 0; i < 1000; i++)
+            x.push_back(i);
+        for(int i = 0; i < 985; i++)
+            x.pop_front();
+
+        x.shrink_to_fit();
+        CPPUNIT_ASSERT(x.size() == 15);
+        for(int i = 0; i < 15; i++)
+            CPPUNIT_ASSERT(x[i] == 985 + i);
+
+        for(int i = 0; i < 100; i++)
+        {
+            x.push_front(984 - i);
+            x.push_back(1000 + i);
+        }
+        CPPUNIT_ASSERT(x.size() == 215);
+        for(int i = 0; i < 215; i++)
+            CPPUNIT_ASSERT(x[i] == 885 + i);
+
+        C y;
+        y.shrink_to_fit();
+        y.push_back(1);
+        CPPUNIT_ASSERT(y.size() == 1 && y.front() == 1);
+    }
+
+    // ------------
+    // test_batched
+    // ------------
+
+    void test_push_back_n () {
+        C x;
+        for(int i = 0; i < 23; i++)
+            x.push_front(-1 - i);
+
+        x.push_back_n(Counter(), 7);
+        x.push_back_n(Counter(7), 0);
+        x.push_back_n(Counter(7), 2000); //several doublings in one batch
+
+        CPPUNIT_ASSERT(x.size() == 2030);
+        for(int i = 0; i < 2030; i++)
+            CPPUNIT_ASSERT(x[i] == i - 23);
+
+        x.push_back(2007);
+        x.push_front(-24);
+        CPPUNIT_ASSERT(x.size() == 2032 && x.front() == -24 && x.back() == 2007);
+    }
+
+    void test_push_back_n_throws () {
+        C x;
+        x.push_back(-1);
+        try
+        {
+            x.push_back_n(Counter(0, 25), 40);
+            CPPUNIT_ASSERT(false);
+        }
+        catch(std::runtime_error& e)
+        {
+            CPPUNIT_ASSERT(x.size() == 26);
+        }
+        for(int i = 0; i < 26; i++)
+            CPPUNIT_ASSERT(x[i] == i - 1);
+    }
+
+    void test_emplace_back_n () {
+        Deque<std::string> x;
+        x.emplace_back_n(3, 4, 'a');
+        x.emplace_back_n(15, "bc");
+
+        CPPUNIT_ASSERT(x.size() == 18);
+        CPPUNIT_ASSERT(x.front() == "aaaa" && x[2] == "aaaa");
+        CPPUNIT_ASSERT(x[3] == "bc" && x.back() == "bc");
+    }
+
+    void test_pop_front_into () {
+        C x;
+        x.push_back_n(Counter(), 256);
+
+        std::vector<int> v;
+        x.pop_front_into(std::back_inserter(v), 100);
+        CPPUNIT_ASSERT(v.size() == 100 && x.size() == 156);
+        CPPUNIT_ASSERT(x.front() == 100);
+
+        int a[200];
+        int* e = x.pop_front_into(a, 200); //takes only what is there
+        CPPUNIT_ASSERT(e == a + 156 && x.empty());
+        for(int i = 0; i < 100; i++)
+            CPPUNIT_ASSERT(v[i] == i);
+        for(int i = 0; i < 156; i++)
+            CPPUNIT_ASSERT(a[i] == 100 + i);
+
+        x.push_back(7);
+        x.push_front(6);
+        CPPUNIT_ASSERT(x.size() == 2 && x.front() == 6 && x.back() == 7);
+    }
+
+    void test_pop_front_into_move_only () {
+        Deque<std::unique_ptr<int> > x;
+        for(int i = 0; i < 30; i++)
+            x.push_back(std::unique_ptr<int>(new int(i)));
+
+        std::vector<std::unique_ptr<int> > v;
+        x.pop_front_into(std::back_inserter(v), 25);
+        CPPUNIT_ASSERT(v.size() == 25 && x.size() == 5);
+        CPPUNIT_ASSERT(*v[24] == 24 && *x.front() == 25);
+    }
+
+    // -----------
+    // test_splice
+    // -----------
+
+    /**
+     * fills x and y with the n items v, v+1, ..., the first pushes of them pushed
+     * to the front (to put the columns and map rows in some other place)
+     */
+    static void fill_both (Deque<int>& x, std::deque<int>& y, int v, int n, int pushes) {
+        for(int i = pushes - 1; i >= 0; i--)
+        {
+            x.push_front(v + i);
+            y.push_front(v + i);
+        }
+        for(int i = pushes; i < n; i++)
+        {
+            x.push_back(v + i);
+            y.push_back(v + i);
+        }
+    }
+
+    void test_append () {
+        for(int n = 0; n < 60; n += 7)
+            for(int m = 0; m < 60; m += 3)
+            {
+                Deque<int> x, z;
+                std::deque<int> y, w;
+                fill_both(x, y, 0, n, n / 3);
+                fill_both(z, w, 1000, m, m / 2);
+
+                x.append(std::move(z));
+                y.insert(y.end(), w.begin(), w.end());
+
+                CPPUNIT_ASSERT(z.empty());
+                CPPUNIT_ASSERT(x.size() == y.size());
+                CPPUNIT_ASSERT(std::equal(y.begin(), y.end(), x.begin()));
+                x.push_back(-1);
+                x.push_front(-2);
+                z.push_back(-3);
+                CPPUNIT_ASSERT(x.back() == -1 && x.front() == -2 && z.size() == 1);
+            }
+    }
+
+    void test_prepend () {
+        for(int n = 0; n < 60; n += 7)
+            for(int m = 0; m < 60; m += 3)
+            {
+                Deque<int> x, z;
+                std::deque<int> y, w;
+                fill_both(x, y, 0, n, n / 2);
+                fill_both(z, w, 1000, m, m / 3);
+
+                x.prepend(std::move(z));
+                y.insert(y.begin(), w.begin(), w.end());
+
+                CPPUNIT_ASSERT(z.empty());
+                CPPUNIT_ASSERT(x.size() == y.size());
+                CPPUNIT_ASSERT(std::equal(y.begin(), y.end(), x.begin()));
+                x.push_back(-1);
+                x.push_front(-2);
+                CPPUNIT_ASSERT(x.back() == -1 && x.front() == -2);
+            }
+    }
+
+    void test_append_moves_blocks () {
+        Deque<int> x(10, 1); //ends on column 5 of its row, like a new deque begins
+        Deque<int> z;
+        for(int i = 0; i < 1000; i++)
+            z.push_back(i);
+
+        int* p = &z[500];
+        x.append(std::move(z));
+        CPPUNIT_ASSERT(&x[510] == p && x[510] == 500);
+
+        Deque<int> w;
+        for(int i = 0; i < 20000; i++)
+            w.push_back(i);
+        p = &w[15000];
+        x.append(std::move(w)); //w is bigger, x is moved in front of it
+        CPPUNIT_ASSERT(&x[16010] == p && x.size() == 21010);
+    }
+
+    void test_split_at () {
+        for(int n = 0; n < 70; n += 9)
+            for(int pos = 0; pos <= n; pos++)
+            {
+                Deque<int> x;
+                std::deque<int> y;
+                fill_both(x, y, 0, n, n / 4);
+
+                Deque<int> z = x.split_at(pos);
+                CPPUNIT_ASSERT(x.size() == (unsigned)pos && z.size() == (unsigned)(n - pos));
+                CPPUNIT_ASSERT(std::equal(y.begin(), y.begin() + pos, x.begin()));
+                CPPUNIT_ASSERT(std::equal(y.begin() + pos, y.end(), z.begin()));
+
+                x.push_back(-1);
+                z.push_front(-2);
+                z.push_back(-3);
+                CPPUNIT_ASSERT(x.back() == -1 && z.front() == -2 && z.back() == -3);
+
+                x.pop_back();
+                z.pop_front();
+                z.pop_back();
+                x.append(std::move(z));
+                CPPUNIT_ASSERT(std::equal(y.begin(), y.end(), x.begin()) && x.size() == y.size());
+            }
+    }
+
+    void test_splice_move_only () {
+        Deque<std::unique_ptr<int> > x, z;
+        for(int i = 0; i < 35; i++)
+            x.push_back(std::unique_ptr<int>(new int(i)));
+        for(int i = 0; i < 13; i++)
+            z.push_front(std::unique_ptr<int>(new int(-1 - i)));
+
+        x.prepend(std::move(z));
+        Deque<std::unique_ptr<int> > w = x.split_at(20);
+        x.append(std::move(w));
+
+        CPPUNIT_ASSERT(x.size() == 48);
+        for(int i = 0; i < 48; i++)
+            CPPUNIT_ASSERT(*x[i] == i - 13);
+    }
+
+    // -----------------------
+    // test_incremental_growth
+    // -----------------------
+
+    void test_incremental_growth () {
+        Deque<int> x;
+        std::deque<int> y;
+        x.set_incremental_growth(true);
+        for(int i = 0; i < 30000; i++)
+        {
+            if(i % 5 < 2)
+            {
+                x.push_front(i);
+                y.push_front(i);
+            }
+            else
+            {
+                x.push_back(i);
+                y.push_back(i);
+            }
+            if(i % 7 == 0)
+            {
+                x.pop_front();
+                y.pop_front();
+            }
+            if(i % 13 == 0)                     // batches and splices keep a growth going too
+            {
+                int k = 0;
+                x.push_back_n([&k] () {return k++;}, i % 37);
+                for(int j = 0; j < i % 37; j++)
+                    y.push_back(j);
+                Deque<int> w;
+                for(int j = 0; j < i % 23; j++)
+                    w.push_back(-j);
+                if(i % 2)
+                {
+                    x.append(std::move(w));
+                    for(int j = 0; j < i % 23; j++)
+                        y.push_back(-j);
+                }
+                else
+                {
+                    x.prepend(std::move(w));
+                    for(int j = i % 23; j-- > 0; )
+                        y.push_front(-j);
+                }
+            }
+            if(i % 1000 == 0)
+                CPPUNIT_ASSERT(std::equal(y.begin(), y.end(), x.begin()) && x.size() == y.size());
+        }
+
+        Deque<int> z(x); // copies grow incrementally too, and mid-growth maps can be moved and rearranged
+        Deque<int> w = z.split_at(z.size() / 2);
+        z.append(std::move(w));
+        z.shrink_to_fit();
+        x.set_incremental_growth(false);
+        CPPUNIT_ASSERT(std::equal(y.begin(), y.end(), x.begin()) && x == z);
+    }
+
+    // ---------------------
+    // test_reverse_iterator
+    // ---------------------
+
+    void test_reverse_iterator () {
+        C x;
+        std::deque<int> y;
+        for(int i = 0; i < 37; i++)
+        {
+            x.push_front(i);
+            y.push_front(i);
+            x.push_back(-i);
+            y.push_back(-i);
+        }
+        CPPUNIT_ASSERT(std::equal(y.rbegin(), y.rend(), x.rbegin()));
+        CPPUNIT_ASSERT(std::distance(x.rbegin(), x.rend()) == 74 && *x.rbegin() == -36 && *--x.rend() == 36);
+        const C& z = x;
+        CPPUNIT_ASSERT(std::equal(y.crbegin(), y.crend(), z.rbegin()) && std::equal(z.cbegin(), z.cend(), y.begin()));
+        CPPUNIT_ASSERT(std::distance(z.crbegin(), z.crend()) == 74);
+        *x.rbegin() = 7;
+        CPPUNIT_ASSERT(x.back() == 7);
+    }
+
+    // ------------------
+    // test_for_each_span
+    // ------------------
+
+    void test_for_each_span () {
+        C x;
+        std::deque<int> y;
+        for(int i = 0; i < 95; i++)
+        {
+            x.push_back(i);
+            y.push_back(i);
+            if(i % 3 == 0)
+            {
+                x.push_front(-i);
+                y.push_front(-i);
+            }
+        }
+        for(std::size_t ahead = 0; ahead < 20; ahead += 7)
+        {
+            std::vector<int> v, w;
+            std::size_t calls = 0;
+            x.for_each_span([&] (int* p, std::size_t n) {v.insert(v.end(), p, p + n); ++calls;}, ahead);
+            CPPUNIT_ASSERT(std::equal(y.begin(), y.end(), v.begin()) && v.size() == y.size());
+            CPPUNIT_ASSERT(calls <= x.size() / 10 + 2);
+            const C& z = x;
+            z.for_each_span_reverse([&] (const int* p, std::size_t n) {
+                for(std::size_t i = n; i != 0; --i)
+                    w.push_back(p[i - 1]);}, ahead);
+            CPPUNIT_ASSERT(std::equal(y.rbegin(), y.rend(), w.begin()) && w.size() == y.size());
+        }
+        C e;
+        std::size_t calls = 0;
+        e.for_each_span([&] (int*, std::size_t) {++calls;}, 4);
+        e.for_each_span_reverse([&] (int*, std::size_t) {++calls;}, 4);
+        CPPUNIT_ASSERT(calls == 0);
+    }
+
+    // ----------------
+    // test_pop_front_n
+    // ----------------
+
+    void test_pop_front_n () {
+        C x;
+        std::deque<int> y;
+        for(int i = 0; i < 95; i++)
+        {
+            x.push_back(i);
+            y.push_back(i);
+        }
+        x.pop_front_n(0);
+        x.pop_front_n(3);
+        x.pop_front_n(27);
+        y.erase(y.begin(), y.begin() + 30);
+        CPPUNIT_ASSERT(x.size() == 65 && std::equal(y.begin(), y.end(), x.begin()));
+        x.pop_front_n(65);
+        x.push_back(7);
+        CPPUNIT_ASSERT(x.size() == 1 && x.front() == 7);
+
+        Deque<std::string> z;
+        for(int i = 0; i < 44; i++)
+            z.push_back(std::string(30, char('a' + i % 26)));
+        z.pop_front_n(41);
+        CPPUNIT_ASSERT(z.size() == 3 && z.front() == std::string(30, 'p'));
+    }
+
+    // ------------------
+    // test_release_async
+    // ------------------
+
+    void test_release_async () {
+        C x;
+        for(int i = 0; i < 1000; i++)
+            x.push_back(i);
+        x.set_incremental_growth(true);
+        std::vector< std::function<void ()> > tasks;
+        x.release_async([&tasks] (std::function<void ()> t) {tasks.push_back(std::move(t));});
+        CPPUNIT_ASSERT(x.empty() && tasks.size() == 1);
+        for(int i = 0; i < 30; i++)
+            x.push_front(i);                    // reusable at once, and still growing incrementally
+        CPPUNIT_ASSERT(x.size() == 30 && x.front() == 29 && x.back() == 0);
+        tasks[0]();                             // the 1000 old items go here
+
+        std::vector< std::function<void ()> > dropped;
+        x.release_async([&dropped] (std::function<void ()> t) {dropped.push_back(std::move(t));});
+        dropped.clear();                        // never run: dropping the task tears down
+        CPPUNIT_ASSERT(x.empty());
+    }
+
     // -----
     // suite
     // -----
@@ -784,6 +1362,28 @@ struct TestDeque : CppUnit::TestFixture {
     CPPUNIT_TEST(test_const_iterator_1);
     CPPUNIT_TEST(test_algorithms);
     CPPUNIT_TEST(test_destruction);
+    CPPUNIT_TEST(test_relocate_erase);
+    CPPUNIT_TEST(test_relocate_insert);
+    CPPUNIT_TEST(test_relocate_move_only);
+    CPPUNIT_TEST(test_relocate_non_trivial);
+    CPPUNIT_TEST(test_relocate_trivially_relocatable);
+    CPPUNIT_TEST(test_linearize);
+    CPPUNIT_TEST(test_shrink_to_fit);
+    CPPUNIT_TEST(test_push_back_n);
+    CPPUNIT_TEST(test_push_back_n_throws);
+    CPPUNIT_TEST(test_emplace_back_n);
+    CPPUNIT_TEST(test_pop_front_into);
+    CPPUNIT_TEST(test_pop_front_into_move_only);
+    CPPUNIT_TEST(test_append);
+    CPPUNIT_TEST(test_prepend);
+    CPPUNIT_TEST(test_append_moves_blocks);
+    CPPUNIT_TEST(test_split_at);
+    CPPUNIT_TEST(test_splice_move_only);
+    CPPUNIT_TEST(test_incremental_growth);
+    CPPUNIT_TEST(test_reverse_iterator);
+    CPPUNIT_TEST(test_for_each_span);
+    CPPUNIT_TEST(test_pop_front_n);
+    CPPUNIT_TEST(test_release_async);
     CPPUNIT_TEST_SUITE_END();};
 
 // ----
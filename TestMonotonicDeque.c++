@@ -0,0 +1,147 @@
+// -------------------------------------
+// projects/deque/TestMonotonicDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// -------------------------------------
+
+/*
+To test the program:
+    % g++ -std=c++11 -pedantic -lcppunit -ldl -Wall TestMonotonicDeque.c++ -o TestMonotonicDeque.app
+    % valgrind TestMonotonicDeque.app >& TestMonotonicDeque.out
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm>  // max_element, min_element
+#include <cstdlib>    // rand, srand
+#include <deque>      // deque
+#include <functional> // greater
+#include <string>     // string
+
+#include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
+#include "cppunit/TestFixture.h"             // TestFixture
+#include "cppunit/TestSuite.h"               // TestSuite
+#include "cppunit/TextTestRunner.h"          // TestRunner
+
+#include "MonotonicDeque.h"
+
+// ------------------
+// TestMonotonicDeque
+// ------------------
+
+struct TestMonotonicDeque : CppUnit::TestFixture {
+
+    // ------------
+    // test_minimum
+    // ------------
+
+    void test_minimum () {
+        MonotonicDeque<int> x;
+        CPPUNIT_ASSERT(x.empty());
+        x.push_back(5);
+        x.push_back(3);
+        x.push_back(4);
+        CPPUNIT_ASSERT(x.size() == 3 && x.front() == 3);
+        x.pop_front();
+        CPPUNIT_ASSERT(x.front() == 3);
+        x.pop_front();
+        CPPUNIT_ASSERT(x.size() == 1 && x.front() == 4);
+        x.pop_front();
+        CPPUNIT_ASSERT(x.empty());
+    }
+
+    // ------------
+    // test_maximum
+    // ------------
+
+    void test_maximum () {
+        MonotonicDeque<int, std::greater<int> > x;
+        std::deque<int> y;
+        for(int i = 0; i < 10000; i++)
+        {
+            int v = (i * 7919) % 1000;
+            x.push_back(v);
+            y.push_back(v);
+            if(y.size() > 64)
+            {
+                x.pop_front();
+                y.pop_front();
+            }
+            CPPUNIT_ASSERT(x.front() == *std::max_element(y.begin(), y.end()));
+        }
+    }
+
+    // -----------
+    // test_random
+    // -----------
+
+    void test_random () {
+        srand(3);
+        MonotonicDeque<int> x;
+        std::deque<int> y;
+        for(int k = 0; k < 20000; k++)
+        {
+            if(y.empty() || rand() % 5 < 3)
+            {
+                int v = rand() % 50; //lots of ties
+                x.push_back(v);
+                y.push_back(v);
+            }
+            else
+            {
+                x.pop_front();
+                y.pop_front();
+            }
+            CPPUNIT_ASSERT(x.size() == y.size());
+            if(!y.empty())
+                CPPUNIT_ASSERT(x.front() == *std::min_element(y.begin(), y.end()));
+        }
+        x.clear();
+        CPPUNIT_ASSERT(x.empty());
+        x.push_back(7);
+        CPPUNIT_ASSERT(x.front() == 7);
+    }
+
+    // ----------------
+    // test_non_trivial
+    // ----------------
+
+    void test_non_trivial () {
+        MonotonicDeque<std::string> x;
+        const char* words[] = {"pear", "apple", "fig", "banana", "cherry", "date"};
+        for(int i = 0; i < 6; i++)
+            x.push_back(words[i]);
+        CPPUNIT_ASSERT(x.front() == "apple");
+        x.pop_front();
+        x.pop_front();
+        CPPUNIT_ASSERT(x.front() == "banana");
+    }
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestMonotonicDeque);
+    CPPUNIT_TEST(test_minimum);
+    CPPUNIT_TEST(test_maximum);
+    CPPUNIT_TEST(test_random);
+    CPPUNIT_TEST(test_non_trivial);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    ios_base::sync_with_stdio(false);  // turn off synchronization with C I/O
+    cout << "TestMonotonicDeque.c++" << endl;
+
+    CppUnit::TextTestRunner tr;
+    tr.addTest(TestMonotonicDeque::suite());
+    tr.run();
+
+    cout << "Done." << endl;
+    return 0;}
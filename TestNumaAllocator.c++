@@ -0,0 +1,215 @@
+// ------------------------------------
+// projects/deque/TestNumaAllocator.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// ------------------------------------
+
+/*
+To test the program:
+    % g++ -std=c++11 -pedantic -pthread -lcppunit -ldl -Wall TestNumaAllocator.c++ -o TestNumaAllocator.app
+    % valgrind TestNumaAllocator.app >& TestNumaAllocator.out
+*/
+
+// --------
+// includes
+// --------
+
+#include <cstdint>  // uintptr_t
+#include <memory>   // allocator_traits
+#include <string>   // string
+#include <vector>   // vector
+
+#include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
+#include "cppunit/TestFixture.h"             // TestFixture
+#include "cppunit/TestSuite.h"               // TestSuite
+#include "cppunit/TextTestRunner.h"          // TestRunner
+
+#include "CompressedDeque.h"
+#include "CowDeque.h"
+#include "Deque.h"
+#include "NumaAllocator.h"
+#include "RecordDeque.h"
+#include "TieredDeque.h"
+
+// -----------------
+// TestNumaAllocator
+// -----------------
+
+struct TestNumaAllocator : CppUnit::TestFixture {
+    typedef NumaAllocator<int>         allocator_type;
+    typedef Deque<int, allocator_type> deque_type;
+
+    /**
+     * swaps and assigns between Cs in two sets of arenas, then checks that every
+     * block went back to the arenas it came from
+     */
+    template <typename C>
+    static void swap_and_assign () {
+        allocator_type a, b;
+        {
+        C x(a);
+        {
+        C y(b);
+        for(int i = 0; i < 5000; i++)
+            x.push_back(i);
+        for(int i = 0; i < 2000; i++)
+            y.push_back(-1 - i);
+        x.swap(y);
+        CPPUNIT_ASSERT(x.size() == 2000 && x.front() == -1 && y.front() == 0);
+        }
+        CPPUNIT_ASSERT(a.stats().bytesInUse == 0);  //y took a's blocks, and gave them back
+        C z(a);
+        z.push_back(1);
+        z = x;
+        CPPUNIT_ASSERT(z.size() == 2000 && z[1999] == -2000);
+        }
+        CPPUNIT_ASSERT(a.stats().bytesInUse == 0 && b.stats().bytesInUse == 0);}
+
+    // -------------
+    // test_allocate
+    // -------------
+
+    void test_allocate () {
+        allocator_type a;
+        int* p = a.allocate(10);
+        int* q = a.allocate(10);
+        CPPUNIT_ASSERT(p != q && reinterpret_cast<std::uintptr_t>(p) % 8 == 0);
+        CPPUNIT_ASSERT(q == p + 10);            //packed
+        a.deallocate(p, 10);
+        CPPUNIT_ASSERT(a.allocate(10) == p);    //reused
+
+        NumaAllocator<double*> b(a);
+        CPPUNIT_ASSERT(b == a && !(b != a) && a != allocator_type());
+        double** big = b.allocate(1 << 20);     //an arena of its own
+        big[(1 << 20) - 1] = 0;
+        b.deallocate(big, 1 << 20);
+        NumaStats s = a.stats();
+        CPPUNIT_ASSERT(s.arenas == 2 && s.bytesMapped == allocator_type::arenaBytes + (8 << 20));
+        CPPUNIT_ASSERT(s.bytesInUse == 2 * 40);
+    }
+
+    // ----------
+    // test_deque
+    // ----------
+
+    void test_deque () {
+        allocator_type a(allocator_type::localNode);
+        deque_type x(a);
+        for(int i = 0; i < 100000; i++)
+        {
+            x.push_back(i);
+            x.push_front(-i);
+        }
+        deque_type y(x);
+        deque_type z;
+        z.swap(y);
+        CPPUNIT_ASSERT(z.size() == 200000 && z.front() == -99999 && z.back() == 99999);
+        NumaStats s = a.stats();
+        CPPUNIT_ASSERT(s.requestedNode == allocator_type::localNode && s.node == allocator_type::current_node());
+        CPPUNIT_ASSERT(s.bytesInUse >= 2 * 200000 * sizeof(int));    //x and its copy, map and all
+        std::size_t touched = 0;
+        for(std::size_t n = 0; n < s.pagesOnNode.size(); n++)
+            touched += s.pagesOnNode[n];
+        CPPUNIT_ASSERT(touched * allocator_type::pageBytes >= 2 * 200000 * sizeof(int));
+        CPPUNIT_ASSERT(touched + s.untouchedPages == s.bytesMapped / allocator_type::pageBytes);
+        while(!x.empty())
+            x.pop_front();
+        z.clear();
+    }
+
+    // -------------
+    // test_propagate
+    // -------------
+
+    void test_propagate () {
+        typedef std::allocator_traits<allocator_type> traits;
+        CPPUNIT_ASSERT(!traits::is_always_equal::value && traits::propagate_on_container_swap::value);
+        CPPUNIT_ASSERT(traits::propagate_on_container_copy_assignment::value && traits::propagate_on_container_move_assignment::value);
+
+        allocator_type a, b;
+        std::vector<int, allocator_type> v(a), w(b);
+        v.assign(1000, 1);
+        w.assign(2000, 2);
+        v.swap(w);                              //storage and allocators swap together
+        CPPUNIT_ASSERT(v.get_allocator() == b && w.get_allocator() == a);
+        CPPUNIT_ASSERT(a.stats().bytesInUse == 1000 * sizeof(int) && b.stats().bytesInUse == 2000 * sizeof(int));
+
+        v = w;                                  //v's storage goes back to b, and v moves to a
+        CPPUNIT_ASSERT(v.get_allocator() == a && b.stats().bytesInUse == 0);
+        w = std::move(v);
+        CPPUNIT_ASSERT(w.get_allocator() == a && w.size() == 1000 && a.stats().bytesInUse == 1000 * sizeof(int));
+
+        {
+        deque_type x(a), y(b);
+        x.push_back(1);
+        y.push_back(2);
+        x.swap(y);
+        CPPUNIT_ASSERT(x.front() == 2 && y.front() == 1);
+        }
+        CPPUNIT_ASSERT(a.stats().bytesInUse == 1000 * sizeof(int) && b.stats().bytesInUse == 0);
+
+        swap_and_assign< TieredDeque<int, allocator_type> >();
+        swap_and_assign< CowDeque<int, allocator_type> >();
+        swap_and_assign< CompressedDeque<int, allocator_type> >();
+
+        NumaAllocator<char> c, d;
+        {
+        RecordDeque< 64, NumaAllocator<char> > x(c), y(d);
+        x.push_back("abc", 3);
+        y.push_back(std::string(200, 'y'));
+        x.swap(y);
+        x = y;
+        CPPUNIT_ASSERT(x.front().str() == "abc" && d.stats().bytesInUse == 0);
+        }
+        CPPUNIT_ASSERT(c.stats().bytesInUse == 0 && d.stats().bytesInUse == 0);
+    }
+
+    // ---------
+    // test_node
+    // ---------
+
+    void test_node () {
+        const int n = allocator_type::nodes();
+        CPPUNIT_ASSERT(n >= 1 && allocator_type::current_node() < n);
+        allocator_type a(n);                    //no such node: left unbound
+        deque_type x(a);
+        x.push_back(1);
+        NumaStats s = a.stats();
+        CPPUNIT_ASSERT(s.requestedNode == n && s.node == allocator_type::anyNode && s.bindFailures >= 1);
+        CPPUNIT_ASSERT((int)s.pagesOnNode.size() == n);
+
+        allocator_type b(0, allocator_type::explicitHugePages, true);
+        deque_type y(b);
+        for(int i = 0; i < 1000; i++)
+            y.push_back(i);
+        s = b.stats();
+        CPPUNIT_ASSERT(s.node == 0 && s.arenas == s.hugetlbArenas + s.hugetlbFallbacks);
+        CPPUNIT_ASSERT(s.pagesOnNode[0] >= 1);
+    }
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestNumaAllocator);
+    CPPUNIT_TEST(test_allocate);
+    CPPUNIT_TEST(test_deque);
+    CPPUNIT_TEST(test_propagate);
+    CPPUNIT_TEST(test_node);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    ios_base::sync_with_stdio(false);  // turn off synchronization with C I/O
+    cout << "TestNumaAllocator.c++" << endl;
+
+    CppUnit::TextTestRunner tr;
+    tr.addTest(TestNumaAllocator::suite());
+    tr.run();
+
+    cout << "Done." << endl;
+    return 0;}
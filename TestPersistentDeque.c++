@@ -0,0 +1,274 @@
+// --------------------------------------
+// projects/deque/TestPersistentDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// --------------------------------------
+
+/*
+To test the program:
+    % g++ -std=c++11 -pedantic -lcppunit -ldl -Wall TestPersistentDeque.c++ -o TestPersistentDeque.app
+    % valgrind TestPersistentDeque.app >& TestPersistentDeque.out
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // equal
+#include <cstdlib>   // rand, srand
+#include <deque>     // deque
+#include <string>    // string
+#include <vector>    // vector
+
+#include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
+#include "cppunit/TestFixture.h"             // TestFixture
+#include "cppunit/TestSuite.h"               // TestSuite
+#include "cppunit/TextTestRunner.h"          // TestRunner
+
+#include "PersistentDeque.h"
+
+// -------------------
+// TestPersistentDeque
+// -------------------
+
+struct TestPersistentDeque : CppUnit::TestFixture {
+    typedef PersistentDeque<int> P;
+
+    /**
+     * @return true if x holds exactly the items of y
+     */
+    static bool same (const P& x, const std::deque<int>& y) {
+        if(x.size() != y.size())
+            return false;
+        for(std::size_t i = 0; i < y.size(); i++)
+            if(x[i] != y[i])
+                return false;
+        return std::equal(y.begin(), y.end(), x.begin());}
+
+    // ----------------
+    // test_constructor
+    // ----------------
+
+    void test_constructor () {
+        const P x;
+        const P y(25, 2);
+        CPPUNIT_ASSERT(x.empty() && x.size() == 0);
+        CPPUNIT_ASSERT(y.size() == 25);
+        for(int i = 0; i < 25; i++)
+            CPPUNIT_ASSERT(y.at(i) == 2);
+        CPPUNIT_ASSERT(y == P(25, 2) && x < y);
+    }
+
+    // ---------
+    // test_push
+    // ---------
+
+    void test_push () {
+        P x;
+        std::deque<int> y;
+        for(int i = 0; i < 1000; i++)
+        {
+            x = (i % 3 == 0) ? x.push_front(i) : x.push_back(i);
+            if(i % 3 == 0)
+                y.push_front(i);
+            else
+                y.push_back(i);
+        }
+        CPPUNIT_ASSERT(same(x, y));
+        CPPUNIT_ASSERT(x.front() == y.front() && x.back() == y.back());
+    }
+
+    // ------------
+    // test_version
+    // ------------
+
+    void test_version () {
+        P v0;
+        P v1 = v0.push_back(1);
+        P v2 = v1.push_back(2);
+        P v3 = v2.push_front(0);
+        P v4 = v3.pop_back();
+
+        CPPUNIT_ASSERT(v0.empty());
+        CPPUNIT_ASSERT(v1.size() == 1 && v1[0] == 1);
+        CPPUNIT_ASSERT(v2.size() == 2 && v2[0] == 1 && v2[1] == 2);
+        CPPUNIT_ASSERT(v3.size() == 3 && v3[0] == 0 && v3[2] == 2);
+        CPPUNIT_ASSERT(v4.size() == 2 && v4[0] == 0 && v4[1] == 1);
+    }
+
+    // --------
+    // test_pop
+    // --------
+
+    void test_pop () {
+        P x;
+        for(int i = 0; i < 500; i++)
+            x = x.push_back(i);
+
+        P y = x;
+        for(int i = 0; i < 250; i++)
+        {
+            y = y.pop_front();
+            CPPUNIT_ASSERT(y.front() == i + 1);
+        }
+        for(int i = 0; i < 249; i++)
+        {
+            y = y.pop_back();
+            CPPUNIT_ASSERT(y.back() == 498 - i);
+        }
+        CPPUNIT_ASSERT(y.size() == 1 && y.front() == 250);
+        CPPUNIT_ASSERT(y.pop_front().empty());
+        CPPUNIT_ASSERT(x.size() == 500 && x[499] == 499);
+    }
+
+    // ----------
+    // test_split
+    // ----------
+
+    void test_split () {
+        P x;
+        for(int i = 0; i < 3000; i++)
+            x = x.push_back(i);
+
+        for(std::size_t pos = 0; pos <= 3000; pos += 137)
+        {
+            std::pair<P, P> p = x.split_at(pos);
+            CPPUNIT_ASSERT(p.first.size() == pos && p.second.size() == 3000 - pos);
+            for(std::size_t i = 0; i < pos; i += 7)
+                CPPUNIT_ASSERT(p.first[i] == (int)i);
+            for(std::size_t i = 0; i < 3000 - pos; i += 7)
+                CPPUNIT_ASSERT(p.second[i] == (int)(pos + i));
+            CPPUNIT_ASSERT(p.first.concat(p.second) == x);
+        }
+    }
+
+    // -----------
+    // test_concat
+    // -----------
+
+    void test_concat () {
+        P x;
+        std::deque<int> y;
+        for(int k = 0; k < 200; k++)
+        {
+            P z;
+            for(int i = 0; i < k % 23; i++)
+            {
+                z = z.push_back(k * 100 + i);
+                y.push_back(k * 100 + i);
+            }
+            x = x.concat(z);
+        }
+        CPPUNIT_ASSERT(same(x, y));
+        CPPUNIT_ASSERT(same(x.concat(P()), y) && same(P().concat(x), y));
+    }
+
+    // -----------
+    // test_random
+    // -----------
+
+    void test_random () {
+        srand(11);
+        P x;
+        std::deque<int> y;
+        std::vector<P> versions;
+        std::vector<std::deque<int> > copies;
+
+        for(int k = 0; k < 4000; k++)
+        {
+            int op = rand() % 7;
+            if(op == 0)
+            {
+                x = x.push_back(k);
+                y.push_back(k);
+            }
+            else if(op == 1)
+            {
+                x = x.push_front(k);
+                y.push_front(k);
+            }
+            else if(op == 2 && !y.empty())
+            {
+                x = x.pop_back();
+                y.pop_back();
+            }
+            else if(op == 3 && !y.empty())
+            {
+                x = x.pop_front();
+                y.pop_front();
+            }
+            else if(op == 4)
+            {
+                std::size_t pos = rand() % (y.size() + 1);
+                std::pair<P, P> p = x.split_at(pos);
+                x = p.second.concat(p.first);
+                std::rotate(y.begin(), y.begin() + pos, y.end());
+            }
+            else if(op == 5 && !versions.empty())
+            {
+                std::size_t v = rand() % versions.size();
+                x = x.concat(versions[v]);
+                y.insert(y.end(), copies[v].begin(), copies[v].end());
+            }
+            else if(rand() % 10 == 0)
+            {
+                versions.push_back(x);
+                copies.push_back(y);
+            }
+            if(y.size() > 3000)
+            {
+                x = x.split_at(1000).second;
+                y.erase(y.begin(), y.begin() + 1000);
+            }
+        }
+
+        CPPUNIT_ASSERT(same(x, y));
+        for(std::size_t v = 0; v < versions.size(); v++)
+            CPPUNIT_ASSERT(same(versions[v], copies[v]));
+    }
+
+    // ------------------
+    // test_non_trivial
+    // ------------------
+
+    void test_non_trivial () {
+        PersistentDeque<std::string> x;
+        for(int i = 0; i < 100; i++)
+            x = x.push_front(std::string(30, 'a' + i % 26));
+
+        std::pair<PersistentDeque<std::string>, PersistentDeque<std::string> > p = x.split_at(45);
+        CPPUNIT_ASSERT(p.first.back() == std::string(30, 'a' + 55 % 26));
+        CPPUNIT_ASSERT(p.second.front() == std::string(30, 'a' + 54 % 26));
+        CPPUNIT_ASSERT(p.second.concat(p.first).size() == 100);
+    }
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestPersistentDeque);
+    CPPUNIT_TEST(test_constructor);
+    CPPUNIT_TEST(test_push);
+    CPPUNIT_TEST(test_version);
+    CPPUNIT_TEST(test_pop);
+    CPPUNIT_TEST(test_split);
+    CPPUNIT_TEST(test_concat);
+    CPPUNIT_TEST(test_random);
+    CPPUNIT_TEST(test_non_trivial);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    ios_base::sync_with_stdio(false);  // turn off synchronization with C I/O
+    cout << "TestPersistentDeque.c++" << endl;
+
+    CppUnit::TextTestRunner tr;
+    tr.addTest(TestPersistentDeque::suite());
+    tr.run();
+
+    cout << "Done." << endl;
+    return 0;}
@@ -0,0 +1,168 @@
+// --------------------------------
+// projects/deque/TestReclaimer.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// --------------------------------
+
+/*
+To test the program:
+    % g++ -std=c++11 -pedantic -pthread -lcppunit -ldl -Wall TestReclaimer.c++ -o TestReclaimer.app
+    % valgrind TestReclaimer.app >& TestReclaimer.out
+*/
+
+// --------
+// includes
+// --------
+
+#include <atomic>  // atomic
+#include <mutex>   // mutex, lock_guard
+#include <string>  // string
+#include <thread>  // thread, this_thread
+
+#include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
+#include "cppunit/TestFixture.h"             // TestFixture
+#include "cppunit/TestSuite.h"               // TestSuite
+#include "cppunit/TextTestRunner.h"          // TestRunner
+
+#include "Deque.h"
+#include "Reclaimer.h"
+
+// -------
+// Tracked
+// -------
+
+/**
+ * counts the live instances and notes whether any was destroyed off the
+ * thread that made it
+ */
+struct Tracked {
+    static std::atomic<int> live;
+    static std::atomic<int> elsewhere;
+
+    std::thread::id maker;
+    std::string payload;
+
+    explicit Tracked (int i = 0) :
+            maker(std::this_thread::get_id()), payload(40, char('a' + i % 26)) {
+        ++live;}
+
+    Tracked (const Tracked& that) :
+            maker(std::this_thread::get_id()), payload(that.payload) {
+        ++live;}
+
+    ~Tracked () {
+        if(maker != std::this_thread::get_id())
+            ++elsewhere;
+        --live;}};
+
+std::atomic<int> Tracked::live(0);
+std::atomic<int> Tracked::elsewhere(0);
+
+// -------------
+// TestReclaimer
+// -------------
+
+struct TestReclaimer : CppUnit::TestFixture {
+    // ----------
+    // test_deque
+    // ----------
+
+    void test_deque () {
+        Tracked::live = Tracked::elsewhere = 0;
+        Reclaimer r;
+        Deque<Tracked> x;
+        for(int i = 0; i < 5000; i++)
+            x.push_back(Tracked(i));
+        CPPUNIT_ASSERT(Tracked::live == 5000);
+        x.release_async(r);
+        CPPUNIT_ASSERT(x.empty());
+        x.push_back(Tracked(1));
+        r.wait();
+        CPPUNIT_ASSERT(Tracked::live == 1 && Tracked::elsewhere == 5000);
+        CPPUNIT_ASSERT(r.pending() == 0 && r.reclaimed() == 1);
+    }
+
+    // ----------
+    // test_order
+    // ----------
+
+    void test_order () {
+        std::mutex m;
+        std::string seen;
+        Reclaimer r(false);
+        for(int i = 0; i < 10; i++)
+            r([&m, &seen, i] () {
+                std::lock_guard<std::mutex> lock(m);
+                seen += char('0' + i);});
+        r.wait();
+        CPPUNIT_ASSERT(seen == "0123456789" && r.reclaimed() == 10);
+    }
+
+    // ---------------
+    // test_destructor
+    // ---------------
+
+    void test_destructor () {
+        Tracked::live = Tracked::elsewhere = 0;
+        {
+        Reclaimer r;
+        for(int k = 0; k < 8; k++)
+        {
+            Deque<Tracked> x;
+            for(int i = 0; i < 1000; i++)
+                x.push_back(Tracked(i));
+            x.release_async(r);
+        }
+        }                                       // runs what is still queued
+        CPPUNIT_ASSERT(Tracked::live == 0 && Tracked::elsewhere == 8000);
+    }
+
+    // ------------
+    // test_threads
+    // ------------
+
+    void test_threads () {
+        Tracked::live = Tracked::elsewhere = 0;
+        Reclaimer r;
+        std::thread t[4];
+        for(int k = 0; k < 4; k++)
+            t[k] = std::thread([&r] () {
+                for(int j = 0; j < 50; j++)
+                {
+                    Deque<Tracked> x;
+                    for(int i = 0; i < 100; i++)
+                        x.push_back(Tracked(i));
+                    x.release_async(r);
+                }});
+        for(int k = 0; k < 4; k++)
+            t[k].join();
+        r.wait();
+        CPPUNIT_ASSERT(Tracked::live == 0 && Tracked::elsewhere == 20000 && r.reclaimed() == 200);
+    }
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestReclaimer);
+    CPPUNIT_TEST(test_deque);
+    CPPUNIT_TEST(test_order);
+    CPPUNIT_TEST(test_destructor);
+    CPPUNIT_TEST(test_threads);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    ios_base::sync_with_stdio(false);  // turn off synchronization with C I/O
+    cout << "TestReclaimer.c++" << endl;
+
+    CppUnit::TextTestRunner tr;
+    tr.addTest(TestReclaimer::suite());
+    tr.run();
+
+    cout << "Done." << endl;
+    return 0;}
@@ -0,0 +1,184 @@
+// ----------------------------------
+// projects/deque/TestRecordDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// ----------------------------------
+
+/*
+To test the program:
+    % g++ -std=c++11 -pedantic -pthread -lcppunit -ldl -Wall TestRecordDeque.c++ -o TestRecordDeque.app
+    % valgrind TestRecordDeque.app >& TestRecordDeque.out
+*/
+
+// --------
+// includes
+// --------
+
+#include <cstdlib>   // rand, srand
+#include <deque>     // deque
+#include <string>    // string
+
+#include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
+#include "cppunit/TestFixture.h"             // TestFixture
+#include "cppunit/TestSuite.h"               // TestSuite
+#include "cppunit/TextTestRunner.h"          // TestRunner
+
+#include "NumaAllocator.h"
+#include "RecordDeque.h"
+
+// ---------------
+// TestRecordDeque
+// ---------------
+
+struct TestRecordDeque : CppUnit::TestFixture {
+    typedef RecordDeque<64> D;  //small blocks, so records straddle them
+
+    /**
+     * @return a record of n bytes, different for each seed
+     */
+    static std::string record (std::size_t n, int seed) {
+        std::string s(n, '\0');
+        for(std::size_t i = 0; i < n; i++)
+            s[i] = (char)(seed * 31 + i);
+        return s;}
+
+    // ---------
+    // test_push
+    // ---------
+
+    void test_push () {
+        D x;
+        CPPUNIT_ASSERT(x.empty());
+        x.push_back(record(10, 1));
+        x.push_back("", 0);
+        x.push_back(record(200, 2));
+        CPPUNIT_ASSERT(x.size() == 3 && x.bytes() == 3 * 4 + 210);
+
+        D::Record r = x.front();
+        CPPUNIT_ASSERT(r.size() == 10 && r.contiguous() && r.fragments() == 1);
+        CPPUNIT_ASSERT(std::string(r.data(), r.size()) == record(10, 1));
+        x.pop_front();
+        CPPUNIT_ASSERT(x.front().size() == 0 && x.front().fragments() == 0);
+        x.pop_front();
+
+        r = x.front();
+        CPPUNIT_ASSERT(r.size() == 200 && !r.contiguous() && r.fragments() >= 4);
+        std::size_t total = 0;
+        for(std::size_t k = 0; k < r.fragments(); k++)
+        {
+            CPPUNIT_ASSERT(r.fragment(k).second <= D::blockSize);
+            total += r.fragment(k).second;
+        }
+        CPPUNIT_ASSERT(total == 200 && r.str() == record(200, 2));
+        x.pop_front();
+        CPPUNIT_ASSERT(x.empty() && x.bytes() == 0);
+    }
+
+    // -----------
+    // test_random
+    // -----------
+
+    void test_random () {
+        srand(11);
+        D x;
+        std::deque<std::string> y;
+        for(int k = 0; k < 20000; k++)
+        {
+            if(y.empty() || rand() % 5 < 3)
+            {
+                std::string s = record(rand() % (rand() % 4 ? 40 : 300), k);
+                x.push_back(s);
+                y.push_back(s);
+            }
+            else
+            {
+                CPPUNIT_ASSERT(x.front().str() == y.front());
+                x.pop_front();
+                y.pop_front();
+            }
+            CPPUNIT_ASSERT(x.size() == y.size());
+        }
+        D z(x);
+        while(!y.empty())
+        {
+            CPPUNIT_ASSERT(x.front().str() == y.front() && z.front().str() == y.front());
+            x.pop_front();
+            z.pop_front();
+            y.pop_front();
+        }
+        CPPUNIT_ASSERT(x.empty() && z.empty());
+    }
+
+    // -----------
+    // test_steady
+    // -----------
+
+    void test_steady () {
+        RecordDeque<1024> x;
+        for(int i = 0; i < 10; i++)
+            x.push_back(record(100, i));
+        RecordDeque<1024> y;
+        y = x;
+        for(int i = 10; i < 10000; i++)
+        {
+            CPPUNIT_ASSERT(x.front().str() == record(100, i - 10));
+            x.pop_front();
+            x.push_back(record(100, i));
+        }
+        CPPUNIT_ASSERT(x.size() == 10 && x.bytes() == 10 * 104);
+        x.clear();
+        CPPUNIT_ASSERT(x.empty());
+        x.swap(y);
+        CPPUNIT_ASSERT(x.size() == 10 && x.front().str() == record(100, 0) && y.empty());
+    }
+
+    // --------------
+    // test_allocator
+    // --------------
+
+    void test_allocator () {
+        typedef RecordDeque< 64, NumaAllocator<char> > N;
+        NumaAllocator<char> a, b;               //unequal: arenas of their own
+        {
+        N x(a), y(b);
+        for(int i = 0; i < 100; i++)
+        {
+            x.push_back(record(50, i));
+            y.push_back(record(70, i));
+        }
+        x.swap(y);                              //blocks and allocators swap together
+        CPPUNIT_ASSERT(x.front().str() == record(70, 0) && y.front().str() == record(50, 0));
+        x.clear();
+        x = y;                                  //copy-and-swap: x's blocks go back to b, and x moves to a
+        CPPUNIT_ASSERT(b.stats().bytesInUse == 0);
+        CPPUNIT_ASSERT(x.size() == 100 && x.front().str() == record(50, 0));
+        }
+        CPPUNIT_ASSERT(a.stats().bytesInUse == 0 && b.stats().bytesInUse == 0);
+    }
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestRecordDeque);
+    CPPUNIT_TEST(test_push);
+    CPPUNIT_TEST(test_random);
+    CPPUNIT_TEST(test_steady);
+    CPPUNIT_TEST(test_allocator);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    ios_base::sync_with_stdio(false);  // turn off synchronization with C I/O
+    cout << "TestRecordDeque.c++" << endl;
+
+    CppUnit::TextTestRunner tr;
+    tr.addTest(TestRecordDeque::suite());
+    tr.run();
+
+    cout << "Done." << endl;
+    return 0;}
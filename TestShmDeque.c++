@@ -0,0 +1,280 @@
+// -------------------------------
+// projects/deque/TestShmDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// -------------------------------
+
+/*
+To test the program:
+    % g++ -std=c++11 -pedantic -pthread -lcppunit -ldl -lrt -Wall TestShmDeque.c++ -o TestShmDeque.app
+    % valgrind TestShmDeque.app >& TestShmDeque.out
+*/
+
+// --------
+// includes
+// --------
+
+#include <atomic>       // atomic
+#include <stdexcept>    // runtime_error
+#include <string>       // string, to_string
+#include <system_error> // system_error
+#include <thread>       // thread
+
+#include <sys/wait.h>   // waitpid
+#include <unistd.h>     // fork, getpid, _exit
+
+#include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
+#include "cppunit/TestFixture.h"             // TestFixture
+#include "cppunit/TestSuite.h"               // TestSuite
+#include "cppunit/TextTestRunner.h"          // TestRunner
+
+#include "ShmDeque.h"
+
+// ------------
+// TestShmDeque
+// ------------
+
+struct TestShmDeque : CppUnit::TestFixture {
+    struct Message {
+        int producer;
+        int seq;
+        double payload[6];};
+
+    /**
+     * @return a segment name no other test run uses; take it before forking
+     */
+    static std::string segment (const char* test) {
+        return std::string("/TestShmDeque-") + test + "-" + std::to_string(getpid());}
+
+    /**
+     * @return true if the child pid exited with status 0
+     */
+    static bool joined (pid_t pid) {
+        int status = 0;
+        return waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;}
+
+    // ---------
+    // test_push
+    // ---------
+
+    void test_push () {
+        ShmDeque<int> x(segment("push"), 1000);
+        ShmDeque<int> y(segment("push"));
+        CPPUNIT_ASSERT(x.empty() && x.capacity() >= 1000);
+        int v = 0;
+        CPPUNIT_ASSERT(!y.try_pop_front(v));
+        for(int i = 0; i < 10; i++)
+            x.push_back(i);
+        CPPUNIT_ASSERT(y.size() == 10 && y.front() == 0);
+        y.pop_front();
+        y.pop_front(v);
+        CPPUNIT_ASSERT(v == 1 && x.size() == 8);
+
+        while(x.try_push_back(7))
+            {}
+        CPPUNIT_ASSERT(x.size() == x.capacity());
+        int n = 0;
+        while(y.try_pop_front(v))
+            ++n;
+        CPPUNIT_ASSERT(n == (int)x.capacity() && x.empty());
+    }
+
+    // ---------
+    // test_open
+    // ---------
+
+    void test_open () {
+        ShmDeque<int> x(segment("open"), 10);
+        try
+        {
+            ShmDeque<int> y(segment("open"), 10);
+            CPPUNIT_ASSERT(false);
+        }
+        catch(std::system_error&)
+        {}
+        try
+        {
+            ShmDeque<double> y(segment("open"));
+            CPPUNIT_ASSERT(false);
+        }
+        catch(std::runtime_error&)
+        {}
+        try
+        {
+            ShmDeque<int> y(segment("missing"));
+            CPPUNIT_ASSERT(false);
+        }
+        catch(std::system_error&)
+        {}
+    }
+
+    // -----------
+    // test_racing
+    // -----------
+
+    void test_racing () {
+        // an opener racing the creator waits for a finished segment, never a half-made one
+        bool whole = true;
+        for(int r = 0; r < 50 && whole; r++)
+        {
+            const std::string name = segment("racing") + "-" + std::to_string(r);
+            std::size_t opened = 0;
+            std::thread t([&name, &opened, &whole] () {
+                for(;;)
+                {
+                    try
+                    {
+                        ShmDeque<int, true> y(name);
+                        opened = y.capacity();
+                        return;
+                    }
+                    catch(std::system_error&)
+                    {}                          //not created yet
+                    catch(std::runtime_error&)
+                    {
+                        whole = false;
+                        return;
+                    }
+                }});
+            ShmDeque<int, true> x(name, 5000);
+            t.join();
+            whole = whole && opened == x.capacity();
+        }
+        CPPUNIT_ASSERT(whole);
+    }
+
+    // ------------
+    // test_claimed
+    // ------------
+
+    void test_claimed () {
+        // producers with stale tails still find room while the consumer moves the head
+        const int n = 400;
+        const std::string name = segment("claimed");
+        ShmDeque<int, true> x(name, 2 * n);
+        std::atomic<int> full(0);
+        for(int r = 0; r < 100 && full == 0; r++)
+        {
+            std::thread p1([&x, &full] () {
+                for(int i = 0; i < n; i++)
+                    full += !x.try_push_back(i);});
+            std::thread p2([&x, &full] () {
+                for(int i = 0; i < n; i++)
+                    full += !x.try_push_back(i);});
+            int v;
+            for(int i = 0; i < 2 * n; i++)
+                x.pop_front(v);
+            p1.join();
+            p2.join();
+        }
+        CPPUNIT_ASSERT(full == 0 && x.empty());
+    }
+
+    // ---------
+    // test_fork
+    // ---------
+
+    void test_fork () {
+        const int n = 200000;
+        const std::string name = segment("fork");
+        ShmDeque<Message> x(name, 64);
+        pid_t pid = fork();
+        if(pid == 0)
+        {
+            try
+            {
+                ShmDeque<Message> y(name);
+                for(int i = 0; i < n; i++)
+                {
+                    Message m = {0, i, {i * 0.5}};
+                    y.push_back(m);
+                }
+            }
+            catch(...)
+            {
+                _exit(1);
+            }
+            _exit(0);
+        }
+        bool ordered = true;
+        for(int i = 0; i < n; i++)
+        {
+            const Message& m = x.front();
+            ordered = ordered && m.seq == i && m.payload[0] == i * 0.5;
+            x.pop_front();
+        }
+        CPPUNIT_ASSERT(ordered && x.empty());
+        CPPUNIT_ASSERT(joined(pid));
+    }
+
+    // ----------
+    // test_multi
+    // ----------
+
+    void test_multi () {
+        const int producers = 3, n = 50000;
+        const std::string name = segment("multi");
+        ShmDeque<Message, true> x(name, 100);
+        pid_t pids[producers];
+        for(int p = 0; p < producers; p++)
+        {
+            pids[p] = fork();
+            if(pids[p] == 0)
+            {
+                try
+                {
+                    ShmDeque<Message, true> y(name);
+                    for(int i = 0; i < n; i++)
+                    {
+                        Message m = {p, i, {0}};
+                        y.push_back(m);
+                    }
+                }
+                catch(...)
+                {
+                    _exit(1);
+                }
+                _exit(0);
+            }
+        }
+        int next[producers] = {0};
+        bool ordered = true;
+        for(int i = 0; i < producers * n; i++)
+        {
+            Message m;
+            x.pop_front(m);
+            ordered = ordered && m.producer >= 0 && m.producer < producers && m.seq == next[m.producer]++;
+        }
+        CPPUNIT_ASSERT(ordered && x.empty());
+        for(int p = 0; p < producers; p++)
+            CPPUNIT_ASSERT(joined(pids[p]) && next[p] == n);
+    }
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestShmDeque);
+    CPPUNIT_TEST(test_push);
+    CPPUNIT_TEST(test_open);
+    CPPUNIT_TEST(test_racing);
+    CPPUNIT_TEST(test_claimed);
+    CPPUNIT_TEST(test_fork);
+    CPPUNIT_TEST(test_multi);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    ios_base::sync_with_stdio(false);  // turn off synchronization with C I/O
+    cout << "TestShmDeque.c++" << endl;
+
+    CppUnit::TextTestRunner tr;
+    tr.addTest(TestShmDeque::suite());
+    tr.run();
+
+    cout << "Done." << endl;
+    return 0;}
@@ -0,0 +1,161 @@
+// ------------------------------------
+// projects/deque/TestSlidingWindow.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// ------------------------------------
+
+/*
+To test the program:
+    % g++ -std=c++11 -pedantic -lcppunit -ldl -Wall TestSlidingWindow.c++ -o TestSlidingWindow.app
+    % valgrind TestSlidingWindow.app >& TestSlidingWindow.out
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // min
+#include <climits>   // INT_MAX
+#include <cstdlib>   // rand, srand
+#include <deque>     // deque
+#include <string>    // string
+
+#include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
+#include "cppunit/TestFixture.h"             // TestFixture
+#include "cppunit/TestSuite.h"               // TestSuite
+#include "cppunit/TextTestRunner.h"          // TestRunner
+
+#include "SlidingWindow.h"
+
+// ---
+// Min
+// ---
+
+struct Min {
+    int operator () (int x, int y) const {
+        return std::min(x, y);}};
+
+// -----------------
+// TestSlidingWindow
+// -----------------
+
+struct TestSlidingWindow : CppUnit::TestFixture {
+
+    /**
+     * pushes and pops on x and on a std::deque in bursts, checking the
+     * query against the aggregate of the std::deque after every operation
+     */
+    template <typename W, typename Op, typename T, typename F>
+    static bool check (W& x, Op op, const T& identity, F make, int seed) {
+        srand(seed);
+        std::deque<T> y;
+        for(int k = 0; k < 3000; k++)
+        {
+            int burst = rand() % 40;
+            bool push = y.empty() || rand() % 2;
+            for(int i = 0; i < burst; i++)
+            {
+                if(push)
+                {
+                    T v = make(rand() % 1000);
+                    x.push_back(v);
+                    y.push_back(v);
+                }
+                else if(!y.empty())
+                {
+                    x.pop_front();
+                    y.pop_front();
+                }
+                T a = identity;
+                for(std::size_t j = 0; j < y.size(); j++)
+                    a = op(a, y[j]);
+                if(x.size() != y.size() || x.query() != a || (!y.empty() && x.front() != y.front()))
+                    return false;
+            }
+            while(y.size() > 200)
+            {
+                x.pop_front();
+                y.pop_front();
+            }
+        }
+        return true;}
+
+    static int as_int (int v) {
+        return v;}
+
+    static std::string as_string (int v) {
+        return std::string(1, 'a' + v % 26);}
+
+    // --------
+    // test_sum
+    // --------
+
+    void test_sum () {
+        SlidingWindow<int> x;
+        CPPUNIT_ASSERT(x.empty() && x.query() == 0);
+        for(int i = 1; i <= 10; i++)
+            x.push_back(i);
+        CPPUNIT_ASSERT(x.query() == 55);
+        x.pop_front();
+        x.pop_front();
+        CPPUNIT_ASSERT(x.size() == 8 && x.query() == 52 && x.front() == 3);
+
+        SlidingWindow<int> w;
+        SlidingWindow<int, std::plus<int>, false> z;
+        CPPUNIT_ASSERT(check(w, std::plus<int>(), 0, as_int, 1));
+        CPPUNIT_ASSERT(check(z, std::plus<int>(), 0, as_int, 2));
+    }
+
+    // --------
+    // test_min
+    // --------
+
+    void test_min () {
+        SlidingWindow<int, Min> x(INT_MAX);
+        SlidingWindow<int, Min, false> z(INT_MAX);
+        CPPUNIT_ASSERT(check(x, Min(), INT_MAX, as_int, 3));
+        CPPUNIT_ASSERT(check(z, Min(), INT_MAX, as_int, 4));
+    }
+
+    // ----------------
+    // test_associative
+    // ----------------
+
+    void test_associative () {
+        //concatenation isn't commutative, so this checks that items are combined in order
+        SlidingWindow<std::string> x;
+        SlidingWindow<std::string, std::plus<std::string>, false> z;
+        CPPUNIT_ASSERT(check(x, std::plus<std::string>(), std::string(), as_string, 5));
+        CPPUNIT_ASSERT(check(z, std::plus<std::string>(), std::string(), as_string, 6));
+        x.clear();
+        CPPUNIT_ASSERT(x.empty() && x.query() == "");
+        x.push_back("ab");
+        x.push_back("c");
+        CPPUNIT_ASSERT(x.query() == "abc");
+    }
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestSlidingWindow);
+    CPPUNIT_TEST(test_sum);
+    CPPUNIT_TEST(test_min);
+    CPPUNIT_TEST(test_associative);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    ios_base::sync_with_stdio(false);  // turn off synchronization with C I/O
+    cout << "TestSlidingWindow.c++" << endl;
+
+    CppUnit::TextTestRunner tr;
+    tr.addTest(TestSlidingWindow::suite());
+    tr.run();
+
+    cout << "Done." << endl;
+    return 0;}
@@ -0,0 +1,183 @@
+// -------------------------------
+// projects/deque/TestSoaDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// -------------------------------
+
+/*
+To test the program:
+    % g++ -std=c++11 -pedantic -lcppunit -ldl -Wall TestSoaDeque.c++ -o TestSoaDeque.app
+    % valgrind TestSoaDeque.app >& TestSoaDeque.out
+*/
+
+// --------
+// includes
+// --------
+
+#include <cstdint>   // int64_t
+#include <cstdlib>   // rand, srand
+#include <deque>     // deque
+#include <stdexcept> // out_of_range
+#include <string>    // string
+#include <tuple>     // make_tuple, tuple
+
+#include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
+#include "cppunit/TestFixture.h"             // TestFixture
+#include "cppunit/TestSuite.h"               // TestSuite
+#include "cppunit/TextTestRunner.h"          // TestRunner
+
+#include "SoaDeque.h"
+
+// ------------
+// TestSoaDeque
+// ------------
+
+struct TestSoaDeque : CppUnit::TestFixture {
+    typedef SoaDeque<std::int64_t, double, char> D;
+
+    // ---------
+    // test_push
+    // ---------
+
+    void test_push () {
+        D x;
+        CPPUNIT_ASSERT(x.empty());
+        x.push_back(1, 1.5, 'a');
+        x.push_front(std::make_tuple(std::int64_t(0), 0.5, 'b'));
+        x.push_back(std::make_tuple(std::int64_t(2), 2.5, 'c'));
+        CPPUNIT_ASSERT(x.size() == 3);
+        CPPUNIT_ASSERT(x.front() == std::make_tuple(std::int64_t(0), 0.5, 'b'));
+        CPPUNIT_ASSERT(x.back() == std::make_tuple(std::int64_t(2), 2.5, 'c'));
+        CPPUNIT_ASSERT(x.get<0>(1) == 1 && x.get<1>(1) == 1.5 && x.get<2>(1) == 'a');
+        x.get<1>(1) = 9.0;
+        CPPUNIT_ASSERT(std::get<1>(x.at(1)) == 9.0);
+        try
+        {
+            x.at(3);
+            CPPUNIT_ASSERT(false);
+        }
+        catch(std::out_of_range&)
+        {}
+    }
+
+    // -----------
+    // test_random
+    // -----------
+
+    void test_random () {
+        srand(9);
+        D x;
+        std::deque<D::value_type> y;
+        for(int k = 0; k < 20000; k++)
+        {
+            int op = rand() % 5;
+            D::value_type v(k, k * 0.25, (char)('a' + k % 26));
+            if(op < 2 || y.empty())
+            {
+                x.push_back(v);
+                y.push_back(v);
+            }
+            else if(op == 2)
+            {
+                x.push_front(v);
+                y.push_front(v);
+            }
+            else if(op == 3)
+            {
+                x.pop_back();
+                y.pop_back();
+            }
+            else
+            {
+                x.pop_front();
+                y.pop_front();
+            }
+        }
+        CPPUNIT_ASSERT(x.size() == y.size());
+        for(std::size_t i = 0; i < y.size(); i++)
+            CPPUNIT_ASSERT(x[i] == y[i]);
+    }
+
+    // ----------
+    // test_spans
+    // ----------
+
+    void test_spans () {
+        D x;
+        long expected = 0;
+        for(int i = 0; i < 3000; i++)
+        {
+            if(i % 4 == 0)
+                x.push_front(i, i, 'x');
+            else
+                x.push_back(i, i, 'x');
+            expected += i;
+        }
+        for(int i = 0; i < 100; i++)
+        {
+            expected -= x.get<0>(0);
+            x.pop_front();
+        }
+
+        const D& y = x;
+        long sum = 0;
+        std::size_t seen = 0, spans = 0;
+        y.for_each_span<0>([&] (const std::int64_t* p, std::size_t n) {
+            for(std::size_t i = 0; i < n; i++)
+                sum += p[i];
+            seen += n;
+            spans++;});
+        CPPUNIT_ASSERT(sum == expected && seen == x.size());
+        CPPUNIT_ASSERT(spans <= x.size() / D::rowSize + 2);
+
+        x.for_each_span<1>([] (double* p, std::size_t n) {
+            for(std::size_t i = 0; i < n; i++)
+                p[i] = -p[i];});
+        CPPUNIT_ASSERT(x.get<1>(5) == -(double)x.get<0>(5));
+    }
+
+    // ----------------
+    // test_non_trivial
+    // ----------------
+
+    void test_non_trivial () {
+        SoaDeque<std::string, int> x;
+        for(int i = 0; i < 1000; i++)
+            x.push_back(std::string(30, 'a' + i % 26), i);
+        SoaDeque<std::string, int> y(x);
+        for(int i = 0; i < 500; i++)
+            x.pop_front();
+        CPPUNIT_ASSERT(x.size() == 500 && x.get<0>(0) == std::string(30, 'a' + 500 % 26));
+        CPPUNIT_ASSERT(y.size() == 1000 && y.get<1>(999) == 999);
+        x = y;
+        CPPUNIT_ASSERT(x == y);
+        x.clear();
+        CPPUNIT_ASSERT(x.empty());
+    }
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestSoaDeque);
+    CPPUNIT_TEST(test_push);
+    CPPUNIT_TEST(test_random);
+    CPPUNIT_TEST(test_spans);
+    CPPUNIT_TEST(test_non_trivial);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    ios_base::sync_with_stdio(false);  // turn off synchronization with C I/O
+    cout << "TestSoaDeque.c++" << endl;
+
+    CppUnit::TextTestRunner tr;
+    tr.addTest(TestSoaDeque::suite());
+    tr.run();
+
+    cout << "Done." << endl;
+    return 0;}
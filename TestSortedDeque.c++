@@ -0,0 +1,168 @@
+// ----------------------------------
+// projects/deque/TestSortedDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// ----------------------------------
+
+/*
+To test the program:
+    % g++ -std=c++11 -pedantic -lcppunit -ldl -Wall TestSortedDeque.c++ -o TestSortedDeque.app
+    % valgrind TestSortedDeque.app >& TestSortedDeque.out
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm>  // equal, equal_range, lower_bound, upper_bound
+#include <cstdlib>    // rand, srand
+#include <deque>      // deque
+#include <functional> // greater
+#include <string>     // string
+#include <utility>    // make_pair
+
+#include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
+#include "cppunit/TestFixture.h"             // TestFixture
+#include "cppunit/TestSuite.h"               // TestSuite
+#include "cppunit/TextTestRunner.h"          // TestRunner
+
+#include "SortedDeque.h"
+
+// ---------------
+// TestSortedDeque
+// ---------------
+
+struct TestSortedDeque : CppUnit::TestFixture {
+    /**
+     * @return true if every search of x gives what the std algorithms give on y
+     */
+    template <typename S, typename D>
+    static bool agrees (const S& x, const D& y, int lo, int hi) {
+        if(x.size() != y.size() || !std::equal(y.begin(), y.end(), x.begin()))
+            return false;
+        for(int v = lo; v <= hi; v++)
+        {
+            std::size_t l = std::lower_bound(y.begin(), y.end(), v) - y.begin();
+            std::size_t u = std::upper_bound(y.begin(), y.end(), v) - y.begin();
+            if(x.lower_bound(v) != l || x.upper_bound(v) != u || x.equal_range(v) != std::make_pair(l, u))
+                return false;
+            if(x.count(v, v + 7) != (std::size_t)(std::lower_bound(y.begin(), y.end(), v + 7) - y.begin()) - l)
+                return false;
+        }
+        return true;}
+
+    // ----------
+    // test_empty
+    // ----------
+
+    void test_empty () {
+        SortedDeque<int> x;
+        CPPUNIT_ASSERT(x.empty() && x.lower_bound(3) == 0 && x.upper_bound(3) == 0 && x.count(0, 9) == 0);
+        CPPUNIT_ASSERT(x.pop_front_while([] (int) {return true;}) == 0);
+        x.push_back(4);
+        x.push_back(4);
+        CPPUNIT_ASSERT(x.equal_range(4) == std::make_pair((std::size_t)0, (std::size_t)2));
+        CPPUNIT_ASSERT(x.lower_bound(5) == 2 && x.count(9, 0) == 0);
+        x.clear();
+        x.push_back(1);                     // a fresh block, though the last one was part full
+        CPPUNIT_ASSERT(x.size() == 1 && x.front() == 1 && x.back() == 1 && x.upper_bound(0) == 0);
+    }
+
+    // -----------
+    // test_search
+    // -----------
+
+    void test_search () {
+        SortedDeque<int> x;
+        std::deque<int> y;
+        int v = 0;
+        for(int i = 0; i < 137; i++)
+        {
+            v += std::rand() % 3;           // runs of duplicates, some across blocks
+            x.push_back(v);
+            y.push_back(v);
+        }
+        CPPUNIT_ASSERT(agrees(x, y, -2, v + 2));
+        for(int i = 0; i < 13; i++)
+        {
+            x.pop_front();                  // the blocks no longer start at index 0
+            y.pop_front();
+        }
+        CPPUNIT_ASSERT(agrees(x, y, -2, v + 2));
+    }
+
+    // --------------------
+    // test_pop_front_while
+    // --------------------
+
+    void test_pop_front_while () {
+        SortedDeque<int> x;
+        std::deque<int> y;
+        int t = 0;
+        std::srand(5);
+        for(int round = 0; round < 300; round++)
+        {
+            int pushes = std::rand() % 40;
+            for(int i = 0; i < pushes; i++)
+            {
+                t += std::rand() % 4;
+                x.push_back(t);
+                y.push_back(t);
+            }
+            int cut = t - std::rand() % 60;
+            std::size_t n = x.pop_front_while([cut] (int e) {return e < cut;});
+            std::size_t m = 0;
+            while(!y.empty() && y.front() < cut)
+            {
+                y.pop_front();
+                ++m;
+            }
+            CPPUNIT_ASSERT(n == m && x.size() == y.size());
+            if(round % 50 == 0)
+                CPPUNIT_ASSERT(agrees(x, y, cut - 3, t + 3));
+        }
+        CPPUNIT_ASSERT(x.pop_front_while([] (int) {return true;}) == y.size() && x.empty());
+    }
+
+    // ------------
+    // test_compare
+    // ------------
+
+    void test_compare () {
+        SortedDeque<std::string, std::greater<std::string> > x;
+        const char* words[] = {"yak", "wren", "vole", "toad", "toad", "seal", "puma", "owl", "newt", "moth",
+                               "lynx", "kiwi", "ibis", "hare", "gnu", "frog", "emu", "dodo"};
+        for(int i = 0; i < 18; i++)
+            x.push_back(std::string(words[i]));
+        CPPUNIT_ASSERT(x.equal_range("toad") == std::make_pair((std::size_t)3, (std::size_t)5));
+        CPPUNIT_ASSERT(x.lower_bound("mule") == 9 && x.count("zebra", "owl") == 7);
+        CPPUNIT_ASSERT(x.pop_front_while([] (const std::string& s) {return s > "k";}) == 12);
+        CPPUNIT_ASSERT(x.front() == "ibis" && x.upper_bound("emu") == 5);
+    }
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestSortedDeque);
+    CPPUNIT_TEST(test_empty);
+    CPPUNIT_TEST(test_search);
+    CPPUNIT_TEST(test_pop_front_while);
+    CPPUNIT_TEST(test_compare);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    ios_base::sync_with_stdio(false);  // turn off synchronization with C I/O
+    cout << "TestSortedDeque.c++" << endl;
+
+    CppUnit::TextTestRunner tr;
+    tr.addTest(TestSortedDeque::suite());
+    tr.run();
+
+    cout << "Done." << endl;
+    return 0;}
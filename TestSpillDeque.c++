@@ -0,0 +1,232 @@
+// ---------------------------------
+// projects/deque/TestSpillDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// ---------------------------------
+
+/*
+To test the program:
+    % g++ -std=c++11 -pedantic -pthread -lcppunit -ldl -Wall TestSpillDeque.c++ -o TestSpillDeque.app
+    % valgrind TestSpillDeque.app >& TestSpillDeque.out
+*/
+
+// --------
+// includes
+// --------
+
+#include <csignal>      // SIGXFSZ, signal, SIG_IGN
+#include <cstdlib>      // rand
+#include <deque>        // deque
+#include <system_error> // system_error
+
+#include <sys/resource.h> // getrlimit, rlimit, RLIMIT_FSIZE, setrlimit
+
+#include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
+#include "cppunit/TestFixture.h"             // TestFixture
+#include "cppunit/TestSuite.h"               // TestSuite
+#include "cppunit/TextTestRunner.h"          // TestRunner
+
+#include "SpillDeque.h"
+
+// --------------
+// TestSpillDeque
+// --------------
+
+struct TestSpillDeque : CppUnit::TestFixture {
+    // 16 ints a row, 6 rows in memory
+    typedef SpillDeque<int> spill_deque;
+    static const std::size_t rowBytes = 16 * sizeof(int);
+    static const std::size_t budget   = 6 * rowBytes;
+
+    // ---------
+    // test_fifo
+    // ---------
+
+    void test_fifo () {
+        spill_deque x(budget, "/tmp", rowBytes);
+        const int n = 10000;
+        for(int i = 0; i < n; i++)
+            x.push_back(i);
+        CPPUNIT_ASSERT(x.size() == (std::size_t)n && x.front() == 0 && x.back() == n - 1);
+        CPPUNIT_ASSERT(x.resident_bytes() <= budget + spill_deque::maxWrites * rowBytes);
+        CPPUNIT_ASSERT(x.spilled_bytes() > 0);
+        bool ordered = true;
+        for(int i = 0; i < n; i++)
+        {
+            ordered = ordered && x.front() == i;
+            x.pop_front();
+            if(i % 7 == 0)
+                x.push_back(n + i);
+        }
+        CPPUNIT_ASSERT(ordered && x.size() == (std::size_t)(n + 6) / 7);
+        CPPUNIT_ASSERT(x.front() == n);
+    }
+
+    // ------------
+    // test_reverse
+    // ------------
+
+    void test_reverse () {
+        spill_deque x(budget, "/tmp", rowBytes);
+        const int n = 5000;
+        for(int i = 0; i < n; i++)
+            x.push_front(i);
+        CPPUNIT_ASSERT(x.front() == n - 1 && x.back() == 0 && x.spilled_bytes() > 0);
+        bool ordered = true;
+        for(int i = 0; i < n; i++)
+        {
+            ordered = ordered && x.back() == i;
+            x.pop_back();
+        }
+        CPPUNIT_ASSERT(ordered && x.empty() && x.resident_bytes() <= spill_deque::maxWrites * rowBytes);
+        x.push_back(1);
+        x.push_front(0);
+        CPPUNIT_ASSERT(x.front() == 0 && x.back() == 1);
+    }
+
+    // -----------
+    // test_random
+    // -----------
+
+    void test_random () {
+        spill_deque x(budget, "/tmp", rowBytes);
+        std::deque<int> y;
+        bool same = true;
+        for(int i = 0; i < 200000 && same; i++)
+        {
+            int op = rand() % 8;
+            if(op < 2 || (op < 4 && y.size() < 3000))
+            {
+                x.push_back(i);
+                y.push_back(i);
+            }
+            else if(op < 4)
+            {
+                x.push_front(i);
+                y.push_front(i);
+            }
+            else if(y.empty())
+                {}
+            else if(op < 6)
+            {
+                x.pop_front();
+                y.pop_front();
+            }
+            else
+            {
+                x.pop_back();
+                y.pop_back();
+            }
+            same = x.size() == y.size() && (y.empty() || (x.front() == y.front() && x.back() == y.back()));
+            if(i % 50000 == 0)
+            {
+                x.clear();
+                y.clear();
+            }
+        }
+        CPPUNIT_ASSERT(same);
+        while(!y.empty() && same)
+        {
+            same = x.front() == y.front();
+            x.pop_front();
+            y.pop_front();
+        }
+        CPPUNIT_ASSERT(same && x.empty());
+    }
+
+    // ----------
+    // test_error
+    // ----------
+
+    void test_error () {
+        try
+        {
+            spill_deque x(budget, "/no/such/directory");
+            CPPUNIT_ASSERT(false);
+        }
+        catch(std::system_error&)
+        {}
+    }
+
+    // ----------------
+    // test_write_error
+    // ----------------
+
+    void test_write_error () {
+        // files may grow to 16 KiB, so the spill file fills up after a few rows
+        rlimit old, small;
+        getrlimit(RLIMIT_FSIZE, &old);
+        small = old;
+        small.rlim_cur = 16 << 10;
+        void (*handler) (int) = std::signal(SIGXFSZ, SIG_IGN);
+        setrlimit(RLIMIT_FSIZE, &small);
+        bool thrown = false;
+        std::size_t n = 0;
+        {
+            spill_deque x(budget, "/tmp", rowBytes);
+            try
+            {
+                for(int i = 0; i < 100000; i++)
+                {
+                    x.push_back(i);
+                    ++n;
+                }
+            }
+            catch(std::system_error&)
+            {
+                thrown = true;
+            }
+            try
+            {
+                // the error sticks: at the latest, the next row's first push reports it again
+                for(std::size_t i = 0; i <= rowBytes / sizeof(int); i++)
+                    x.push_back(0);
+                CPPUNIT_ASSERT(false);
+            }
+            catch(std::system_error&)
+            {}
+        }   // the destructor returns although writes failed
+        {
+            spill_deque x(budget, "/tmp", rowBytes);
+            try
+            {
+                for(int i = 0; i < 100000; i++)
+                    x.push_back(i);
+            }
+            catch(std::system_error&)
+            {}
+            x.clear();
+            CPPUNIT_ASSERT(x.empty() && x.resident_bytes() <= (spill_deque::maxWrites + 1) * rowBytes);
+        }
+        setrlimit(RLIMIT_FSIZE, &old);
+        std::signal(SIGXFSZ, handler);
+        CPPUNIT_ASSERT(thrown && n > (16 << 10) / sizeof(int));
+    }
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestSpillDeque);
+    CPPUNIT_TEST(test_fifo);
+    CPPUNIT_TEST(test_reverse);
+    CPPUNIT_TEST(test_random);
+    CPPUNIT_TEST(test_error);
+    CPPUNIT_TEST(test_write_error);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    ios_base::sync_with_stdio(false);  // turn off synchronization with C I/O
+    cout << "TestSpillDeque.c++" << endl;
+
+    CppUnit::TextTestRunner tr;
+    tr.addTest(TestSpillDeque::suite());
+    tr.run();
+
+    cout << "Done." << endl;
+    return 0;}
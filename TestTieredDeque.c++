@@ -0,0 +1,275 @@
+// ----------------------------------
+// projects/deque/TestTieredDeque.c++
+// Copyright (C) 2010
+// Glenn P. Downing
+// ----------------------------------
+
+/*
+To test the program:
+    % g++ -std=c++11 -pedantic -lcppunit -ldl -Wall TestTieredDeque.c++ -o TestTieredDeque.app
+    % valgrind TestTieredDeque.app >& TestTieredDeque.out
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // equal, reverse
+#include <cstdlib>   // rand, srand
+#include <deque>     // deque
+#include <stdexcept> // out_of_range
+#include <string>    // string
+
+#include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
+#include "cppunit/TestFixture.h"             // TestFixture
+#include "cppunit/TestSuite.h"               // TestSuite
+#include "cppunit/TextTestRunner.h"          // TestRunner
+
+#include "TieredDeque.h"
+
+// ---------------
+// TestTieredDeque
+// ---------------
+
+struct TestTieredDeque : CppUnit::TestFixture {
+    typedef TieredDeque<int> D;
+
+    /**
+     * @return true if x holds exactly the items of y
+     */
+    template <typename C, typename R>
+    static bool same (const C& x, const R& y) {
+        if(x.size() != y.size())
+            return false;
+        for(std::size_t i = 0; i < y.size(); i++)
+            if(x[i] != y[i])
+                return false;
+        return std::equal(y.begin(), y.end(), x.begin());}
+
+    // ----------------
+    // test_constructor
+    // ----------------
+
+    void test_constructor () {
+        const D x;
+        const D y(25, 2);
+        D z(y);
+        CPPUNIT_ASSERT(x.empty() && x.size() == 0);
+        CPPUNIT_ASSERT(y.size() == 25 && z == y && x < y);
+        for(int i = 0; i < 25; i++)
+            CPPUNIT_ASSERT(y.at(i) == 2);
+        try
+        {
+            y.at(25);
+            CPPUNIT_ASSERT(false);
+        }
+        catch(std::out_of_range&)
+        {}
+
+        D w(std::move(z));
+        CPPUNIT_ASSERT(w == y && z.empty());
+        z = w;
+        CPPUNIT_ASSERT(z == w);
+    }
+
+    // ---------
+    // test_push
+    // ---------
+
+    void test_push () {
+        D x;
+        std::deque<int> y;
+        for(int i = 0; i < 5000; i++)
+        {
+            if(i % 3 == 0)
+            {
+                x.push_front(i);
+                y.push_front(i);
+            }
+            else
+            {
+                x.push_back(i);
+                y.push_back(i);
+            }
+        }
+        CPPUNIT_ASSERT(same(x, y));
+        while(!y.empty())
+        {
+            CPPUNIT_ASSERT(x.front() == y.front() && x.back() == y.back());
+            x.pop_front();
+            y.pop_front();
+            if(!y.empty())
+            {
+                x.pop_back();
+                y.pop_back();
+            }
+        }
+        CPPUNIT_ASSERT(x.empty());
+    }
+
+    // -----------
+    // test_insert
+    // -----------
+
+    void test_insert () {
+        D x;
+        std::deque<int> y;
+        for(int i = 0; i < 20000; i++)
+        {
+            std::size_t p = (i * 7919L) % (y.size() + 1);
+            D::iterator it = x.insert(x.begin() + p, i);
+            y.insert(y.begin() + p, i);
+            CPPUNIT_ASSERT(*it == i);
+        }
+        CPPUNIT_ASSERT(same(x, y));
+
+        x.insert(x.begin() + 100, x[5000]); //inserting one of our own items
+        y.insert(y.begin() + 100, y[5000]);
+        CPPUNIT_ASSERT(same(x, y));
+    }
+
+    // ----------
+    // test_erase
+    // ----------
+
+    void test_erase () {
+        D x;
+        std::deque<int> y;
+        for(int i = 0; i < 20000; i++)
+        {
+            x.push_back(i);
+            y.push_back(i);
+        }
+        while(!y.empty())
+        {
+            std::size_t p = (y.size() * 7919L) % y.size();
+            D::iterator it = x.erase(x.begin() + p);
+            y.erase(y.begin() + p);
+            if(p != y.size())
+                CPPUNIT_ASSERT(*it == y[p]);
+            if(y.size() % 1000 == 0)
+                CPPUNIT_ASSERT(same(x, y));
+        }
+        CPPUNIT_ASSERT(x.empty());
+    }
+
+    // -----------
+    // test_random
+    // -----------
+
+    void test_random () {
+        srand(5);
+        D x;
+        std::deque<int> y;
+        for(int k = 0; k < 40000; k++)
+        {
+            int op = rand() % 6;
+            bool grow = (k / 10000) % 2 == 0;
+            if(op == 0 || (grow && op == 5))
+            {
+                x.push_back(k);
+                y.push_back(k);
+            }
+            else if(op == 1)
+            {
+                x.push_front(k);
+                y.push_front(k);
+            }
+            else if(op == 2 && !y.empty())
+            {
+                if(rand() % 2)
+                {
+                    x.pop_back();
+                    y.pop_back();
+                }
+                else
+                {
+                    x.pop_front();
+                    y.pop_front();
+                }
+            }
+            else if(op == 3)
+            {
+                std::size_t p = rand() % (y.size() + 1);
+                x.insert(x.begin() + p, k);
+                y.insert(y.begin() + p, k);
+            }
+            else if(!y.empty())
+            {
+                std::size_t p = rand() % y.size();
+                x.erase(x.begin() + p);
+                y.erase(y.begin() + p);
+            }
+        }
+        CPPUNIT_ASSERT(same(x, y));
+    }
+
+    // ----------------
+    // test_non_trivial
+    // ----------------
+
+    void test_non_trivial () {
+        TieredDeque<std::string> x;
+        std::deque<std::string> y;
+        for(int i = 0; i < 3000; i++)
+        {
+            std::string s(20 + i % 7, 'a' + i % 26);
+            std::size_t p = (i * 31L) % (y.size() + 1);
+            x.insert(x.begin() + p, s);
+            y.insert(y.begin() + p, s);
+        }
+        for(int i = 0; i < 2000; i++)
+        {
+            std::size_t p = (i * 17L) % y.size();
+            x.erase(x.begin() + p);
+            y.erase(y.begin() + p);
+        }
+        CPPUNIT_ASSERT(same(x, y));
+        x.clear();
+        CPPUNIT_ASSERT(x.empty());
+    }
+
+    // ---------------
+    // test_algorithms
+    // ---------------
+
+    void test_algorithms () {
+        D x;
+        for(int i = 0; i < 1000; i++)
+            x.push_front(i);
+        std::reverse(x.begin(), x.end());
+        for(int i = 0; i < 1000; i++)
+            CPPUNIT_ASSERT(x[i] == i);
+        x.resize(10);
+        CPPUNIT_ASSERT(x.size() == 10 && x.back() == 9);
+    }
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestTieredDeque);
+    CPPUNIT_TEST(test_constructor);
+    CPPUNIT_TEST(test_push);
+    CPPUNIT_TEST(test_insert);
+    CPPUNIT_TEST(test_erase);
+    CPPUNIT_TEST(test_random);
+    CPPUNIT_TEST(test_non_trivial);
+    CPPUNIT_TEST(test_algorithms);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    ios_base::sync_with_stdio(false);  // turn off synchronization with C I/O
+    cout << "TestTieredDeque.c++" << endl;
+
+    CppUnit::TextTestRunner tr;
+    tr.addTest(TestTieredDeque::suite());
+    tr.run();
+
+    cout << "Done." << endl;
+    return 0;}
@@ -0,0 +1,1082 @@
+// ----------------------------
+// projects/deque/TieredDeque.h
+// Copyright (C) 2010
+// Glenn P. Downing
+// ----------------------------
+
+#ifndef TieredDeque_h
+#define TieredDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // equal, lexicographical_compare, swap
+#include <cassert>   // assert
+#include <iterator>  // bidirectional_iterator_tag
+#include <memory>    // allocator, allocator_traits
+#include <stdexcept> // out_of_range
+#include <utility>   // !=, <=, >, >=, move
+
+// -----
+// using
+// -----
+
+using std::rel_ops::operator!=;
+using std::rel_ops::operator<=;
+using std::rel_ops::operator>;
+using std::rel_ops::operator>=;
+
+// -----------
+// TieredDeque
+// -----------
+
+/**
+ * A Deque with the same interface that also inserts and erases in the middle
+ * cheaply: a tiered vector. Items live in tiers of B = 2^shift slots; every tier
+ * is full except the first (whose first lead slots are empty) and the last. Each
+ * tier is a circular buffer with its own offset, so moving every item of a full
+ * tier over by one slot is an O(1) change of that offset.
+ *
+ * Item i sits in virtual slot v = lead + i, in tier v / B. An insert or erase
+ * shifts the items on the shorter side of it by one slot: the items of the two
+ * tiers at the ends of that run move one by one, the tiers in between rotate and
+ * pass one item on to their neighbour. That is O(B + size() / B), and B is kept
+ * near sqrt(size()) (every tier is rebuilt when size() leaves [B^2/4, 4 B^2]), so
+ * insert and erase anywhere are O(sqrt(n)) amortized while operator [] is O(1).
+ *
+ * Moving items assumes that T's move constructor doesn't throw.
+ */
+template < typename T, typename A = std::allocator<T> >
+class TieredDeque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef A                                        allocator_type;
+        typedef typename allocator_type::value_type      value_type;
+
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::difference_type difference_type;
+
+        typedef T*                                       pointer;
+        typedef const T*                                 const_pointer;
+
+        typedef T&                                       reference;
+        typedef const T&                                 const_reference;
+
+    public:
+        // -----------
+        // operator ==
+        // -----------
+
+        /**
+         * @param lhs the TieredDeque on the left hand side of operator ==
+         * @param rhs the TieredDeque on the right hand side of operator ==
+         * @return true if they are equal false otherwise
+         */
+        friend bool operator == (const TieredDeque& lhs, const TieredDeque& rhs) {
+            return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());}
+
+        // ----------
+        // operator <
+        // ----------
+
+        /**
+         * @param lhs the TieredDeque on the left hand side of operator <
+         * @param rhs the TieredDeque on the right hand side of operator <
+         * @return true if lhs < rhs is true, false otherwise
+         */
+        friend bool operator < (const TieredDeque& lhs, const TieredDeque& rhs) {
+            return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());}
+
+    private:
+        // ----
+        // Tier
+        // ----
+
+        /**
+         * B slots; logical slot i of the tier is items[(offset + i) % B]
+         */
+        struct Tier {
+            pointer items;
+            size_type offset;};
+
+        typedef typename std::allocator_traits<A>::template rebind_alloc<Tier> tier_allocator_type;
+
+        /**
+         * the smallest and largest tier sizes, as powers of two
+         */
+        static const size_type minShift = 4;
+        static const size_type maxShift = 24;
+
+        // ----
+        // data
+        // ----
+
+        allocator_type a;               //allocator of T's
+        tier_allocator_type tier_a;     //allocator of the ring of tiers
+        Tier* tiers;                    //ring of tierCap tiers, the first one at firstTier
+        size_type tierCap, firstTier, numTiers;
+        size_type shift;                //each tier holds 2^shift items
+        size_type lead;                 //empty slots at the front of the first tier
+        size_type mysize;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        /*
+         * @return true if TieredDeque is valid
+         */
+        bool valid () const {
+            if(shift < minShift || shift > maxShift)
+                return false;
+            if(numTiers > tierCap || (tierCap & (tierCap - 1)) != 0)
+                return false;
+            if(lead + mysize > (numTiers << shift))
+                return false;
+            return true;}
+
+    public:
+        // --------
+        // iterator
+        // --------
+
+        class iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::bidirectional_iterator_tag       iterator_category;
+                typedef typename TieredDeque::value_type      value_type;
+                typedef typename TieredDeque::difference_type difference_type;
+                typedef typename TieredDeque::pointer         pointer;
+                typedef typename TieredDeque::reference       reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                /**
+                 * @param lhs the iterator on the left hand side of operator ==
+                 * @param rhs the iterator on the right hand side of operator ==
+                 * @return true if lhs == rhs is true, false otherwise
+                 */
+                friend bool operator == (const iterator& lhs, const iterator& rhs) {
+                    return lhs.index == rhs.index && lhs.myDeque == rhs.myDeque;}
+
+                // ----------
+                // operator +
+                // ----------
+
+                /**
+                 * Increments the iterator by rhs
+                 * @param lhs the iterator on the left hand side of operator +
+                 * @param rhs the amount to increment by
+                 */
+                friend iterator operator + (iterator lhs, difference_type rhs) {
+                    return lhs += rhs;}
+
+                // ----------
+                // operator -
+                // ----------
+
+                /**
+                 * Decrements the iterator by rhs
+                 * @param lhs the iterator on the left hand side of operator -
+                 * @param rhs the amount to decrement by
+                 */
+                friend iterator operator - (iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;}
+
+            private:
+                // ----
+                // data
+                // ----
+
+                size_type index;        //index to the item in TieredDeque we are pointing at
+                TieredDeque* myDeque;   //the TieredDeque which the iterator is operating on
+
+                friend class TieredDeque;
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                /**
+                 * @param myDeque the TieredDeque to iterate over
+                 * @param index the index location in myDeque to point at initially
+                 */
+                iterator (TieredDeque& myDeque, size_type index) : index(index), myDeque(&myDeque) {}
+
+                // ----------
+                // operator *
+                // ----------
+
+                /**
+                 * @return the element which this iterator is currently pointing at
+                 */
+                reference operator * () const {
+                    return (*myDeque)[index];}
+
+                // -----------
+                // operator ->
+                // -----------
+
+                /**
+                 * @return dereferenced element with access to members
+                 */
+                pointer operator -> () const {
+                    return &**this;}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                /**
+                 * Increments the iterator one place
+                 * @return the iterator after being incremented
+                 */
+                iterator& operator ++ () {
+                    index++;
+                    return *this;}
+
+                /**
+                 * Increments the iterator one place
+                 * @return the iterator before being incremented
+                 */
+                iterator operator ++ (int) {
+                    iterator x = *this;
+                    ++(*this);
+                    return x;}
+
+                // -----------
+                // operator --
+                // -----------
+
+                /**
+                 * Decrements the iterator one place
+                 * @return the iterator after being decremented
+                 */
+                iterator& operator -- () {
+                    index--;
+                    return *this;}
+
+                /**
+                 * Decrements the iterator one place
+                 * @return the iterator before being decremented
+                 */
+                iterator operator -- (int) {
+                    iterator x = *this;
+                    --(*this);
+                    return x;}
+
+                // -----------
+                // operator +=
+                // -----------
+
+                /**
+                 * Increments the iterator by d
+                 * @param d the amount to increment by
+                 * @return the iterator after being incremented
+                 */
+                iterator& operator += (difference_type d) {
+                    index += d;
+                    return *this;}
+
+                // -----------
+                // operator -=
+                // -----------
+
+                /**
+                 * Decrements the iterator by d
+                 * @param d the amount to decrement by
+                 * @return the iterator after being decremented
+                 */
+                iterator& operator -= (difference_type d) {
+                    index -= d;
+                    return *this;}};
+
+    public:
+        // --------------
+        // const_iterator
+        // --------------
+
+        class const_iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::bidirectional_iterator_tag       iterator_category;
+                typedef typename TieredDeque::value_type      value_type;
+                typedef typename TieredDeque::difference_type difference_type;
+                typedef typename TieredDeque::const_pointer   pointer;
+                typedef typename TieredDeque::const_reference reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                /**
+                 * @param lhs the iterator on the left hand side of operator ==
+                 * @param rhs the iterator on the right hand side of operator ==
+                 * @return true if lhs == rhs is true, false otherwise
+                 */
+                friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs.index == rhs.index && lhs.myDeque == rhs.myDeque;}
+
+                // ----------
+                // operator +
+                // ----------
+
+                /**
+                 * Increments the iterator by rhs
+                 * @param lhs the iterator on the left hand side of operator +
+                 * @param rhs the amount to increment by
+                 */
+                friend const_iterator operator + (const_iterator lhs, difference_type rhs) {
+                    return lhs += rhs;}
+
+                // ----------
+                // operator -
+                // ----------
+
+                /**
+                 * Decrements the iterator by rhs
+                 * @param lhs the iterator on the left hand side of operator -
+                 * @param rhs the amount to decrement by
+                 */
+                friend const_iterator operator - (const_iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;}
+
+            private:
+                // ----
+                // data
+                // ----
+
+                size_type index;            //index to the item in TieredDeque we are pointing at
+                const TieredDeque* myDeque; //the TieredDeque which the iterator is reading
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                /**
+                 * @param myDeque the TieredDeque to iterate over
+                 * @param index the index location in myDeque to point at initially
+                 */
+                const_iterator (const TieredDeque& myDeque, size_type index) : index(index), myDeque(&myDeque) {}
+
+                // ----------
+                // operator *
+                // ----------
+
+                /**
+                 * @return the element which this iterator is currently pointing at
+                 */
+                reference operator * () const {
+                    return (*myDeque)[index];}
+
+                // -----------
+                // operator ->
+                // -----------
+
+                /**
+                 * @return dereferenced element with access to members
+                 */
+                pointer operator -> () const {
+                    return &**this;}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                /**
+                 * Increments the iterator one place
+                 * @return the iterator after being incremented
+                 */
+                const_iterator& operator ++ () {
+                    index++;
+                    return *this;}
+
+                /**
+                 * Increments the iterator one place
+                 * @return the iterator before being incremented
+                 */
+                const_iterator operator ++ (int) {
+                    const_iterator x = *this;
+                    ++(*this);
+                    return x;}
+
+                // -----------
+                // operator --
+                // -----------
+
+                /**
+                 * Decrements the iterator one place
+                 * @return the iterator after being decremented
+                 */
+                const_iterator& operator -- () {
+                    index--;
+                    return *this;}
+
+                /**
+                 * Decrements the iterator one place
+                 * @return the iterator before being decremented
+                 */
+                const_iterator operator -- (int) {
+                    const_iterator x = *this;
+                    --(*this);
+                    return x;}
+
+                // -----------
+                // operator +=
+                // -----------
+
+                /**
+                 * Increments the iterator by d
+                 * @param d the amount to increment by
+                 * @return the iterator after being incremented
+                 */
+                const_iterator& operator += (difference_type d) {
+                    index += d;
+                    return *this;}
+
+                // -----------
+                // operator -=
+                // -----------
+
+                /**
+                 * Decrements the iterator by d
+                 * @param d the amount to decrement by
+                 * @return the iterator after being decremented
+                 */
+                const_iterator& operator -= (difference_type d) {
+                    index -= d;
+                    return *this;}};
+
+    private:
+        // -----
+        // tiers
+        // -----
+
+        /**
+         * @return the k-th tier from the front
+         */
+        Tier& tier (size_type k) const {
+            return tiers[(firstTier + k) & (tierCap - 1)];}
+
+        /**
+         * @return the address of logical slot i of t
+         */
+        pointer at (const Tier& t, size_type i) const {
+            return t.items + ((t.offset + i) & ((size_type(1) << shift) - 1));}
+
+        /**
+         * @return the address of virtual slot v
+         */
+        pointer slot (size_type v) const {
+            return at(tier(v >> shift), v & ((size_type(1) << shift) - 1));}
+
+        /**
+         * moves the item at from into the raw slot to, leaving from raw
+         */
+        void move_item (pointer from, pointer to) {
+            std::allocator_traits<A>::construct(a, to, std::move(*from));
+            std::allocator_traits<A>::destroy(a, from);}
+
+        /**
+         * doubles the ring of tiers, unwrapping it to start at 0
+         */
+        void grow_tiers () {
+            size_type newCap = tierCap * 2;
+            Tier* t = tier_a.allocate(newCap);
+            for(size_type k = 0; k < numTiers; k++)
+                t[k] = tier(k);
+            tier_a.deallocate(tiers, tierCap);
+            tiers = t;
+            tierCap = newCap;
+            firstTier = 0;}
+
+        /**
+         * @return a new tier with no items
+         */
+        Tier make_tier () {
+            Tier t;
+            t.items = std::allocator_traits<A>::allocate(a, size_type(1) << shift);
+            t.offset = 0;
+            return t;}
+
+        /**
+         * makes sure the slot after the last item exists
+         */
+        void reserve_back () {
+            if(lead + mysize < (numTiers << shift))
+                return;
+            if(numTiers == tierCap)
+                grow_tiers();
+            Tier t = make_tier();
+            tier(numTiers) = t;
+            numTiers++;}
+
+        /**
+         * makes sure the slot before the first item exists
+         */
+        void reserve_front () {
+            if(lead != 0)
+                return;
+            if(numTiers == tierCap)
+                grow_tiers();
+            Tier t = make_tier();
+            firstTier = (firstTier + tierCap - 1) & (tierCap - 1);
+            tier(0) = t;
+            numTiers++;
+            lead = size_type(1) << shift;}
+
+        /**
+         * frees the last tier once it and the one before it hold no items, so
+         * pushing and popping across a tier boundary doesn't allocate every time
+         */
+        void trim_back () {
+            size_type b = size_type(1) << shift;
+            if((numTiers << shift) - (lead + mysize) < 2 * b)
+                return;
+            numTiers--;
+            std::allocator_traits<A>::deallocate(a, tier(numTiers).items, b);}
+
+        /**
+         * frees the first tier once it and the one after it hold no items
+         */
+        void trim_front () {
+            size_type b = size_type(1) << shift;
+            if(lead < 2 * b)
+                return;
+            std::allocator_traits<A>::deallocate(a, tier(0).items, b);
+            firstTier = (firstTier + 1) & (tierCap - 1);
+            numTiers--;
+            lead -= b;}
+
+        // -----
+        // shift
+        // -----
+
+        /**
+         * moves the items in virtual slots [lo, hi) to [lo + 1, hi + 1)
+         * @pre virtual slot hi exists and is raw
+         */
+        void shift_up (size_type lo, size_type hi) {
+            if(lo == hi)
+                return;
+            size_type b  = size_type(1) << shift;
+            size_type kl = lo >> shift;
+            size_type kh = hi >> shift;
+            if(kl == kh)
+            {
+                Tier& t = tier(kh);
+                for(size_type i = hi & (b - 1); i != (lo & (b - 1)); i--)
+                    move_item(at(t, i - 1), at(t, i));
+                return;
+            }
+
+            Tier& last = tier(kh);
+            for(size_type i = hi & (b - 1); i != 0; i--)
+                move_item(at(last, i - 1), at(last, i));
+            move_item(at(tier(kh - 1), b - 1), at(last, 0));
+
+            for(size_type k = kh - 1; k != kl; k--)
+            {
+                Tier& t = tier(k);
+                t.offset = (t.offset + b - 1) & (b - 1); //the raw last slot becomes slot 0
+                move_item(at(tier(k - 1), b - 1), at(t, 0));
+            }
+
+            Tier& first = tier(kl);
+            for(size_type i = b - 1; i != (lo & (b - 1)); i--)
+                move_item(at(first, i - 1), at(first, i));}
+
+        /**
+         * moves the items in virtual slots [lo, hi) to [lo - 1, hi - 1)
+         * @pre lo > 0 and virtual slot lo - 1 is raw
+         */
+        void shift_down (size_type lo, size_type hi) {
+            if(lo == hi)
+                return;
+            size_type b  = size_type(1) << shift;
+            size_type kl = (lo - 1) >> shift;
+            size_type kh = (hi - 1) >> shift;
+            if(kl == kh)
+            {
+                Tier& t = tier(kl);
+                for(size_type i = lo & (b - 1); i != (((hi - 1) & (b - 1)) + 1); i++)
+                    move_item(at(t, i), at(t, i - 1));
+                return;
+            }
+
+            Tier& first = tier(kl);
+            for(size_type i = ((lo - 1) & (b - 1)) + 1; i != b; i++)
+                move_item(at(first, i), at(first, i - 1));
+            move_item(at(tier(kl + 1), 0), at(first, b - 1));
+
+            for(size_type k = kl + 1; k != kh; k++)
+            {
+                Tier& t = tier(k);
+                t.offset = (t.offset + 1) & (b - 1); //the raw slot 0 becomes the last slot
+                move_item(at(tier(k + 1), 0), at(t, b - 1));
+            }
+
+            Tier& last = tier(kh);
+            for(size_type i = 1; i != ((hi - 1) & (b - 1)) + 1; i++)
+                move_item(at(last, i), at(last, i - 1));}
+
+        // -------
+        // reshape
+        // -------
+
+        /**
+         * rebuilds every tier with 2^newShift slots
+         */
+        void reshape (size_type newShift) {
+            TieredDeque that(a);
+            that.shift = newShift;
+            for(size_type i = 0; i < mysize; i++)
+            {
+                that.reserve_back();
+                that.move_item(slot(lead + i), that.slot(that.lead + that.mysize));
+                that.mysize++;
+            }
+            mysize = 0;
+            swap(that);}
+
+        /**
+         * keeps the tier size near sqrt(size())
+         */
+        void rebalance () {
+            if(shift < maxShift && mysize > (size_type(4) << (2 * shift)))
+                reshape(shift + 1);
+            else if(shift > minShift && mysize < (size_type(1) << (2 * shift)) / 4)
+                reshape(shift - 1);}
+
+        /**
+         * helper for constructors, an empty ring of tiers
+         */
+        void init_tiers () {
+            tierCap = 8;
+            tiers = tier_a.allocate(tierCap);
+            firstTier = numTiers = 0;
+            lead = mysize = 0;}
+
+        /**
+         * destroys every item and frees every tier and the ring
+         */
+        void free_tiers () {
+            for(size_type i = 0; i < mysize; i++)
+                std::allocator_traits<A>::destroy(a, slot(lead + i));
+            for(size_type k = 0; k < numTiers; k++)
+                std::allocator_traits<A>::deallocate(a, tier(k).items, size_type(1) << shift);
+            tier_a.deallocate(tiers, tierCap);
+            tiers = 0;
+            tierCap = numTiers = mysize = 0;}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Constructs empty TieredDeque
+         * @param a allocator to use
+         */
+        explicit TieredDeque (const allocator_type& a = allocator_type()) : a(a), tier_a(a), shift(minShift) {
+            init_tiers();
+            assert(valid());}
+
+        /**
+         * Constructs TieredDeque of size s with initial values v using allocator a
+         * @param s size of deque
+         * @param v intial value to use
+         * @param a allocator to use, defaulted to allocator_type()
+         */
+        explicit TieredDeque (size_type s, const_reference v = value_type(), const allocator_type& a = allocator_type()) :
+                a(a), tier_a(a), shift(minShift) {
+            init_tiers();
+            resize(s, v);
+            assert(valid());}
+
+        /**
+         * Copy constructor
+         * @param that TieredDeque to copy
+         */
+        TieredDeque (const TieredDeque& that) : a(that.a), tier_a(that.tier_a), shift(minShift) {
+            init_tiers();
+            for(size_type i = 0; i < that.size(); i++)
+                push_back(that[i]);
+            assert(valid());}
+
+        /**
+         * Move constructor, takes that's tiers in O(1) and leaves it empty
+         * @param that TieredDeque to move from
+         */
+        TieredDeque (TieredDeque&& that) : a(that.a), tier_a(that.tier_a), shift(minShift) {
+            init_tiers();
+            swap(that);}
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * Destroys the items and frees the tiers
+         */
+        ~TieredDeque () {
+            free_tiers();}
+
+        // ----------
+        // operator =
+        // ----------
+
+        /**
+         * assign rhs to this
+         * @param rhs TieredDeque whose items we'll copy
+         */
+        TieredDeque& operator = (const TieredDeque& rhs) {
+            TieredDeque that(rhs);
+            swap(that);
+            return *this;}
+
+        /**
+         * Move assignment, swaps tiers with rhs in O(1)
+         * @param rhs TieredDeque to take the items of
+         */
+        TieredDeque& operator = (TieredDeque&& rhs) {
+            swap(rhs);
+            return *this;}
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+         * @return reference to the item at index
+         * @pre index w/in range [0, size())
+         */
+        reference operator [] (size_type index) {
+            return *slot(lead + index);}
+
+        /**
+         * @return const reference to the item at index
+         * @pre index w/in range [0, size())
+         */
+        const_reference operator [] (size_type index) const {
+            return *slot(lead + index);}
+
+        // --
+        // at
+        // --
+
+        /**
+         * @return reference to the item at index
+         * @throws out_of_range exception if index not in [0, size())
+         */
+        reference at (size_type index) {
+            if(index >= size())
+                throw std::out_of_range("TieredDeque::at()");
+            return (*this)[index];}
+
+        /**
+         * @return const reference to the item at index
+         * @throws out_of_range exception if index not in [0, size())
+         */
+        const_reference at (size_type index) const {
+            if(index >= size())
+                throw std::out_of_range("TieredDeque::at()");
+            return (*this)[index];}
+
+        // ----
+        // back
+        // ----
+
+        /**
+         * @pre not empty
+         * @return reference to last item in deque
+         */
+        reference back () {
+            return (*this)[size() - 1];}
+
+        /**
+         * @pre not empty
+         * @return const reference to last item in deque
+         */
+        const_reference back () const {
+            return (*this)[size() - 1];}
+
+        // -----
+        // begin
+        // -----
+
+        /**
+         * @return iterator pointing to start of deque
+         */
+        iterator begin () {
+            return iterator(*this, 0);}
+
+        /**
+         * @return const_iterator pointing to start of deque
+         */
+        const_iterator begin () const {
+            return const_iterator(*this, 0);}
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * destroys every item and frees the tiers, leaving size = 0
+         */
+        void clear () {
+            free_tiers();
+            shift = minShift;
+            init_tiers();
+            assert(valid());}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return size == 0
+         */
+        bool empty () const {
+            return !size();}
+
+        // ---
+        // end
+        // ---
+
+        /**
+         * @return iterator pointing to one past the last item
+         */
+        iterator end () {
+            return iterator(*this, size());}
+
+        /**
+         * @return const_iterator pointing to one past the last item
+         */
+        const_iterator end () const {
+            return const_iterator(*this, size());}
+
+        // -----
+        // erase
+        // -----
+
+        /**
+         * Erases the item at it, closing the gap from whichever end is nearer
+         * @param it iterator to the item to erase
+         * @pre iterator it has valid position in range of [begin(), end())
+         * @return iterator to the item after the erased one
+         */
+        iterator erase (iterator it) {
+            size_type index = it.index;
+            std::allocator_traits<A>::destroy(a, slot(lead + index));
+            if(index >= mysize / 2)
+            {
+                shift_down(lead + index + 1, lead + mysize);
+                mysize--;
+                trim_back();
+            }
+            else
+            {
+                shift_up(lead, lead + index);
+                lead++;
+                mysize--;
+                trim_front();
+            }
+            rebalance();
+            assert(valid());
+            return it;}
+
+        // -----
+        // front
+        // -----
+
+        /**
+         * @return reference to item at front of deque
+         * @pre not empty
+         */
+        reference front () {
+            return (*this)[0];}
+
+        /**
+         * @return const reference to item at front of deque
+         * @pre not empty
+         */
+        const_reference front () const {
+            return (*this)[0];}
+
+        // ------
+        // insert
+        // ------
+
+        /**
+         * Inserts a copy of value before it, making room from whichever end is nearer
+         * @pre it is a valid iterator position for insertion, in range [begin(), end()]
+         * @param it iterator where insertion occurs
+         * @param value value to insert
+         * @return iterator position where insertion occurred.
+         */
+        iterator insert (iterator it, const_reference value) {
+            value_type tmp(value); //value may be one of our own items, copy it before shifting
+            return insert(it, std::move(tmp));}
+
+        /**
+         * Moves value in before it, making room from whichever end is nearer
+         * @pre it is a valid iterator position for insertion, in range [begin(), end()]
+         * @param it iterator where insertion occurs
+         * @param value value to move in
+         * @return iterator position where insertion occurred.
+         */
+        iterator insert (iterator it, value_type&& value) {
+            size_type index = it.index;
+            value_type tmp(std::move(value));
+            if(index >= mysize / 2)
+            {
+                reserve_back();
+                shift_up(lead + index, lead + mysize);
+            }
+            else
+            {
+                reserve_front();
+                shift_down(lead, lead + index);
+                lead--;
+            }
+            std::allocator_traits<A>::construct(a, slot(lead + index), std::move(tmp));
+            mysize++;
+            rebalance();
+            assert(valid());
+            return iterator(*this, index);}
+
+        // ---
+        // pop
+        // ---
+
+        /**
+         * Deletes the item at the back of the container
+         * @pre container not empty
+         */
+        void pop_back () {
+            std::allocator_traits<A>::destroy(a, slot(lead + mysize - 1));
+            mysize--;
+            trim_back();
+            rebalance();
+            assert(valid());}
+
+        /**
+         * Deletes the item at the front of the container.
+         * @pre container not empty
+         */
+        void pop_front () {
+            std::allocator_traits<A>::destroy(a, slot(lead));
+            lead++;
+            mysize--;
+            trim_front();
+            rebalance();
+            assert(valid());}
+
+        // ----
+        // push
+        // ----
+
+        /**
+         * adds an item to back of container
+         * @param item object to be added
+         */
+        void push_back (const_reference item) {
+            value_type tmp(item);
+            push_back(std::move(tmp));}
+
+        /**
+         * moves an item onto the back of the container
+         * @param item object to be moved in
+         */
+        void push_back (value_type&& item) {
+            reserve_back();
+            std::allocator_traits<A>::construct(a, slot(lead + mysize), std::move(item));
+            mysize++;
+            rebalance();
+            assert(valid());}
+
+        /**
+         * adds item to the front of the container
+         * @param item object to push to front.
+         */
+        void push_front (const_reference item) {
+            value_type tmp(item);
+            push_front(std::move(tmp));}
+
+        /**
+         * moves an item onto the front of the container
+         * @param item object to be moved in
+         */
+        void push_front (value_type&& item) {
+            reserve_front();
+            std::allocator_traits<A>::construct(a, slot(lead - 1), std::move(item));
+            lead--;
+            mysize++;
+            rebalance();
+            assert(valid());}
+
+        // ------
+        // resize
+        // ------
+
+        /**
+         * Changes the size of the container to s.
+         * If s is bigger than the current size, new elements with value v will be added to the end.
+         * @param s the desired size
+         * @param v the value used to initialize new elements when container grows
+         */
+        void resize (size_type s, const_reference v = value_type()) {
+            while(size() < s)
+                push_back(v);
+            while(size() > s)
+                pop_back();
+            assert(valid());}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return the number of elements in the deque
+         */
+        size_type size () const {
+            return mysize;}
+
+        // ----
+        // swap
+        // ----
+
+        /**
+         * @param that TieredDeque to swap underlying data with
+         */
+        void swap (TieredDeque& that) {
+            std::swap(tiers, that.tiers);
+            std::swap(tierCap, that.tierCap);
+            std::swap(firstTier, that.firstTier);
+            std::swap(numTiers, that.numTiers);
+            std::swap(shift, that.shift);
+            std::swap(lead, that.lead);
+            std::swap(mysize, that.mysize);
+            std::swap(a, that.a); //the tiers go back to the allocators they came from
+            std::swap(tier_a, that.tier_a);
+            assert(valid());}};
+
+#endif // TieredDeque_h